@@ -0,0 +1,102 @@
+/*
+
+  Compares the speed of writing geometries through std::ostream (with
+  the write_to_stream() methods) with the WKBEncoder and WKTEncoder
+  classes writing into a std::string buffer. Uses generated linestrings,
+  no input file is needed.
+
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <osmium/geometry/encoder.hpp>
+
+typedef std::vector<Osmium::OSM::WayNodeList> way_node_lists_t;
+
+/**
+ * Print time used since start and the number of bytes written and
+ * return the current time.
+ */
+clock_t report(const char* name, clock_t start, size_t bytes) {
+    clock_t now = clock();
+    std::cout << "  " << name << ": " << static_cast<double>(now - start) / CLOCKS_PER_SEC << "s (" << bytes << " bytes)\n";
+    return now;
+}
+
+template <typename TFormat>
+size_t bench_stream(const way_node_lists_t& lists, bool with_srid) {
+    size_t bytes = 0;
+    std::ostringstream out;
+    for (way_node_lists_t::const_iterator it = lists.begin(); it != lists.end(); ++it) {
+        out.str("");
+        Osmium::Geometry::LineString linestring(*it);
+        out << TFormat(linestring, with_srid);
+        bytes += out.str().size();
+    }
+    return bytes;
+}
+
+size_t bench_wkb_encoder(const way_node_lists_t& lists, bool hex, bool with_srid) {
+    size_t bytes = 0;
+    std::string buffer;
+    Osmium::Geometry::WKBEncoder encoder(buffer, hex, with_srid);
+    for (way_node_lists_t::const_iterator it = lists.begin(); it != lists.end(); ++it) {
+        buffer.clear();
+        encoder.linestring(it->begin(), it->end());
+        bytes += buffer.size();
+    }
+    return bytes;
+}
+
+size_t bench_wkt_encoder(const way_node_lists_t& lists, bool with_srid) {
+    size_t bytes = 0;
+    std::string buffer;
+    Osmium::Geometry::WKTEncoder encoder(buffer, with_srid);
+    for (way_node_lists_t::const_iterator it = lists.begin(); it != lists.end(); ++it) {
+        buffer.clear();
+        encoder.linestring(it->begin(), it->end());
+        bytes += buffer.size();
+    }
+    return bytes;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [NUM_LINESTRINGS [NUM_POINTS]]\n";
+        exit(1);
+    }
+
+    const int num_linestrings = argc > 1 ? atoi(argv[1]) : 200000;
+    const int num_points = argc > 2 ? atoi(argv[2]) : 20;
+
+    srand(42);
+    way_node_lists_t lists(num_linestrings, Osmium::OSM::WayNodeList(num_points));
+    for (way_node_lists_t::iterator it = lists.begin(); it != lists.end(); ++it) {
+        for (int i = 0; i < num_points; ++i) {
+            const int32_t x = (rand() % 360000) * 10000 + rand() % 10000 - 1800000000;
+            const int32_t y = (rand() % 180000) * 10000 + rand() % 10000 - 900000000;
+            Osmium::OSM::Position position(x, y);
+            it->add(Osmium::OSM::WayNode(i, position));
+        }
+    }
+
+    std::cout << num_linestrings << " linestrings with " << num_points << " points each\n";
+
+    for (int with_srid = 0; with_srid < 2; ++with_srid) {
+        std::cout << (with_srid ? "with SRID:\n" : "without SRID:\n");
+        clock_t start = clock();
+        start = report("WKB stream     ", start, bench_stream<Osmium::Geometry::Geometry::AsWKB>(lists, with_srid));
+        start = report("WKB encoder    ", start, bench_wkb_encoder(lists, false, with_srid));
+        start = report("hex WKB stream ", start, bench_stream<Osmium::Geometry::Geometry::AsHexWKB>(lists, with_srid));
+        start = report("hex WKB encoder", start, bench_wkb_encoder(lists, true, with_srid));
+        start = report("WKT stream     ", start, bench_stream<Osmium::Geometry::Geometry::AsWKT>(lists, with_srid));
+        start = report("WKT encoder    ", start, bench_wkt_encoder(lists, with_srid));
+    }
+}
@@ -0,0 +1,83 @@
+/*
+
+  Compares the speed of projecting coordinates to Web Mercator one at a
+  time with the math library and in batches with the approximations in
+  Osmium::Geometry::Mercator. Also prints the largest difference between
+  the two. Uses generated coordinates, no input file is needed.
+
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+#include <osmium/geometry/projection.hpp>
+
+/**
+ * Print time used since start and return the current time.
+ */
+clock_t report(const char* name, clock_t start) {
+    clock_t now = clock();
+    std::cout << "  " << name << ": " << static_cast<double>(now - start) / CLOCKS_PER_SEC << "s\n";
+    return now;
+}
+
+double max_difference(const std::vector<double>& a, const std::vector<double>& b) {
+    double max = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        max = std::max(max, std::fabs(a[i] - b[i]));
+    }
+    return max;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 2) {
+        std::cerr << "Usage: " << argv[0] << " [NUM_COORDINATES]\n";
+        exit(1);
+    }
+
+    const size_t count = argc > 1 ? atoi(argv[1]) : 10000000;
+
+    srand(42);
+    std::vector<double> lon(count);
+    std::vector<double> lat(count);
+    for (size_t i = 0; i < count; ++i) {
+        lon[i] = (rand() % 3600000) / 10000.0 - 180;
+        lat[i] = (rand() % 1700000) / 10000.0 - 85;
+    }
+
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    std::vector<double> batch_x(count);
+    std::vector<double> batch_y(count);
+    std::vector<double> batch_lon(count);
+    std::vector<double> batch_lat(count);
+
+    std::cout << count << " coordinates\n";
+
+    clock_t start = clock();
+    for (size_t i = 0; i < count; ++i) {
+        x[i] = Osmium::Geometry::Mercator::lon_to_x(lon[i]);
+        y[i] = Osmium::Geometry::Mercator::lat_to_y(lat[i]);
+    }
+    start = report("project with libm  ", start);
+
+    Osmium::Geometry::Mercator::project(count, &lon[0], &lat[0], &batch_x[0], &batch_y[0]);
+    start = report("project in batch   ", start);
+
+    std::vector<double> unprojected_lat(count);
+    for (size_t i = 0; i < count; ++i) {
+        unprojected_lat[i] = Osmium::Geometry::Mercator::y_to_lat(y[i]);
+    }
+    start = report("unproject with libm", start);
+
+    Osmium::Geometry::Mercator::unproject(count, &x[0], &y[0], &batch_lon[0], &batch_lat[0]);
+    report("unproject in batch ", start);
+
+    std::cout << "max difference: x " << max_difference(x, batch_x) << "m, y " << max_difference(y, batch_y)
+              << "m, lat " << max_difference(unprojected_lat, batch_lat) << " degrees\n";
+}
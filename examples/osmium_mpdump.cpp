@@ -70,7 +70,7 @@ int main(int argc, char* argv[]) {
     DumpHandler dump_handler;
 
     typedef Osmium::MultiPolygon::Assembler<DumpHandler> assembler_t;
-    assembler_t assembler(dump_handler, attempt_repair);
+    assembler_t assembler(dump_handler, attempt_repair, boost::thread::hardware_concurrency());
     assembler.set_debug_level(1);
 
     typedef Osmium::Handler::CoordinatesForWays<storage_sparsetable_t, storage_mmap_t> cfw_handler_t;
@@ -79,11 +79,7 @@ int main(int argc, char* argv[]) {
     typedef Osmium::Handler::Sequence<cfw_handler_t, assembler_t::HandlerPass2> sequence_handler_t;
     sequence_handler_t sequence_handler(cfw_handler, assembler.handler_pass2());
 
-    std::cerr << "First pass...\n";
-    Osmium::Input::read(infile, assembler.handler_pass1());
-
-    std::cerr << "Second pass...\n";
-    Osmium::Input::read(infile, sequence_handler);
+    Osmium::Input::read_relations_first(infile, assembler.handler_pass1(), sequence_handler);
 
     google::protobuf::ShutdownProtobufLibrary();
 }
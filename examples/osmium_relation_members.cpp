@@ -2,7 +2,8 @@
 
   Shows how the Osmium::Relations::Assembler class is used. Collects
   all members of all relations in the input data and dumps the tags of
-  all relations and all their members to stdout.
+  all relations and all their members to stdout. Relations that are
+  members of other relations are dumped before their parents.
 
   The code in this example file is released into the Public Domain.
 
@@ -94,6 +95,7 @@ int main(int argc, char* argv[]) {
     }
 
     DebugRelationsAssembler assembler;
+    assembler.resolve_nested_relations(true);
 
     Osmium::OSMFile infile(argv[1]);
 
@@ -104,6 +106,12 @@ int main(int argc, char* argv[]) {
     std::cout << "Second pass (reading members)..." << std::endl;
     Osmium::Input::read(infile, assembler.handler_pass2());
 
+    std::cout << "Relations by nesting depth (complete/all):\n";
+    for (unsigned int depth = 0; depth < assembler.relations_per_depth().size(); ++depth) {
+        std::cout << "  " << depth << ": " << assembler.completed_per_depth()[depth] << "/" << assembler.relations_per_depth()[depth] << "\n";
+    }
+    std::cout << "Members in cycles of nested relations: " << assembler.cyclic_members() << "\n";
+
     google::protobuf::ShutdownProtobufLibrary();
 }
 
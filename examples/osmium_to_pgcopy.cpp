@@ -0,0 +1,70 @@
+/*
+
+  This is an example tool that writes tagged nodes into a file in the
+  binary format of the PostgreSQL COPY command. Unlike osmium_to_postgis
+  it doesn't need OGR or a database connection. Load the file with:
+
+    CREATE TABLE nodes (id BIGINT, tags HSTORE, geom GEOMETRY(POINT, 4326));
+    COPY nodes FROM STDIN WITH (FORMAT binary);
+
+  for instance with "psql -c 'COPY ...' < OUTFILE".
+
+  The database must have the HSTORE and POSTGIS extentions loaded.
+
+  The code in this example file is released into the Public Domain.
+
+*/
+
+#include <iostream>
+
+#define OSMIUM_WITH_PBF_INPUT
+#define OSMIUM_WITH_XML_INPUT
+
+#include <osmium.hpp>
+#include <osmium/export/pg_copy.hpp>
+#include <osmium/geometry/point.hpp>
+
+class MyPgCopyHandler : public Osmium::Handler::Base {
+
+    Osmium::Export::PgCopy m_copy;
+    Osmium::OSM::TagList m_tags;
+
+public:
+
+    MyPgCopyHandler(const std::string& filename) :
+        m_copy(filename),
+        m_tags() {
+    }
+
+    void node(const shared_ptr<Osmium::OSM::Node const>& node) {
+        m_tags.clear();
+        BOOST_FOREACH(const Osmium::OSM::Tag& tag, node->tags()) {
+            if (strcmp(tag.key(), "created_by") && strcmp(tag.key(), "odbl")) {
+                m_tags.add(tag.key(), tag.value());
+            }
+        }
+
+        if (!m_tags.empty()) {
+            m_copy.row(node->id(), m_tags, Osmium::Geometry::Point(*node));
+        }
+    }
+
+    void after_nodes() {
+        m_copy.close();
+        throw Osmium::Handler::StopReading();
+    }
+
+};
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " INFILE OUTFILE\n";
+        exit(1);
+    }
+
+    Osmium::OSMFile infile(argv[1]);
+    MyPgCopyHandler handler(argv[2]);
+    Osmium::Input::read(infile, handler);
+
+    google::protobuf::ShutdownProtobufLibrary();
+}
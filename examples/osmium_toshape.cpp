@@ -15,8 +15,7 @@
 #include <osmium/storage/byid/sparse_table.hpp>
 #include <osmium/storage/byid/mmap_file.hpp>
 #include <osmium/handler/coordinates_for_ways.hpp>
-#include <osmium/geometry/point.hpp>
-#include <osmium/export/shapefile.hpp>
+#include <osmium/export/buffered_shapefile.hpp>
 
 typedef Osmium::Storage::ById::SparseTable<Osmium::OSM::Position> storage_sparsetable_t;
 typedef Osmium::Storage::ById::MmapFile<Osmium::OSM::Position> storage_mmap_t;
@@ -24,8 +23,9 @@ typedef Osmium::Handler::CoordinatesForWays<storage_sparsetable_t, storage_mmap_
 
 class MyShapeHandler : public Osmium::Handler::Base {
 
-    Osmium::Export::PointShapefile* shapefile_point;
-    Osmium::Export::LineStringShapefile* shapefile_linestring;
+    Osmium::Export::ShapefileWriter writer;
+    Osmium::Export::BufferedShapefile shapefile_point;
+    Osmium::Export::BufferedShapefile shapefile_linestring;
 
     storage_sparsetable_t store_pos;
     storage_mmap_t store_neg;
@@ -33,19 +33,19 @@ class MyShapeHandler : public Osmium::Handler::Base {
 
 public:
 
-    MyShapeHandler() {
+    MyShapeHandler() :
+        writer(),
+        shapefile_point(writer, "postboxes", SHPT_POINT),
+        shapefile_linestring(writer, "roads", SHPT_ARC) {
         handler_cfw = new cfw_handler_t(store_pos, store_neg);
-        shapefile_point = new Osmium::Export::PointShapefile("postboxes");
-        shapefile_point->add_field("id", FTDouble, 12);
-        shapefile_point->add_field("operator", FTString, 30);
-        shapefile_linestring = new Osmium::Export::LineStringShapefile("roads");
-        shapefile_linestring->add_field("id", FTDouble, 12);
-        shapefile_linestring->add_field("type", FTString, 30);
+        shapefile_point.add_field("id", FTDouble, 12);
+        shapefile_point.add_field("operator", FTString, 30);
+        shapefile_linestring.add_field("id", FTDouble, 12);
+        shapefile_linestring.add_field("type", FTString, 30);
     }
 
     ~MyShapeHandler() {
-        delete shapefile_linestring;
-        delete shapefile_point;
+        delete handler_cfw;
     }
 
     void init(Osmium::OSM::Meta& meta) {
@@ -56,17 +56,13 @@ public:
         handler_cfw->node(node);
         const char* amenity = node->tags().get_value_by_key("amenity");
         if (amenity && !strcmp(amenity, "post_box")) {
-            try {
-                Osmium::Geometry::Point point(*node);
-                shapefile_point->add_geometry(Osmium::Geometry::create_shp_object(point));
-                shapefile_point->add_attribute(0, static_cast<double>(node->id()));
-                const char* op = node->tags().get_value_by_key("operator");
-                if (op) {
-                    shapefile_point->add_attribute_with_truncate(1, std::string(op));
-                }
-            } catch (Osmium::Geometry::IllegalGeometry) {
-                std::cerr << "Ignoring illegal geometry for node " << node->id() << ".\n";
+            Osmium::Export::BufferedShapefile::Record record(shapefile_point);
+            record.add_attribute(0, static_cast<double>(node->id()));
+            const char* op = node->tags().get_value_by_key("operator");
+            if (op) {
+                record.add_attribute_with_truncate(1, op);
             }
+            shapefile_point.add(node, record);
         }
     }
 
@@ -78,16 +74,19 @@ public:
         handler_cfw->way(way);
         const char* highway = way->tags().get_value_by_key("highway");
         if (highway) {
-            try {
-                Osmium::Geometry::LineString linestring(*way);
-                shapefile_linestring->add_geometry(Osmium::Geometry::create_shp_object(linestring));
-                shapefile_linestring->add_attribute(0, static_cast<double>(way->id()));
-                shapefile_linestring->add_attribute_with_truncate(1, std::string(highway));
-            } catch (Osmium::Geometry::IllegalGeometry) {
-                std::cerr << "Ignoring illegal geometry for way " << way->id() << ".\n";
-            }
+            Osmium::Export::BufferedShapefile::Record record(shapefile_linestring);
+            record.add_attribute(0, static_cast<double>(way->id()));
+            record.add_attribute_with_truncate(1, highway);
+            shapefile_linestring.add(way, record);
         }
     }
+
+    void final() {
+        shapefile_point.close();
+        shapefile_linestring.close();
+        std::cerr << "Ignored " << shapefile_point.skipped() << " nodes and " << shapefile_linestring.skipped() << " ways with illegal geometry.\n";
+    }
+
 };
 
 /* ================================================== */
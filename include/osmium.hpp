@@ -74,6 +74,64 @@ namespace Osmium {
             delete input;
         }
 
+        /**
+         * Read an input file in two passes for assembling relations. The
+         * first handler only gets the relations, the second one gets the
+         * nodes and ways (and the relations if relations_in_pass2 is set).
+         *
+         * For seekable PBF files sorted in the usual way this does not
+         * read the whole file twice: An index of all blobs is built
+         * first, then the blobs containing relations are found with a
+         * binary search. The first pass only reads those blobs, the second
+         * pass only reads the blobs before them. For other files this
+         * falls back to reading the whole file twice.
+         *
+         * @param file The file to read.
+         * @param handler_pass1 Handler for the first pass, for instance Osmium::Relations::Assembler::HandlerPass1.
+         * @param handler_pass2 Handler for the second pass.
+         * @param relations_in_pass2 Do we need the relations in the second pass?
+         */
+        template <class T1, class T2>
+        inline void read_relations_first(const Osmium::OSMFile& file, T1& handler_pass1, T2& handler_pass2, bool relations_in_pass2=false) {
+#ifdef OSMIUM_WITH_PBF_INPUT
+            if (file.encoding()->is_pbf()) {
+                std::vector<off_t> index;
+                bool seekable = false;
+                size_t first_relation_blob = 0;
+                bool mixed = false;
+                {
+                    Osmium::Handler::Base handler;
+                    Osmium::Input::PBF<Osmium::Handler::Base>* indexer = new Osmium::Input::PBF<Osmium::Handler::Base>(file, handler);
+                    seekable = indexer->build_index(index);
+                    if (seekable) {
+                        first_relation_blob = indexer->find_first_relation_blob(index, mixed);
+                    }
+                    delete indexer;
+                }
+
+                if (seekable) {
+                    Osmium::Input::PBF<T1>* pass1 = new Osmium::Input::PBF<T1>(file, handler_pass1);
+                    pass1->parse(index, first_relation_blob, index.size());
+                    delete pass1;
+
+                    size_t end = first_relation_blob;
+                    if (relations_in_pass2) {
+                        end = index.size();
+                    } else if (mixed) {
+                        ++end;
+                    }
+                    Osmium::Input::PBF<T2>* pass2 = new Osmium::Input::PBF<T2>(file, handler_pass2);
+                    pass2->parse(index, 0, end);
+                    delete pass2;
+                    return;
+                }
+            }
+#endif // OSMIUM_WITH_PBF_INPUT
+
+            read(file, handler_pass1);
+            read(file, handler_pass2);
+        }
+
     } // namespace Input
 #endif
 
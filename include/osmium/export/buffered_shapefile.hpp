@@ -0,0 +1,882 @@
+#ifndef OSMIUM_EXPORT_BUFFERED_SHAPEFILE_HPP
+#define OSMIUM_EXPORT_BUFFERED_SHAPEFILE_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <shapefil.h>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <osmium/smart_ptr.hpp>
+#include <osmium/osmfile.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/geometry/shplib.hpp>
+#include <osmium/export/output_file.hpp>
+#include <osmium/export/shapefile.hpp>
+#include <osmium/utils/worker_pool.hpp>
+
+namespace Osmium {
+
+    namespace Export {
+
+        /**
+         * Append integer value in little endian byte order.
+         */
+        template <typename T>
+        inline void shapefile_append_le(std::string& buffer, T value) {
+            char data[sizeof(T)];
+            for (size_t i = 0; i < sizeof(T); ++i) {
+                data[i] = static_cast<char>(value & 0xff);
+                value >>= 8;
+            }
+            buffer.append(data, sizeof(T));
+        }
+
+        /**
+         * Append integer value in big endian byte order.
+         */
+        template <typename T>
+        inline void shapefile_append_be(std::string& buffer, T value) {
+            char data[sizeof(T)];
+            for (int i = sizeof(T) - 1; i >= 0; --i) {
+                data[i] = static_cast<char>(value & 0xff);
+                value >>= 8;
+            }
+            buffer.append(data, sizeof(T));
+        }
+
+        /**
+         * Append IEEE double in little endian byte order.
+         */
+        inline void shapefile_append_double(std::string& buffer, double value) {
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            shapefile_append_le<uint64_t>(buffer, bits);
+        }
+
+        class BufferedShapefile;
+
+        /**
+         * One feature on its way into a BufferedShapefile. The data needed
+         * for the geometry is copied from the object when the job is
+         * created, so the object is not kept. The geometry is built and
+         * serialized into the .shp record format by run(), which is
+         * called on a worker thread. The DBF record has already been
+         * formatted when the job is created.
+         */
+        class ShapefileJob {
+
+            enum geometry_t {
+                no_geometry,
+                point,
+                line_string,
+                polygon,
+                multipolygon
+            };
+
+        public:
+
+            ShapefileJob(BufferedShapefile* layer,
+                         int shape_type,
+                         const Osmium::OSM::Object& object,
+                         std::string& record) :
+                m_layer(layer),
+                m_geometry(no_geometry),
+                m_id(object.id()),
+                m_position(),
+                m_nodes(0),
+                m_reverse(false),
+                m_part_starts(),
+                m_xs(),
+                m_ys(),
+                m_record(),
+                m_shape(),
+                m_valid(false),
+                m_xmin(0),
+                m_ymin(0),
+                m_xmax(0),
+                m_ymax(0) {
+                m_record.swap(record);
+                try {
+                    copy_geometry(shape_type, object);
+                } catch (Osmium::Geometry::GeometryException&) {
+                    m_geometry = no_geometry;
+                } catch (std::runtime_error&) {
+                    m_geometry = no_geometry;
+                }
+            }
+
+            /**
+             * Build the geometry and serialize it. If the geometry can't
+             * be built the job is marked as not valid.
+             */
+            void run() {
+                try {
+                    SHPObject* shp_object = create_shp_object();
+                    if (shp_object) {
+                        serialize(*shp_object);
+                        SHPDestroyObject(shp_object);
+                        m_valid = true;
+                    }
+                } catch (Osmium::Geometry::GeometryException&) {
+                    // ignore broken geometry
+                } catch (std::runtime_error&) {
+                    // ignore broken geometry
+                }
+                Osmium::OSM::WayNodeList(0).swap(m_nodes);
+                std::vector<int>().swap(m_part_starts);
+                std::vector<double>().swap(m_xs);
+                std::vector<double>().swap(m_ys);
+            }
+
+            BufferedShapefile* layer() const {
+                return m_layer;
+            }
+
+            bool valid() const {
+                return m_valid;
+            }
+
+            /// Content of the .shp record (without record header).
+            const std::string& shape() const {
+                return m_shape;
+            }
+
+            /// The DBF record.
+            const std::string& record() const {
+                return m_record;
+            }
+
+            double xmin() const {
+                return m_xmin;
+            }
+
+            double ymin() const {
+                return m_ymin;
+            }
+
+            double xmax() const {
+                return m_xmax;
+            }
+
+            double ymax() const {
+                return m_ymax;
+            }
+
+        private:
+
+            /**
+             * Copy what is needed to build the geometry for the shape
+             * type from the object. Areas with a GEOS geometry are
+             * converted into the input of the SHPObject right away.
+             */
+            void copy_geometry(int shape_type, const Osmium::OSM::Object& object) {
+                switch (object.type()) {
+                    case NODE:
+                        if (shape_type == SHPT_POINT) {
+                            m_position = static_cast<const Osmium::OSM::Node&>(object).position();
+                            m_geometry = point;
+                        }
+                        break;
+                    case WAY:
+                        if (shape_type == SHPT_ARC || shape_type == SHPT_POLYGON) {
+                            m_nodes = static_cast<const Osmium::OSM::Way&>(object).nodes();
+                            m_geometry = shape_type == SHPT_ARC ? line_string : polygon;
+                        }
+                        break;
+                    case AREA:
+                        if (shape_type == SHPT_POLYGON) {
+                            const Osmium::OSM::Area& area = static_cast<const Osmium::OSM::Area&>(object);
+                            const Osmium::Geometry::MultiPolygon geometry(area);
+                            if (geometry.from_nodes()) {
+                                m_nodes = geometry.nodes();
+                                m_reverse = geometry.reverse();
+                                m_geometry = polygon;
+                            } else {
+                                Osmium::Geometry::dump_geometry(geometry.borrow_geos_geometry(), m_part_starts, m_xs, m_ys);
+                                m_geometry = multipolygon;
+                            }
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            SHPObject* create_shp_object() const {
+                switch (m_geometry) {
+                    case point:
+                        return Osmium::Geometry::create_shp_object(Osmium::Geometry::Point(m_position, m_id));
+                    case line_string:
+                        return Osmium::Geometry::create_shp_object(Osmium::Geometry::LineString(m_nodes, m_reverse, m_id));
+                    case polygon:
+                        return Osmium::Geometry::create_shp_object(Osmium::Geometry::Polygon(m_nodes, m_reverse, m_id));
+                    case multipolygon:
+                        return SHPCreateObject(SHPT_POLYGON, -1,
+                                               m_part_starts.size(), const_cast<int*>(&m_part_starts[0]), NULL,
+                                               m_xs.size(), const_cast<double*>(&m_xs[0]), const_cast<double*>(&m_ys[0]), NULL, NULL);
+                    default:
+                        break;
+                }
+                return NULL;
+            }
+
+            /**
+             * Serialize shape in the format of a .shp record. Only the
+             * point, arc and polygon types created by the shplib functions
+             * are supported.
+             */
+            void serialize(const SHPObject& shp_object) {
+                m_xmin = shp_object.dfXMin;
+                m_ymin = shp_object.dfYMin;
+                m_xmax = shp_object.dfXMax;
+                m_ymax = shp_object.dfYMax;
+
+                shapefile_append_le<int32_t>(m_shape, shp_object.nSHPType);
+                if (shp_object.nSHPType == SHPT_POINT) {
+                    shapefile_append_double(m_shape, shp_object.padfX[0]);
+                    shapefile_append_double(m_shape, shp_object.padfY[0]);
+                    return;
+                }
+
+                m_shape.reserve(44 + 4 * shp_object.nParts + 16 * shp_object.nVertices);
+                shapefile_append_double(m_shape, m_xmin);
+                shapefile_append_double(m_shape, m_ymin);
+                shapefile_append_double(m_shape, m_xmax);
+                shapefile_append_double(m_shape, m_ymax);
+                shapefile_append_le<int32_t>(m_shape, shp_object.nParts);
+                shapefile_append_le<int32_t>(m_shape, shp_object.nVertices);
+                for (int i = 0; i < shp_object.nParts; ++i) {
+                    shapefile_append_le<int32_t>(m_shape, shp_object.panPartStart[i]);
+                }
+                for (int i = 0; i < shp_object.nVertices; ++i) {
+                    shapefile_append_double(m_shape, shp_object.padfX[i]);
+                    shapefile_append_double(m_shape, shp_object.padfY[i]);
+                }
+            }
+
+            BufferedShapefile* m_layer;
+
+            /// Geometry to build and the data copied for it.
+            geometry_t m_geometry;
+            osm_object_id_t m_id;
+            Osmium::OSM::Position m_position;
+            Osmium::OSM::WayNodeList m_nodes;
+            bool m_reverse;
+
+            /// Rings of areas with a GEOS geometry as input for SHPCreateObject().
+            std::vector<int> m_part_starts;
+            std::vector<double> m_xs;
+            std::vector<double> m_ys;
+
+            std::string m_record;
+            std::string m_shape;
+            bool m_valid;
+            double m_xmin;
+            double m_ymin;
+            double m_xmax;
+            double m_ymax;
+
+        }; // class ShapefileJob
+
+        /**
+         * Converts features for any number of BufferedShapefiles on a pool
+         * of worker threads. The converted features are handed back to
+         * their shapefiles in the order they were added.
+         *
+         * The writer must outlive all shapefiles using it.
+         */
+        class ShapefileWriter : boost::noncopyable {
+
+        public:
+
+            /**
+             * @param num_threads Number of threads converting geometries.
+             *                    If this is 0, everything is done in the
+             *                    calling thread.
+             * @param max_unfinished Maximum number of features in the queue.
+             */
+            ShapefileWriter(unsigned int num_threads=boost::thread::hardware_concurrency(), size_t max_unfinished=10000) :
+                m_pool(num_threads, true, max_unfinished) {
+            }
+
+            void submit(const shared_ptr<ShapefileJob>& job) {
+                m_pool.submit(job);
+                drain(false);
+            }
+
+            /**
+             * Hand finished features to their shapefiles.
+             *
+             * @param wait If true, wait until all features are done.
+             */
+            void drain(bool wait=false);
+
+        private:
+
+            Osmium::WorkerPool<ShapefileJob> m_pool;
+
+        }; // class ShapefileWriter
+
+        /**
+         * Shapefile that is written directly from memory buffers instead
+         * of going through shapelib record by record.
+         *
+         * Geometries are built and converted on the worker threads of a
+         * ShapefileWriter, which can be shared between shapefiles. The
+         * .shp, .shx, and .dbf records are collected in buffers that are
+         * written out by a separate thread per shapefile, so several
+         * shapefiles are written at the same time. The file headers are
+         * filled in when the shapefile is closed.
+         *
+         * Like Shapefile, a new set of files is started when the maximum
+         * file size would be exceeded.
+         *
+         * Usage:
+         * @code
+         * Osmium::Export::ShapefileWriter writer;
+         * Osmium::Export::BufferedShapefile roads(writer, "roads", SHPT_ARC);
+         * roads.add_field("id", "integer", 10);
+         * ...
+         * Osmium::Export::BufferedShapefile::Record record(roads);
+         * record.add_attribute(0, static_cast<int>(way->id()));
+         * roads.add(way, record);
+         * ...
+         * roads.close();
+         * @endcode
+         */
+        class BufferedShapefile : boost::noncopyable {
+
+        public:
+
+            typedef Shapefile::Field Field;
+
+            /// Buffers are written out when they grow over this size.
+            static const size_t flush_size = 4 * 1024 * 1024;
+
+            /**
+             * Attribute values of one feature, formatted as DBF record.
+             * Can be reused after the feature has been added.
+             */
+            class Record {
+
+            public:
+
+                Record(const BufferedShapefile& shapefile) :
+                    m_shapefile(shapefile),
+                    m_data(shapefile.record_length(), ' ') {
+                }
+
+                void add_attribute(const int field, const bool value) {
+                    set(field, value ? "T" : "F", 1, false, "bool");
+                }
+
+                void add_attribute(const int field, const int value) {
+                    char buffer[Shapefile::max_dbf_field_length + 1];
+                    const int length = snprintf(buffer, sizeof(buffer), "%*d", m_shapefile.fields()[field].width(), value);
+                    set(field, buffer, length, true, "integer");
+                }
+
+                void add_attribute(const int field, const double value) {
+                    char buffer[Shapefile::max_dbf_field_length + 1];
+                    const Field& f = m_shapefile.fields()[field];
+                    const int length = snprintf(buffer, sizeof(buffer), "%*.*f", f.width(), f.decimals(), value);
+                    set(field, buffer, length, true, "double");
+                }
+
+                void add_attribute(const int field, const std::string& value) {
+                    set(field, value.data(), value.size(), false, "string");
+                }
+
+                void add_attribute(const int field, const char* value) {
+                    set(field, value, strlen(value), false, "string");
+                }
+
+                void add_attribute(const int field) {
+                    const Field& f = m_shapefile.fields()[field];
+                    char null_char = ' ';
+                    if (f.type() == FTInteger || f.type() == FTDouble) {
+                        null_char = '*';
+                    } else if (f.type() == FTLogical) {
+                        null_char = '?';
+                    }
+                    m_data.replace(m_shapefile.field_offset(field), f.width(), f.width(), null_char);
+                }
+
+                /**
+                 * Add string, truncating it to the field width if
+                 * necessary. Multibyte UTF-8 characters are not cut.
+                 */
+                void add_attribute_with_truncate(const int field, const char* value) {
+                    size_t length = strlen(value);
+                    const size_t width = m_shapefile.fields()[field].width();
+                    if (length > width) {
+                        length = width;
+                        while (length > 0 && (static_cast<unsigned char>(value[length]) & 0xc0) == 0x80) {
+                            --length;
+                        }
+                    }
+                    set(field, value, length, false, "string");
+                }
+
+                void add_attribute_with_truncate(const int field, const std::string& value) {
+                    add_attribute_with_truncate(field, value.c_str());
+                }
+
+                /// Reset all attributes to empty values.
+                void clear() {
+                    m_data.assign(m_shapefile.record_length(), ' ');
+                }
+
+                std::string& data() {
+                    return m_data;
+                }
+
+            private:
+
+                void set(const int field, const char* value, size_t length, bool right_align, const char* type_name) {
+                    const size_t width = m_shapefile.fields()[field].width();
+                    if (length > width) {
+                        throw std::runtime_error(std::string("Can't add ") + type_name + " to field");
+                    }
+                    const size_t offset = m_shapefile.field_offset(field);
+                    m_data.replace(offset, width, width, ' ');
+                    m_data.replace(right_align ? offset + width - length : offset, length, value, length);
+                }
+
+                const BufferedShapefile& m_shapefile;
+                std::string m_data;
+
+            }; // class Record
+
+            /**
+             * Create shapefile. The files are created when the first
+             * feature is added.
+             *
+             * @param writer Writer used for converting the features.
+             * @param filename Filename (optionally including path) without any suffix.
+             * @param type Shape type (SHPT_POINT, SHPT_ARC, or SHPT_POLYGON).
+             */
+            BufferedShapefile(ShapefileWriter& writer, const std::string& filename, int type) :
+                m_writer(writer),
+                m_filename_base(filename),
+                m_filename(),
+                m_type(type),
+                m_fields(),
+                m_field_offsets(),
+                m_record_length(1),
+                m_sequence_number(0),
+                m_open(false),
+                m_closed(false),
+                m_shp_file(),
+                m_shx_file(),
+                m_dbf_file(),
+                m_shp_buffer(),
+                m_shx_buffer(),
+                m_dbf_buffer(),
+                m_shp_writing(),
+                m_shx_writing(),
+                m_dbf_writing(),
+                m_shp_bytes(0),
+                m_shx_bytes(0),
+                m_dbf_bytes(0),
+                m_records(0),
+                m_xmin(0),
+                m_ymin(0),
+                m_xmax(0),
+                m_ymax(0),
+                m_thread(),
+                m_error_filename(),
+                m_error_errno(0),
+                m_features(0),
+                m_skipped(0) {
+                if (type != SHPT_POINT && type != SHPT_ARC && type != SHPT_POLYGON) {
+                    throw std::invalid_argument("unsupported shape type");
+                }
+            }
+
+            ~BufferedShapefile() {
+                try {
+                    close();
+                } catch (...) {
+                    // ignore exceptions
+                }
+            }
+
+            void add_field(const Field& field) {
+                if (m_open) {
+                    throw std::runtime_error("can't add fields after features have been added");
+                }
+                m_fields.push_back(field);
+                m_field_offsets.push_back(m_record_length);
+                m_record_length += field.width();
+            }
+
+            void add_field(const std::string& name, DBFFieldType type, int width=1, int decimals=0) {
+                add_field(Field(name, type, width, decimals));
+            }
+
+            /**
+             * Add a field. See Shapefile::make_field() for the types allowed.
+             */
+            void add_field(const std::string& name, const std::string& type, int width=1, int decimals=0) {
+                add_field(Shapefile::make_field(name, type, width, decimals));
+            }
+
+            const std::vector<Field>& fields() const {
+                return m_fields;
+            }
+
+            int field_num(const std::string& name) const {
+                for (size_t i = 0; i < m_fields.size(); ++i) {
+                    if (m_fields[i].name() == name) {
+                        return i;
+                    }
+                }
+                return -1;
+            }
+
+            /// Offset of field in the DBF record.
+            size_t field_offset(const int field) const {
+                return m_field_offsets[field];
+            }
+
+            /// Length of a DBF record including the deletion flag.
+            size_t record_length() const {
+                return m_record_length;
+            }
+
+            /**
+             * Queue feature for writing. The geometry is built from the
+             * object (a node, way, or area depending on the shape type)
+             * on a worker thread, from a copy of the locations, so the
+             * object can be changed or freed afterwards. The attributes
+             * are taken from the record, which is cleared for reuse.
+             */
+            void add(const shared_ptr<Osmium::OSM::Object const>& object, Record& record) {
+                if (m_closed) {
+                    throw std::runtime_error("shapefile already closed");
+                }
+                if (!m_open) {
+                    open();
+                }
+                shared_ptr<ShapefileJob> job(new ShapefileJob(this, m_type, *object, record.data()));
+                record.clear();
+                m_writer.submit(job);
+            }
+
+            /**
+             * Append a converted feature to the buffers. Called by the
+             * ShapefileWriter.
+             */
+            void append(const ShapefileJob& job) {
+                if (!job.valid()) {
+                    ++m_skipped;
+                    return;
+                }
+
+                const uint64_t shp_length = 8 + job.shape().size();
+                if (m_shp_bytes + shp_length > Shapefile::max_file_size ||
+                    m_dbf_bytes + m_record_length + 1 > Shapefile::max_file_size) {
+                    finish();
+                    ++m_sequence_number;
+                    open();
+                }
+
+                if (m_records == 0) {
+                    m_xmin = job.xmin();
+                    m_ymin = job.ymin();
+                    m_xmax = job.xmax();
+                    m_ymax = job.ymax();
+                } else {
+                    m_xmin = std::min(m_xmin, job.xmin());
+                    m_ymin = std::min(m_ymin, job.ymin());
+                    m_xmax = std::max(m_xmax, job.xmax());
+                    m_ymax = std::max(m_ymax, job.ymax());
+                }
+                ++m_records;
+                ++m_features;
+
+                // lengths and offsets are counted in 16 bit words
+                shapefile_append_be<int32_t>(m_shp_buffer, m_records);
+                shapefile_append_be<int32_t>(m_shp_buffer, job.shape().size() / 2);
+                m_shp_buffer.append(job.shape());
+                shapefile_append_be<int32_t>(m_shx_buffer, m_shp_bytes / 2);
+                shapefile_append_be<int32_t>(m_shx_buffer, job.shape().size() / 2);
+                m_dbf_buffer.append(job.record());
+
+                m_shp_bytes += shp_length;
+                m_shx_bytes += 8;
+                m_dbf_bytes += m_record_length;
+
+                if (m_shp_buffer.size() + m_dbf_buffer.size() >= flush_size) {
+                    flush();
+                }
+            }
+
+            /**
+             * Write all queued features and close the files. Note that
+             * this also hands all finished features of other shapefiles
+             * using the same writer to their shapefiles.
+             */
+            void close() {
+                if (m_closed) {
+                    return;
+                }
+                m_closed = true;
+                m_writer.drain(true);
+                if (!m_open) {
+                    open();
+                }
+                finish();
+            }
+
+            /// Number of features written.
+            uint64_t features() const {
+                return m_features;
+            }
+
+            /// Number of features skipped because their geometry was invalid.
+            uint64_t skipped() const {
+                return m_skipped;
+            }
+
+        private:
+
+            /**
+             * Open files with the current sequence number. Space for the
+             * headers is reserved and filled in by finish().
+             */
+            void open() {
+                std::ostringstream filename;
+                filename << m_filename_base;
+                if (m_sequence_number) {
+                    filename << "_" << m_sequence_number;
+                }
+                m_filename = filename.str();
+
+                // the data is buffered here and written out by the writer
+                // thread, so the files don't need their own buffers
+                m_shp_file.reset(new OutputFile(m_filename + ".shp", 0));
+                m_shx_file.reset(new OutputFile(m_filename + ".shx", 0));
+                m_dbf_file.reset(new OutputFile(m_filename + ".dbf", 0));
+                Shapefile::write_prj_and_cpg(m_filename);
+                m_open = true;
+
+                m_shp_bytes = Shapefile::size_shapefile_header;
+                m_shx_bytes = Shapefile::size_shapefile_header;
+                m_dbf_bytes = dbf_header_length();
+                m_shp_buffer.assign(m_shp_bytes, '\0');
+                m_shx_buffer.assign(m_shx_bytes, '\0');
+                m_dbf_buffer.assign(m_dbf_bytes, '\0');
+                m_records = 0;
+                m_xmin = m_ymin = m_xmax = m_ymax = 0;
+            }
+
+            size_t dbf_header_length() const {
+                return Shapefile::size_dbf_header + Shapefile::size_dbf_field_header * m_fields.size();
+            }
+
+            /**
+             * Hand the buffers to a new writer thread after the previous
+             * one is done.
+             */
+            void flush() {
+                wait_for_writer();
+                m_shp_buffer.swap(m_shp_writing);
+                m_shx_buffer.swap(m_shx_writing);
+                m_dbf_buffer.swap(m_dbf_writing);
+                m_thread.reset(new boost::thread(boost::bind(&BufferedShapefile::write_buffers, this)));
+            }
+
+            /// Runs in the writer thread.
+            void write_buffers() {
+                try {
+                    m_shp_file->write(m_shp_writing);
+                    m_shx_file->write(m_shx_writing);
+                    m_dbf_file->write(m_dbf_writing);
+                } catch (Osmium::OSMFile::IOError& e) {
+                    m_error_filename = e.filename();
+                    m_error_errno = e.system_errno();
+                }
+                m_shp_writing.clear();
+                m_shx_writing.clear();
+                m_dbf_writing.clear();
+            }
+
+            void wait_for_writer() {
+                if (m_thread) {
+                    m_thread->join();
+                    m_thread.reset();
+                }
+                if (!m_error_filename.empty()) {
+                    throw Osmium::OSMFile::IOError("Write failed", m_error_filename, m_error_errno);
+                }
+            }
+
+            std::string shp_header(uint64_t length) const {
+                std::string header;
+                header.reserve(Shapefile::size_shapefile_header);
+                shapefile_append_be<int32_t>(header, 9994);
+                header.append(20, '\0');
+                shapefile_append_be<int32_t>(header, length / 2);
+                shapefile_append_le<int32_t>(header, 1000);
+                shapefile_append_le<int32_t>(header, m_type);
+                shapefile_append_double(header, m_xmin);
+                shapefile_append_double(header, m_ymin);
+                shapefile_append_double(header, m_xmax);
+                shapefile_append_double(header, m_ymax);
+                header.append(32, '\0'); // z and m ranges
+                return header;
+            }
+
+            std::string dbf_header() const {
+                const time_t now = time(NULL);
+                struct tm date;
+                localtime_r(&now, &date);
+
+                std::string header;
+                header.reserve(dbf_header_length());
+                header += static_cast<char>(0x03);
+                header += static_cast<char>(date.tm_year);
+                header += static_cast<char>(date.tm_mon + 1);
+                header += static_cast<char>(date.tm_mday);
+                shapefile_append_le<uint32_t>(header, m_records);
+                shapefile_append_le<uint16_t>(header, dbf_header_length());
+                shapefile_append_le<uint16_t>(header, m_record_length);
+                header.append(20, '\0');
+
+                for (std::vector<Field>::const_iterator it = m_fields.begin(); it != m_fields.end(); ++it) {
+                    header.append(it->name());
+                    header.append(11 - it->name().size(), '\0');
+                    switch (it->type()) {
+                        case FTString:
+                            header += 'C';
+                            break;
+                        case FTLogical:
+                            header += 'L';
+                            break;
+                        default:
+                            header += 'N';
+                            break;
+                    }
+                    header.append(4, '\0');
+                    header += static_cast<char>(it->width());
+                    header += static_cast<char>(it->decimals());
+                    header.append(14, '\0');
+                }
+                header += static_cast<char>(0x0d);
+                return header;
+            }
+
+            /**
+             * Write out the rest of the buffers, fill in the headers, and
+             * close the files.
+             */
+            void finish() {
+                m_dbf_buffer += static_cast<char>(0x1a);
+                flush();
+                wait_for_writer();
+
+                m_shp_file->write_at(shp_header(m_shp_bytes), 0);
+                m_shx_file->write_at(shp_header(m_shx_bytes), 0);
+                m_dbf_file->write_at(dbf_header(), 0);
+
+                m_shp_file.reset();
+                m_shx_file.reset();
+                m_dbf_file.reset();
+                m_open = false;
+            }
+
+            ShapefileWriter& m_writer;
+            std::string m_filename_base;
+            std::string m_filename;
+            const int m_type;
+
+            std::vector<Field> m_fields;
+            std::vector<size_t> m_field_offsets;
+            size_t m_record_length;
+
+            int m_sequence_number;
+            bool m_open;
+            bool m_closed;
+
+            scoped_ptr<OutputFile> m_shp_file;
+            scoped_ptr<OutputFile> m_shx_file;
+            scoped_ptr<OutputFile> m_dbf_file;
+
+            // buffers being filled
+            std::string m_shp_buffer;
+            std::string m_shx_buffer;
+            std::string m_dbf_buffer;
+
+            // buffers being written by the writer thread
+            std::string m_shp_writing;
+            std::string m_shx_writing;
+            std::string m_dbf_writing;
+
+            // file sizes including buffered data
+            uint64_t m_shp_bytes;
+            uint64_t m_shx_bytes;
+            uint64_t m_dbf_bytes;
+
+            // number of records and bounding box of the current files
+            uint32_t m_records;
+            double m_xmin;
+            double m_ymin;
+            double m_xmax;
+            double m_ymax;
+
+            scoped_ptr<boost::thread> m_thread;
+            std::string m_error_filename;
+            int m_error_errno;
+
+            uint64_t m_features;
+            uint64_t m_skipped;
+
+        }; // class BufferedShapefile
+
+        inline void ShapefileWriter::drain(bool wait) {
+            while (true) {
+                shared_ptr<ShapefileJob> job = m_pool.next_finished(wait);
+                if (!job) {
+                    return;
+                }
+                job->layer()->append(*job);
+            }
+        }
+
+    } // namespace Export
+
+} // namespace Osmium
+
+#endif // OSMIUM_EXPORT_BUFFERED_SHAPEFILE_HPP
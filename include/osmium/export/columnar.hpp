@@ -0,0 +1,497 @@
+#ifndef OSMIUM_EXPORT_COLUMNAR_HPP
+#define OSMIUM_EXPORT_COLUMNAR_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/integer_traits.hpp>
+#include <boost/utility.hpp>
+
+#include <osmium/smart_ptr.hpp>
+#include <osmium/osmfile.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/tag_list.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/export/output_file.hpp>
+#include <osmium/utils/worker_pool.hpp>
+
+namespace Osmium {
+
+    namespace Export {
+
+        /**
+         * Write nodes and ways into a binary file with a columnar
+         * layout that can be loaded into analytics engines without
+         * parsing text.
+         *
+         * The objects are collected into row groups of nodes or ways.
+         * Each row group stores every attribute as one contiguous column
+         * and has its own dictionaries for tag keys and values. The
+         * footer lists all row groups with minimum and maximum values,
+         * so readers can skip row groups they don't need.
+         *
+         * Layout of the file, all integers are little endian:
+         * @code
+         *   file       := magic row_group* footer footer_size:uint64 magic
+         *   magic      := "OSMCOL01"
+         *   footer     := count:uint32 row_group_info*
+         *   row_group_info := offset:uint64 size:uint64 type:uint32 rows:uint32
+         *                     min_id:int64 max_id:int64
+         *                     min_timestamp:int64 max_timestamp:int64
+         *                     min_x:int32 min_y:int32 max_x:int32 max_y:int32
+         *   row_group  := column*
+         *   column     := size:uint64 data
+         * @endcode
+         * The type is 1 for nodes and 2 for ways. The bounding box is
+         * only set for nodes with a location, otherwise min > max.
+         *
+         * The columns of a row group are, with N being the number of rows:
+         *  - id: int64[N]
+         *  - version: int32[N]
+         *  - timestamp: int64[N] (seconds since the epoch)
+         *  - nodes only: x, y: int32[N] each (coordinates in units of
+         *    1e-7 degrees, 2^31-1 for nodes without location)
+         *  - ways only: node_offsets: uint32[N+1], node_refs: int64[]
+         *    (the node refs of row i are node_offsets[i] to
+         *    node_offsets[i+1]-1)
+         *  - tag_offsets: uint32[N+1], tag_keys: uint32[], tag_values:
+         *    uint32[] (indexes into the dictionaries)
+         *  - key dictionary and value dictionary: count:uint32,
+         *    offsets:uint32[count+1], followed by the UTF-8 bytes of all
+         *    strings, string i is from offsets[i] to offsets[i+1]
+         *
+         * Row groups are encoded independently. With num_threads > 0
+         * they are encoded by worker threads and written in the order
+         * they were filled. The attributes of the objects are copied when
+         * they are added, so the writer doesn't hold on to the objects.
+         */
+        class Columnar : boost::noncopyable {
+
+        public:
+
+            /// Type of a row group.
+            enum row_group_type_t {
+                nodes = 1,
+                ways = 2
+            };
+
+            /// Entry for a row group in the footer of the file.
+            struct RowGroupInfo {
+                uint64_t offset;
+                uint64_t size;
+                uint32_t type;
+                uint32_t rows;
+                int64_t min_id;
+                int64_t max_id;
+                int64_t min_timestamp;
+                int64_t max_timestamp;
+                int32_t min_x;
+                int32_t min_y;
+                int32_t max_x;
+                int32_t max_y;
+            };
+
+        private:
+
+            /**
+             * Append integer value in little endian byte order.
+             */
+            template <typename T>
+            static void append(std::string& buffer, T value) {
+                char data[sizeof(T)];
+                for (size_t i = 0; i < sizeof(T); ++i) {
+                    data[i] = static_cast<char>(value & 0xff);
+                    value >>= 8;
+                }
+                buffer.append(data, sizeof(T));
+            }
+
+            /**
+             * A row group being filled or encoded. The attributes of the
+             * objects are copied into column vectors when they are added,
+             * so the row group doesn't keep any references to the objects.
+             * Tag keys and values are stored one after the other, each
+             * followed by a null byte, in tag_data.
+             */
+            class RowGroup {
+
+                typedef std::map<std::string, uint32_t> dictionary_t;
+
+            public:
+
+                RowGroup(row_group_type_t type) :
+                    ids(),
+                    versions(),
+                    timestamps(),
+                    xs(),
+                    ys(),
+                    node_offsets(1, 0),
+                    node_refs(),
+                    tag_offsets(1, 0),
+                    tag_data(),
+                    output(),
+                    info(),
+                    m_column_start(0) {
+                    info.type = type;
+                }
+
+                size_t size() const {
+                    return ids.size();
+                }
+
+                bool empty() const {
+                    return ids.empty();
+                }
+
+                void add(const Osmium::OSM::Node& node) {
+                    add_object(node);
+                    xs.push_back(node.position().x());
+                    ys.push_back(node.position().y());
+                }
+
+                void add(const Osmium::OSM::Way& way) {
+                    add_object(way);
+                    const Osmium::OSM::WayNodeList& way_nodes = way.nodes();
+                    for (Osmium::OSM::WayNodeList::const_iterator wn = way_nodes.begin(); wn != way_nodes.end(); ++wn) {
+                        node_refs.push_back(wn->ref());
+                    }
+                    node_offsets.push_back(node_refs.size());
+                }
+
+                /// Encode all rows into output and fill in info.
+                void run() {
+                    info.rows = size();
+                    info.min_id = info.min_timestamp = boost::integer_traits<int64_t>::const_max;
+                    info.max_id = info.max_timestamp = boost::integer_traits<int64_t>::const_min;
+                    info.min_x = info.min_y = boost::integer_traits<int32_t>::const_max;
+                    info.max_x = info.max_y = boost::integer_traits<int32_t>::const_min;
+
+                    for (size_t i = 0; i < ids.size(); ++i) {
+                        info.min_id = std::min(info.min_id, ids[i]);
+                        info.max_id = std::max(info.max_id, ids[i]);
+                        info.min_timestamp = std::min(info.min_timestamp, timestamps[i]);
+                        info.max_timestamp = std::max(info.max_timestamp, timestamps[i]);
+                    }
+                    encode_column(ids);
+                    encode_column(versions);
+                    encode_column(timestamps);
+
+                    if (info.type == nodes) {
+                        encode_locations();
+                    } else {
+                        encode_column(node_offsets);
+                        encode_column(node_refs);
+                    }
+                    encode_tags();
+
+                    clear();
+                }
+
+                std::vector<int64_t> ids;
+                std::vector<int32_t> versions;
+                std::vector<int64_t> timestamps;
+
+                /// Locations of nodes.
+                std::vector<int32_t> xs;
+                std::vector<int32_t> ys;
+
+                /// Node refs of ways.
+                std::vector<uint32_t> node_offsets;
+                std::vector<int64_t> node_refs;
+
+                std::vector<uint32_t> tag_offsets;
+                std::string tag_data;
+
+                std::string output;
+                RowGroupInfo info;
+
+            private:
+
+                void add_object(const Osmium::OSM::Object& object) {
+                    ids.push_back(object.id());
+                    versions.push_back(object.version());
+                    timestamps.push_back(object.timestamp());
+                    for (Osmium::OSM::TagList::const_iterator tag = object.tags().begin(); tag != object.tags().end(); ++tag) {
+                        tag_data.append(tag->key());
+                        tag_data.append(1, '\0');
+                        tag_data.append(tag->value());
+                        tag_data.append(1, '\0');
+                    }
+                    tag_offsets.push_back(tag_offsets.back() + object.tags().size());
+                }
+
+                /// Free the memory used by the columns once they are encoded.
+                void clear() {
+                    std::vector<int64_t>().swap(ids);
+                    std::vector<int32_t>().swap(versions);
+                    std::vector<int64_t>().swap(timestamps);
+                    std::vector<int32_t>().swap(xs);
+                    std::vector<int32_t>().swap(ys);
+                    std::vector<uint32_t>().swap(node_offsets);
+                    std::vector<int64_t>().swap(node_refs);
+                    std::vector<uint32_t>().swap(tag_offsets);
+                    std::string().swap(tag_data);
+                }
+
+                /**
+                 * Start a column whose length is not known in advance.
+                 * The length is filled in by end_column().
+                 */
+                void begin_column() {
+                    append<uint64_t>(output, 0);
+                    m_column_start = output.size();
+                }
+
+                void end_column() {
+                    uint64_t length = output.size() - m_column_start;
+                    for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+                        output[m_column_start - sizeof(uint64_t) + i] = static_cast<char>(length & 0xff);
+                        length >>= 8;
+                    }
+                }
+
+                template <typename T>
+                void encode_column(const std::vector<T>& column) {
+                    begin_column();
+                    for (typename std::vector<T>::const_iterator it = column.begin(); it != column.end(); ++it) {
+                        append<T>(output, *it);
+                    }
+                    end_column();
+                }
+
+                void encode_locations() {
+                    for (size_t i = 0; i < xs.size(); ++i) {
+                        if (Osmium::OSM::Position(xs[i], ys[i]).defined()) {
+                            info.min_x = std::min(info.min_x, xs[i]);
+                            info.max_x = std::max(info.max_x, xs[i]);
+                            info.min_y = std::min(info.min_y, ys[i]);
+                            info.max_y = std::max(info.max_y, ys[i]);
+                        }
+                    }
+                    encode_column(xs);
+                    encode_column(ys);
+                }
+
+                static uint32_t lookup(dictionary_t& dictionary, std::vector<const std::string*>& strings, const char* str) {
+                    std::pair<dictionary_t::iterator, bool> result = dictionary.insert(std::make_pair(std::string(str), static_cast<uint32_t>(strings.size())));
+                    if (result.second) {
+                        strings.push_back(&result.first->first);
+                    }
+                    return result.first->second;
+                }
+
+                void encode_dictionary(const std::vector<const std::string*>& strings) {
+                    begin_column();
+                    append<uint32_t>(output, strings.size());
+                    uint32_t offset = 0;
+                    append<uint32_t>(output, offset);
+                    for (std::vector<const std::string*>::const_iterator it = strings.begin(); it != strings.end(); ++it) {
+                        offset += (*it)->size();
+                        append<uint32_t>(output, offset);
+                    }
+                    for (std::vector<const std::string*>::const_iterator it = strings.begin(); it != strings.end(); ++it) {
+                        output.append(**it);
+                    }
+                    end_column();
+                }
+
+                void encode_tags() {
+                    encode_column(tag_offsets);
+
+                    dictionary_t key_dictionary;
+                    dictionary_t value_dictionary;
+                    std::vector<const std::string*> keys;
+                    std::vector<const std::string*> values;
+                    std::vector<uint32_t> key_indexes;
+                    std::vector<uint32_t> value_indexes;
+                    key_indexes.reserve(tag_offsets.back());
+                    value_indexes.reserve(tag_offsets.back());
+
+                    const char* data = tag_data.data();
+                    const char* const end = data + tag_data.size();
+                    while (data != end) {
+                        key_indexes.push_back(lookup(key_dictionary, keys, data));
+                        data += strlen(data) + 1;
+                        value_indexes.push_back(lookup(value_dictionary, values, data));
+                        data += strlen(data) + 1;
+                    }
+
+                    encode_column(key_indexes);
+                    encode_column(value_indexes);
+                    encode_dictionary(keys);
+                    encode_dictionary(values);
+                }
+
+                /// Position in output where the data of the current column starts.
+                size_t m_column_start;
+
+            }; // class RowGroup
+
+        public:
+
+            /// Default number of rows in a row group.
+            static const size_t default_row_group_size = 64 * 1024;
+
+            /**
+             * Open output file and write the file header.
+             *
+             * @param filename Name of output file. Empty or "-" for stdout.
+             * @param num_threads Number of threads encoding row groups.
+             * @param row_group_size Number of rows in a row group.
+             * @throws Osmium::OSMFile::IOError if the file can't be opened.
+             */
+            Columnar(const std::string& filename="",
+                     unsigned int num_threads=0,
+                     size_t row_group_size=default_row_group_size) :
+                m_output(filename),
+                m_row_group_size(row_group_size > 0 ? row_group_size : 1),
+                m_pool(num_threads, true, num_threads * 2),
+                m_nodes(make_shared<RowGroup>(nodes)),
+                m_ways(make_shared<RowGroup>(ways)),
+                m_row_groups(),
+                m_rows(0) {
+                m_output.buffer().append(magic(), 8);
+            }
+
+            ~Columnar() {
+                try {
+                    close();
+                } catch (...) {
+                    // ignore exceptions
+                }
+            }
+
+            void node(const shared_ptr<Osmium::OSM::Node const>& node) {
+                m_nodes->add(*node);
+                row_added(m_nodes);
+            }
+
+            void way(const shared_ptr<Osmium::OSM::Way const>& way) {
+                m_ways->add(*way);
+                row_added(m_ways);
+            }
+
+            /**
+             * Write all remaining row groups and the footer and close the
+             * output file.
+             *
+             * @throws Osmium::OSMFile::IOError if writing fails.
+             */
+            void close() {
+                if (!m_output.is_open()) {
+                    return;
+                }
+                submit(m_nodes);
+                submit(m_ways);
+                drain(true);
+
+                std::string footer;
+                append<uint32_t>(footer, m_row_groups.size());
+                for (std::vector<RowGroupInfo>::const_iterator it = m_row_groups.begin(); it != m_row_groups.end(); ++it) {
+                    append<uint64_t>(footer, it->offset);
+                    append<uint64_t>(footer, it->size);
+                    append<uint32_t>(footer, it->type);
+                    append<uint32_t>(footer, it->rows);
+                    append<int64_t>(footer, it->min_id);
+                    append<int64_t>(footer, it->max_id);
+                    append<int64_t>(footer, it->min_timestamp);
+                    append<int64_t>(footer, it->max_timestamp);
+                    append<int32_t>(footer, it->min_x);
+                    append<int32_t>(footer, it->min_y);
+                    append<int32_t>(footer, it->max_x);
+                    append<int32_t>(footer, it->max_y);
+                }
+                append<uint64_t>(footer, footer.size());
+                footer.append(magic(), 8);
+                m_output.buffer().append(footer);
+                m_output.close();
+            }
+
+            /// Number of rows written so far.
+            uint64_t rows() const {
+                return m_rows;
+            }
+
+            /// Row groups written so far.
+            const std::vector<RowGroupInfo>& row_groups() const {
+                return m_row_groups;
+            }
+
+        private:
+
+            static const char* magic() {
+                return "OSMCOL01";
+            }
+
+            void row_added(shared_ptr<RowGroup>& row_group) {
+                if (row_group->size() >= m_row_group_size) {
+                    submit(row_group);
+                    drain(false);
+                }
+            }
+
+            void submit(shared_ptr<RowGroup>& row_group) {
+                if (!row_group->empty()) {
+                    const row_group_type_t type = static_cast<row_group_type_t>(row_group->info.type);
+                    m_pool.submit(row_group);
+                    row_group = make_shared<RowGroup>(type);
+                }
+            }
+
+            /// Write the encoded row groups that are finished.
+            void drain(bool wait) {
+                while (shared_ptr<RowGroup> row_group = m_pool.next_finished(wait)) {
+                    row_group->info.offset = m_output.offset();
+                    row_group->info.size = row_group->output.size();
+                    m_output.write(row_group->output);
+                    m_row_groups.push_back(row_group->info);
+                    m_rows += row_group->info.rows;
+                }
+            }
+
+            OutputFile m_output;
+
+            const size_t m_row_group_size;
+
+            Osmium::WorkerPool<RowGroup> m_pool;
+
+            /// Row groups being filled.
+            shared_ptr<RowGroup> m_nodes;
+            shared_ptr<RowGroup> m_ways;
+
+            std::vector<RowGroupInfo> m_row_groups;
+
+            uint64_t m_rows;
+
+        }; // class Columnar
+
+    } // namespace Export
+
+} // namespace Osmium
+
+#endif // OSMIUM_EXPORT_COLUMNAR_HPP
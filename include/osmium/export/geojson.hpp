@@ -0,0 +1,594 @@
+#ifndef OSMIUM_EXPORT_GEOJSON_HPP
+#define OSMIUM_EXPORT_GEOJSON_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/utility.hpp>
+
+#include <geos/geom/CoordinateSequence.h>
+#include <geos/geom/LineString.h>
+#include <geos/geom/MultiPolygon.h>
+#include <geos/geom/Polygon.h>
+
+#include <osmium/smart_ptr.hpp>
+#include <osmium/osmfile.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/position.hpp>
+#include <osmium/osm/tag_list.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/geometry.hpp>
+#include <osmium/geometry/encoder.hpp>
+#include <osmium/geometry/multipolygon.hpp>
+#include <osmium/geometry/ring.hpp>
+#include <osmium/export/output_file.hpp>
+#include <osmium/utils/json.hpp>
+#include <osmium/utils/worker_pool.hpp>
+
+namespace Osmium {
+
+    namespace Export {
+
+        /**
+         * Formats OSM objects as GeoJSON features (RFC 7946).
+         *
+         * Nodes become Points, ways LineStrings, and areas Polygons or
+         * MultiPolygons with the exterior rings counterclockwise and the
+         * holes clockwise. The tags are written as properties, the
+         * feature id is the object type ('n', 'w', or 'r' for areas from
+         * relations) followed by the OSM id.
+         *
+         * Coordinates are written directly from the fixed point
+         * representation in Position, so they have at most seven decimal
+         * places and no rounding errors from floating point formatting.
+         *
+         * Formatting is done in two steps: add() copies the id, tags,
+         * and coordinates of an object into the formatter, format()
+         * writes a feature from this copy. So the objects are not needed
+         * any more after they were added and formatting can be done in
+         * another thread.
+         */
+        class GeoJSONFormatter {
+
+            enum geometry_t {
+                point,
+                line_string,
+                polygon,
+                multipolygon
+            };
+
+            struct Feature {
+                char prefix;
+                osm_object_id_t id;
+                geometry_t geometry;
+
+                /// End of the tags of this feature in m_tag_data.
+                size_t tags_end;
+
+                /// End of the rings of this feature in m_rings.
+                size_t rings_end;
+            };
+
+            /**
+             * A ring of a polygon, or the positions of a point or line.
+             * Each ring starts where the one before ends.
+             */
+            struct Ring {
+                size_t positions_end;
+                bool outer;
+            };
+
+        public:
+
+            GeoJSONFormatter() :
+                m_features(),
+                m_tag_data(),
+                m_rings(),
+                m_positions() {
+            }
+
+            /// Number of features added.
+            size_t size() const {
+                return m_features.size();
+            }
+
+            bool empty() const {
+                return m_features.empty();
+            }
+
+            /**
+             * Copy the id, tags, and geometry of a node, way, or area
+             * into the formatter.
+             *
+             * @returns false if the object has no geometry, nothing is added then.
+             */
+            bool add(const Osmium::OSM::Object& object) {
+                const size_t rings_size = m_rings.size();
+                const size_t positions_size = m_positions.size();
+
+                Feature feature;
+                feature.id = object.id();
+                bool ok = false;
+                try {
+                    switch (object.type()) {
+                        case NODE:
+                            feature.prefix = 'n';
+                            feature.geometry = point;
+                            ok = add_point(static_cast<const Osmium::OSM::Node&>(object));
+                            break;
+                        case WAY:
+                            feature.prefix = 'w';
+                            feature.geometry = line_string;
+                            ok = add_line_string(static_cast<const Osmium::OSM::Way&>(object));
+                            break;
+                        case AREA: {
+                            const Osmium::OSM::Area& area = static_cast<const Osmium::OSM::Area&>(object);
+                            feature.prefix = area.from_way() ? 'w' : 'r';
+                            feature.id = area.orig_id();
+                            feature.geometry = area.from_way() ? polygon : multipolygon;
+                            ok = add_area(area);
+                            break;
+                        }
+                        default:
+                            break;
+                    }
+                } catch (Osmium::Geometry::GeometryException&) {
+                    ok = false;
+                }
+
+                if (!ok) {
+                    m_rings.resize(rings_size);
+                    m_positions.resize(positions_size);
+                    return false;
+                }
+
+                for (Osmium::OSM::TagList::const_iterator it = object.tags().begin(); it != object.tags().end(); ++it) {
+                    m_tag_data.append(it->key());
+                    m_tag_data.append(1, '\0');
+                    m_tag_data.append(it->value());
+                    m_tag_data.append(1, '\0');
+                }
+                feature.tags_end = m_tag_data.size();
+                feature.rings_end = m_rings.size();
+                m_features.push_back(feature);
+                return true;
+            }
+
+            /**
+             * Append the feature with the given index (in the order
+             * the objects were added) to the string.
+             */
+            void format(size_t n, std::string& out) const {
+                const Feature& feature = m_features[n];
+                out.append("{\"type\":\"Feature\",\"id\":\"");
+                out.append(1, feature.prefix);
+                append_integer(out, feature.id);
+                out.append("\",\"properties\":");
+                append_tags(out, n > 0 ? m_features[n-1].tags_end : 0, feature.tags_end);
+                out.append(",\"geometry\":");
+
+                const size_t rings_begin = n > 0 ? m_features[n-1].rings_end : 0;
+                switch (feature.geometry) {
+                    case point:
+                        out.append("{\"type\":\"Point\",\"coordinates\":");
+                        append_position(out, m_positions[positions_begin(rings_begin)]);
+                        out.append(1, '}');
+                        break;
+                    case line_string:
+                        out.append("{\"type\":\"LineString\",\"coordinates\":");
+                        append_positions(out, rings_begin, false);
+                        out.append(1, '}');
+                        break;
+                    case polygon:
+                        out.append("{\"type\":\"Polygon\",\"coordinates\":[");
+                        append_ring(out, rings_begin);
+                        out.append("]}");
+                        break;
+                    case multipolygon:
+                        out.append("{\"type\":\"MultiPolygon\",\"coordinates\":[");
+                        for (size_t ring = rings_begin; ring < feature.rings_end; ++ring) {
+                            if (m_rings[ring].outer) {
+                                out.append(ring == rings_begin ? "[" : "],[");
+                            } else {
+                                out.append(1, ',');
+                            }
+                            append_ring(out, ring);
+                        }
+                        out.append("]]}");
+                        break;
+                }
+                out.append(1, '}');
+            }
+
+            /// Remove all features and free the memory used by them.
+            void clear() {
+                std::vector<Feature>().swap(m_features);
+                std::string().swap(m_tag_data);
+                std::vector<Ring>().swap(m_rings);
+                std::vector<Osmium::OSM::Position>().swap(m_positions);
+            }
+
+        private:
+
+            static void append_integer(std::string& out, int64_t value) {
+                char buffer[24];
+                char* const end = buffer + sizeof(buffer);
+                char* p = end;
+                uint64_t v = value < 0 ? -static_cast<uint64_t>(value) : value;
+                do {
+                    *--p = '0' + v % 10;
+                    v /= 10;
+                } while (v != 0);
+                if (value < 0) {
+                    *--p = '-';
+                }
+                out.append(p, end - p);
+            }
+
+            /// Append the keys and values between begin and end in m_tag_data as object.
+            void append_tags(std::string& out, size_t begin, size_t end) const {
+                out.append(1, '{');
+                for (size_t offset = begin; offset < end; ) {
+                    if (offset != begin) {
+                        out.append(1, ',');
+                    }
+                    const char* key = m_tag_data.data() + offset;
+                    const char* value = key + strlen(key) + 1;
+                    Osmium::JSON::append_string(out, key);
+                    out.append(1, ':');
+                    Osmium::JSON::append_string(out, value);
+                    offset = value + strlen(value) + 1 - m_tag_data.data();
+                }
+                out.append(1, '}');
+            }
+
+            static void append_position(std::string& out, const Osmium::OSM::Position& position) {
+                char buffer[2 * 12 + 3];
+                char* p = buffer;
+                *p++ = '[';
+                p = Osmium::Geometry::WKTEncoder::format_coordinate(p, position.x());
+                *p++ = ',';
+                p = Osmium::Geometry::WKTEncoder::format_coordinate(p, position.y());
+                *p++ = ']';
+                out.append(buffer, p - buffer);
+            }
+
+            size_t positions_begin(size_t ring) const {
+                return ring > 0 ? m_rings[ring-1].positions_end : 0;
+            }
+
+            /// Append the positions of the ring, in reverse order if reverse is set.
+            void append_positions(std::string& out, size_t ring, bool reverse) const {
+                const size_t begin = positions_begin(ring);
+                const size_t end = m_rings[ring].positions_end;
+                out.append(1, '[');
+                for (size_t i = begin; i < end; ++i) {
+                    if (i > begin) {
+                        out.append(1, ',');
+                    }
+                    append_position(out, m_positions[reverse ? end - 1 - (i - begin) : i]);
+                }
+                out.append(1, ']');
+            }
+
+            /// Append the ring counterclockwise if it is an outer ring, clockwise otherwise.
+            void append_ring(std::string& out, size_t ring) const {
+                const bool ccw = Osmium::Geometry::Ring::is_ccw(m_positions.begin() + positions_begin(ring), m_positions.begin() + m_rings[ring].positions_end);
+                append_positions(out, ring, ccw != m_rings[ring].outer);
+            }
+
+            void end_ring(bool outer) {
+                Ring ring;
+                ring.positions_end = m_positions.size();
+                ring.outer = outer;
+                m_rings.push_back(ring);
+            }
+
+            void add_positions(const Osmium::OSM::WayNodeList& nodes, bool outer) {
+                for (Osmium::OSM::WayNodeList::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+                    m_positions.push_back(it->position());
+                }
+                end_ring(outer);
+            }
+
+            void add_positions(const geos::geom::LineString* ring, bool outer) {
+                const geos::geom::CoordinateSequence* coordinates = ring->getCoordinatesRO();
+                for (size_t i = 0; i < coordinates->getSize(); ++i) {
+                    m_positions.push_back(Osmium::OSM::Position(coordinates->getAt(i).x, coordinates->getAt(i).y));
+                }
+                end_ring(outer);
+            }
+
+            bool add_point(const Osmium::OSM::Node& node) {
+                if (!node.position().defined()) {
+                    return false;
+                }
+                m_positions.push_back(node.position());
+                end_ring(true);
+                return true;
+            }
+
+            bool add_line_string(const Osmium::OSM::Way& way) {
+                if (way.nodes().size() < 2 || !way.nodes().has_position()) {
+                    return false;
+                }
+                add_positions(way.nodes(), true);
+                return true;
+            }
+
+            bool add_area(const Osmium::OSM::Area& area) {
+                if (area.from_way()) {
+                    if (area.nodes().size() < 4 || !area.nodes().has_position() || !area.nodes().is_closed()) {
+                        return false;
+                    }
+                    add_positions(area.nodes(), true);
+                    return true;
+                }
+
+                const geos::geom::MultiPolygon* geometry = Osmium::Geometry::MultiPolygon(area).borrow_geos_geometry();
+                if (geometry->getNumGeometries() == 0) {
+                    return false;
+                }
+                for (size_t i = 0; i < geometry->getNumGeometries(); ++i) {
+                    const geos::geom::Polygon* part = dynamic_cast<const geos::geom::Polygon*>(geometry->getGeometryN(i));
+                    add_positions(part->getExteriorRing(), true);
+                    for (size_t j = 0; j < part->getNumInteriorRing(); ++j) {
+                        add_positions(part->getInteriorRingN(j), false);
+                    }
+                }
+                return true;
+            }
+
+            std::vector<Feature> m_features;
+
+            /// Keys and values of all features, each followed by a 0 byte.
+            std::string m_tag_data;
+
+            std::vector<Ring> m_rings;
+            std::vector<Osmium::OSM::Position> m_positions;
+
+        }; // class GeoJSONFormatter
+
+        /**
+         * Write nodes, ways, and areas to a GeoJSON file.
+         *
+         * The output is either one FeatureCollection or a sequence of
+         * features, one per line. The sequence can be newline delimited
+         * (often called "GeoJSONSeq" or "ndjson") or a GeoJSON text
+         * sequence as in RFC 8142 where each feature starts with the
+         * record separator character.
+         *
+         * The features are formatted in blocks. With num_threads > 0 the
+         * blocks are formatted by worker threads and written in the
+         * original order. The data needed for the features is copied
+         * from the objects when they are given to the writer, so the
+         * objects are not kept. Objects without a geometry (such as ways
+         * without node locations) are not written, they are counted in
+         * skipped().
+         */
+        class GeoJSON : boost::noncopyable {
+
+        public:
+
+            enum format_t {
+                feature_collection,
+                newline_delimited,
+                text_sequence
+            };
+
+        private:
+
+            class Job {
+
+            public:
+
+                Job(format_t format) :
+                    formatter(),
+                    output(),
+                    features(0),
+                    m_format(format) {
+                }
+
+                /**
+                 * Format all features into output. Each feature gets the
+                 * separator of the output format, in a FeatureCollection
+                 * this is a comma before the feature, which the writer
+                 * removes from the first feature in the file.
+                 */
+                void run() {
+                    for (size_t i = 0; i < formatter.size(); ++i) {
+                        if (m_format == feature_collection) {
+                            output.append(",\n", 2);
+                        } else if (m_format == text_sequence) {
+                            output.append(1, '\x1e');
+                        }
+                        formatter.format(i, output);
+                        if (m_format != feature_collection) {
+                            output.append(1, '\n');
+                        }
+                    }
+                    features = formatter.size();
+                    formatter.clear();
+                }
+
+                /// Copies of the objects in this block.
+                GeoJSONFormatter formatter;
+
+                std::string output;
+                uint64_t features;
+
+            private:
+
+                const format_t m_format;
+
+            }; // class Job
+
+        public:
+
+            /// Default number of features formatted together in one block.
+            static const size_t default_block_size = 1000;
+
+            /**
+             * Open output file and write the beginning of the
+             * FeatureCollection if needed.
+             *
+             * @param filename Name of output file. Empty or "-" for stdout.
+             * @param format Output format.
+             * @param num_threads Number of threads formatting blocks of features.
+             * @param block_size Number of features formatted together.
+             * @throws Osmium::OSMFile::IOError if the file can't be opened.
+             */
+            GeoJSON(const std::string& filename="",
+                    format_t format=newline_delimited,
+                    unsigned int num_threads=0,
+                    size_t block_size=default_block_size) :
+                m_output(filename),
+                m_format(format),
+                m_block_size(block_size > 0 ? block_size : 1),
+                m_pool(num_threads, true, num_threads * 4),
+                m_job(make_shared<Job>(format)),
+                m_first(true),
+                m_features(0),
+                m_skipped(0) {
+                if (m_format == feature_collection) {
+                    m_output.buffer().append("{\"type\":\"FeatureCollection\",\"features\":[");
+                }
+            }
+
+            ~GeoJSON() {
+                try {
+                    close();
+                } catch (...) {
+                    // ignore exceptions
+                }
+            }
+
+            void node(const shared_ptr<Osmium::OSM::Node const>& node) {
+                add(*node);
+            }
+
+            void way(const shared_ptr<Osmium::OSM::Way const>& way) {
+                add(*way);
+            }
+
+            void area(const shared_ptr<Osmium::OSM::Area const>& area) {
+                add(*area);
+            }
+
+            /**
+             * Format and write all remaining features, finish the
+             * FeatureCollection if needed, and close the output file.
+             *
+             * @throws Osmium::OSMFile::IOError if writing fails.
+             */
+            void close() {
+                if (!m_output.is_open()) {
+                    return;
+                }
+                submit();
+                drain(true);
+                if (m_format == feature_collection) {
+                    m_output.buffer().append("\n]}\n");
+                }
+                m_output.close();
+            }
+
+            /// Number of features written so far.
+            uint64_t features() const {
+                return m_features;
+            }
+
+            /// Number of objects not written because they have no geometry.
+            uint64_t skipped() const {
+                return m_skipped;
+            }
+
+        private:
+
+            void add(const Osmium::OSM::Object& object) {
+                if (!m_job->formatter.add(object)) {
+                    ++m_skipped;
+                    return;
+                }
+                if (m_job->formatter.size() >= m_block_size) {
+                    submit();
+                    drain(false);
+                }
+            }
+
+            void submit() {
+                if (!m_job->formatter.empty()) {
+                    m_pool.submit(m_job);
+                    m_job = make_shared<Job>(m_format);
+                }
+            }
+
+            /// Write the output of finished blocks.
+            void drain(bool wait) {
+                while (shared_ptr<Job> job = m_pool.next_finished(wait)) {
+                    write(job->output);
+                    m_features += job->features;
+                }
+            }
+
+            void write(const std::string& features) {
+                if (features.empty()) {
+                    return;
+                }
+                if (m_first && m_format == feature_collection) {
+                    m_output.buffer().append(features, 1, std::string::npos);
+                } else {
+                    m_output.buffer().append(features);
+                }
+                m_first = false;
+                m_output.flush_if_full();
+            }
+
+            OutputFile m_output;
+
+            const format_t m_format;
+
+            const size_t m_block_size;
+
+            Osmium::WorkerPool<Job> m_pool;
+
+            /// Block of features collected for formatting.
+            shared_ptr<Job> m_job;
+
+            /// No feature was written yet.
+            bool m_first;
+
+            uint64_t m_features;
+            uint64_t m_skipped;
+
+        }; // class GeoJSON
+
+    } // namespace Export
+
+} // namespace Osmium
+
+#endif // OSMIUM_EXPORT_GEOJSON_HPP
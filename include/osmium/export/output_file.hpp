@@ -0,0 +1,210 @@
+#ifndef OSMIUM_EXPORT_OUTPUT_FILE_HPP
+#define OSMIUM_EXPORT_OUTPUT_FILE_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <cerrno>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <boost/utility.hpp>
+
+#include <osmium/osmfile.hpp>
+
+namespace Osmium {
+
+    namespace Export {
+
+        /**
+         * Output file used by the exporters. Data is collected in a
+         * buffer and written to the file when the buffer is full or
+         * when flush() is called.
+         */
+        class OutputFile : boost::noncopyable {
+
+        public:
+
+            /// Default size of the buffer.
+            static const size_t default_buffer_size = 1024 * 1024;
+
+            /**
+             * Open output file.
+             *
+             * @param filename Name of output file. Empty or "-" for stdout.
+             * @param buffer_size flush_if_full() writes out the buffer if
+             *                    it grows over this size.
+             * @throws Osmium::OSMFile::IOError if the file can't be opened.
+             */
+            OutputFile(const std::string& filename="", size_t buffer_size=default_buffer_size) :
+                m_filename(filename),
+                m_fd(open_file(filename)),
+                m_buffer_size(buffer_size),
+                m_buffer(),
+                m_written(0) {
+                m_buffer.reserve(buffer_size + buffer_size / 4);
+            }
+
+            ~OutputFile() {
+                if (is_open()) {
+                    try {
+                        close();
+                    } catch (...) {
+                        // ignore errors in destructor, call close() to get them
+                    }
+                }
+            }
+
+            const std::string& filename() const {
+                return m_filename;
+            }
+
+            bool is_open() const {
+                return m_fd >= 0;
+            }
+
+            /// Buffer for the data to be written.
+            std::string& buffer() {
+                return m_buffer;
+            }
+
+            /// Number of bytes written so far, including the buffer.
+            uint64_t offset() const {
+                return m_written + m_buffer.size();
+            }
+
+            /// Write out the buffer if it is full.
+            void flush_if_full() {
+                if (m_buffer.size() >= m_buffer_size) {
+                    flush();
+                }
+            }
+
+            /**
+             * Write out the buffer.
+             *
+             * @throws Osmium::OSMFile::IOError if writing fails.
+             */
+            void flush() {
+                write_all(m_buffer.data(), m_buffer.size());
+                m_buffer.clear();
+            }
+
+            /**
+             * Write data after the buffer without copying it into the
+             * buffer first.
+             *
+             * @throws Osmium::OSMFile::IOError if writing fails.
+             */
+            void write(const char* data, size_t size) {
+                flush();
+                write_all(data, size);
+            }
+
+            void write(const std::string& data) {
+                write(data.data(), data.size());
+            }
+
+            /**
+             * Overwrite data at the given offset, for instance to fill
+             * in a header. Any buffered data is written first. Later
+             * writes continue after the data written here.
+             *
+             * @throws Osmium::OSMFile::IOError if seeking or writing fails.
+             */
+            void write_at(const std::string& data, off_t offset) {
+                flush();
+                if (::lseek(m_fd, offset, SEEK_SET) < 0) {
+                    throw Osmium::OSMFile::IOError("Seek failed", m_filename, errno);
+                }
+                m_written = offset;
+                write_all(data.data(), data.size());
+            }
+
+            /**
+             * Write out the buffer and close the file.
+             *
+             * @throws Osmium::OSMFile::IOError if writing fails.
+             */
+            void close() {
+                if (!is_open()) {
+                    return;
+                }
+                flush();
+                if (m_fd > 2) {
+                    ::close(m_fd);
+                }
+                m_fd = -1;
+            }
+
+        private:
+
+            static int open_file(const std::string& filename) {
+                if (filename == "" || filename == "-") {
+                    return 1; // stdout
+                }
+                int flags = O_WRONLY | O_TRUNC | O_CREAT;
+#ifdef WIN32
+                flags |= O_BINARY;
+#endif
+                const int fd = ::open(filename.c_str(), flags, 0666);
+                if (fd < 0) {
+                    throw Osmium::OSMFile::IOError("Open failed", filename, errno);
+                }
+                return fd;
+            }
+
+            void write_all(const char* data, size_t size) {
+                m_written += size;
+                while (size > 0) {
+                    const ssize_t written = ::write(m_fd, data, size);
+                    if (written < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        throw Osmium::OSMFile::IOError("Write failed", m_filename, errno);
+                    }
+                    data += written;
+                    size -= written;
+                }
+            }
+
+            const std::string m_filename;
+
+            int m_fd;
+
+            const size_t m_buffer_size;
+
+            std::string m_buffer;
+
+            /// Number of bytes written to the file.
+            uint64_t m_written;
+
+        }; // class OutputFile
+
+    } // namespace Export
+
+} // namespace Osmium
+
+#endif // OSMIUM_EXPORT_OUTPUT_FILE_HPP
@@ -0,0 +1,261 @@
+#ifndef OSMIUM_EXPORT_PG_COPY_HPP
+#define OSMIUM_EXPORT_PG_COPY_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <boost/foreach.hpp>
+#include <boost/utility.hpp>
+
+#include <osmium/osmfile.hpp>
+#include <osmium/osm/tag_list.hpp>
+#include <osmium/geometry/encoder.hpp>
+#include <osmium/export/output_file.hpp>
+#include <osmium/utils/json.hpp>
+
+namespace Osmium {
+
+    namespace Export {
+
+        /**
+         * Write rows in the binary format of the PostgreSQL COPY command.
+         * The output can be loaded with
+         * @code
+         *   COPY table FROM 'file' WITH (FORMAT binary);
+         * @endcode
+         * or piped into psql with "COPY table FROM STDIN WITH (FORMAT binary)".
+         *
+         * There is no conversion to and from text for the values: Ids are
+         * written as bigint, tags as hstore or jsonb, and geometries as
+         * EWKB with SRID 4326 which PostGIS reads directly into a geometry
+         * column. The columns in each row must match the types of the
+         * table columns exactly, PostgreSQL doesn't convert binary data.
+         *
+         * Use begin_row() and the add_*() functions to write rows with any
+         * columns, or row() for the common case of id, tags, and geometry.
+         */
+        class PgCopy : boost::noncopyable {
+
+        public:
+
+            /// Column type used for tags.
+            enum tags_format_t {
+                tags_as_hstore,
+                tags_as_jsonb
+            };
+
+            /**
+             * Open output file and write COPY header.
+             *
+             * @param filename Name of output file. Empty or "-" for stdout.
+             * @param tags_format Column type used for tags.
+             * @throws Osmium::OSMFile::IOError if the file can't be opened.
+             */
+            PgCopy(const std::string& filename="", tags_format_t tags_format=tags_as_hstore) :
+                m_output(filename),
+                m_tags_format(tags_format),
+                m_buffer(m_output.buffer()),
+                m_field_start(0),
+                m_rows(0) {
+                // signature, flags, header extension length
+                m_buffer.append("PGCOPY\n\377\r\n", 10);
+                m_buffer.append(1, '\0');
+                append<int32_t>(0);
+                append<int32_t>(0);
+            }
+
+            ~PgCopy() {
+                try {
+                    close();
+                } catch (...) {
+                    // ignore exceptions
+                }
+            }
+
+            /**
+             * Write the trailer, flush everything, and close the output file.
+             *
+             * @throws Osmium::OSMFile::IOError if writing fails.
+             */
+            void close() {
+                if (!m_output.is_open()) {
+                    return;
+                }
+                append<int16_t>(-1);
+                m_output.close();
+            }
+
+            /// Number of rows written so far.
+            uint64_t rows() const {
+                return m_rows;
+            }
+
+            /**
+             * Start a new row with the given number of columns. Each column
+             * must then be added with one of the add_*() functions.
+             */
+            void begin_row(int16_t columns) {
+                append<int16_t>(columns);
+                ++m_rows;
+            }
+
+            /**
+             * Finish a row. Output is written to the file in large blocks
+             * between rows.
+             */
+            void end_row() {
+                m_output.flush_if_full();
+            }
+
+            void add_null() {
+                append<int32_t>(-1);
+            }
+
+            /// Add bigint (int8) column.
+            void add_bigint(int64_t value) {
+                append<int32_t>(sizeof(int64_t));
+                append<int64_t>(value);
+            }
+
+            /// Add text or varchar column.
+            void add_text(const char* value) {
+                const size_t length = strlen(value);
+                append<int32_t>(length);
+                m_buffer.append(value, length);
+            }
+
+            void add_text(const std::string& value) {
+                append<int32_t>(value.size());
+                m_buffer.append(value);
+            }
+
+            /**
+             * Add tags as hstore or jsonb column depending on the format
+             * given in the constructor.
+             */
+            void add_tags(const Osmium::OSM::TagList& tags) {
+                begin_field();
+                if (m_tags_format == tags_as_hstore) {
+                    append<int32_t>(tags.size());
+                    BOOST_FOREACH(const Osmium::OSM::Tag& tag, tags) {
+                        add_text(tag.key());
+                        add_text(tag.value());
+                    }
+                } else {
+                    m_buffer.append(1, jsonb_version);
+                    m_buffer.append(1, '{');
+                    for (Osmium::OSM::TagList::const_iterator it = tags.begin(); it != tags.end(); ++it) {
+                        if (it != tags.begin()) {
+                            m_buffer.append(1, ',');
+                        }
+                        Osmium::JSON::append_string(m_buffer, it->key());
+                        m_buffer.append(1, ':');
+                        Osmium::JSON::append_string(m_buffer, it->value());
+                    }
+                    m_buffer.append(1, '}');
+                }
+                end_field();
+            }
+
+            /**
+             * Add PostGIS geometry column from a Point, LineString,
+             * Polygon, or MultiPolygon geometry. For MultiPolygon
+             * geometries include osmium/geometry/encoder_multipolygon.hpp,
+             * which needs GEOS.
+             */
+            template <class TGeometry>
+            void add_geometry(const TGeometry& geometry) {
+                begin_field();
+                Osmium::Geometry::WKBEncoder encoder(m_buffer, false, true);
+                encode(encoder, geometry);
+                end_field();
+            }
+
+            /**
+             * Write a row with the columns id (bigint), tags (hstore or
+             * jsonb) and geometry.
+             */
+            template <class TGeometry>
+            void row(osm_object_id_t id, const Osmium::OSM::TagList& tags, const TGeometry& geometry) {
+                begin_row(3);
+                add_bigint(id);
+                add_tags(tags);
+                add_geometry(geometry);
+                end_row();
+            }
+
+        private:
+
+            /// Version of the binary jsonb format.
+            static const char jsonb_version = 1;
+
+            /**
+             * Append integer value in network byte order.
+             */
+            template <typename T>
+            void append(T value) {
+                char data[sizeof(T)];
+                for (int i = sizeof(T) - 1; i >= 0; --i) {
+                    data[i] = static_cast<char>(value & 0xff);
+                    value >>= 8;
+                }
+                m_buffer.append(data, sizeof(T));
+            }
+
+            /**
+             * Start a field whose length is not known in advance. The length
+             * is filled in by end_field().
+             */
+            void begin_field() {
+                append<int32_t>(0);
+                m_field_start = m_buffer.size();
+            }
+
+            void end_field() {
+                uint32_t length = m_buffer.size() - m_field_start;
+                for (int i = 1; i <= 4; ++i) {
+                    m_buffer[m_field_start - i] = static_cast<char>(length & 0xff);
+                    length >>= 8;
+                }
+            }
+
+            OutputFile m_output;
+
+            const tags_format_t m_tags_format;
+
+            /// The buffer of m_output, the rows are appended to it directly.
+            std::string& m_buffer;
+
+            /// Position in m_buffer where the data of the current variable length field starts.
+            size_t m_field_start;
+
+            uint64_t m_rows;
+
+        }; // class PgCopy
+
+    } // namespace Export
+
+} // namespace Osmium
+
+#endif // OSMIUM_EXPORT_PG_COPY_HPP
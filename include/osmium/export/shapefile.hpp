@@ -58,8 +58,9 @@ namespace Osmium {
             // size of a DBF field descriptor
             static const size_t size_dbf_field_header = 32;
 
-        private:
-
+            /**
+             * Definition of a field in the DBF file.
+             */
             class Field {
 
             public:
@@ -101,6 +102,55 @@ namespace Osmium {
 
             };
 
+            /**
+             * Create field from a type given as string ("string", "integer",
+             * "double", or "bool"). Width and decimals are adjusted to what
+             * the type allows.
+             */
+            static Field make_field(const std::string& name, const std::string& type, int width=1, int decimals=0) {
+                DBFFieldType ftype;
+                if (type == "string") {
+                    ftype = FTString;
+                    decimals = 0;
+                } else if (type == "integer") {
+                    ftype = FTInteger;
+                    decimals = 0;
+                } else if (type == "double") {
+                    ftype = FTDouble;
+                } else if (type == "bool") {
+                    ftype = FTLogical;
+                    width = 1;
+                    decimals = 0;
+                } else {
+                    throw std::runtime_error("Unknown field type:" + type);
+                }
+
+                return Field(name, ftype, width, decimals);
+            }
+
+            /**
+             * Write the .prj file with the WGS84 projection and the .cpg
+             * file with the UTF-8 encoding next to a shapefile.
+             *
+             * @param basename Filename of the shapefile without suffix.
+             */
+            static void write_prj_and_cpg(const std::string& basename) {
+                std::ofstream file;
+                file.open((basename + ".prj").c_str());
+                if (file.fail()) {
+                    throw std::runtime_error("Can't open shapefile: " + basename + ".prj");
+                }
+                file << "GEOGCS[\"GCS_WGS_1984\",DATUM[\"D_WGS_1984\",SPHEROID[\"WGS_1984\",6378137,298.257223563]],PRIMEM[\"Greenwich\",0],UNIT[\"Degree\",0.017453292519943295]]" << std::endl;
+                file.close();
+
+                file.open((basename + ".cpg").c_str());
+                if (file.fail()) {
+                    throw std::runtime_error("Can't open shapefile: " + basename + ".cpg");
+                }
+                file << "UTF-8" << std::endl;
+                file.close();
+            }
+
         public:
 
             virtual ~Shapefile() {
@@ -155,25 +205,8 @@ namespace Osmium {
                            int width=1,             ///< The width of the field (number of digits for ints and doubles)
                            int decimals=0           ///< The precision of double fields (otherwise ignored)
                           ) {
-
-                DBFFieldType ftype;
-                if (type == "string") {
-                    ftype = FTString;
-                    decimals = 0;
-                } else if (type == "integer") {
-                    ftype = FTInteger;
-                    decimals = 0;
-                } else if (type == "double") {
-                    ftype = FTDouble;
-                } else if (type == "bool") {
-                    ftype = FTLogical;
-                    width = 1;
-                    decimals = 0;
-                } else {
-                    throw std::runtime_error("Unknown field type:" + type);
-                }
-
-                add_field(name, ftype, width, decimals);
+                Field field = make_field(name, type, width, decimals);
+                add_field(field);
             }
 
             const std::vector<Field>& fields() const {
@@ -352,20 +385,7 @@ namespace Osmium {
                     throw std::runtime_error("Can't open shapefile: " + filename.str() + ".dbf");
                 }
 
-                std::ofstream file;
-                file.open((filename.str() + ".prj").c_str());
-                if (file.fail()) {
-                    throw std::runtime_error("Can't open shapefile: " + filename.str() + ".prj");
-                }
-                file << "GEOGCS[\"GCS_WGS_1984\",DATUM[\"D_WGS_1984\",SPHEROID[\"WGS_1984\",6378137,298.257223563]],PRIMEM[\"Greenwich\",0],UNIT[\"Degree\",0.017453292519943295]]" << std::endl;
-                file.close();
-
-                file.open((filename.str() + ".cpg").c_str());
-                if (file.fail()) {
-                    throw std::runtime_error("Can't open shapefile: " + filename.str() + ".cpg");
-                }
-                file << "UTF-8" << std::endl;
-                file.close();
+                write_prj_and_cpg(filename.str());
 
                 // If any fields are defined already, add them here. This will do nothing if
                 // called from the constructor.
@@ -0,0 +1,374 @@
+#ifndef OSMIUM_EXPORT_TILE_BUCKETS_HPP
+#define OSMIUM_EXPORT_TILE_BUCKETS_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <boost/utility.hpp>
+
+#include <geos/geom/MultiPolygon.h>
+#include <geos/io/WKBReader.h>
+#include <geos/io/WKBWriter.h>
+
+#include <osmium/smart_ptr.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/geometry/geos.hpp>
+#include <osmium/geometry/multipolygon.hpp>
+#include <osmium/geometry/tile.hpp>
+#include <osmium/relations/spill_file.hpp>
+
+namespace Osmium {
+
+    namespace Export {
+
+        /**
+         * Writes OSM objects into one file per map tile, so that data
+         * can be split into tiles in a single pass.
+         *
+         * The files are called DIRECTORY/Z/X/Y.osmb. They contain the
+         * objects in the format of the Relations::SpillFile, each
+         * object prefixed by its length. Areas created from ways are
+         * stored with their nodes, areas created from multipolygon
+         * relations with their geometry as WKB. Use read() to get the
+         * objects back.
+         *
+         * There can be many more tiles than the operating system allows
+         * open files, so only a limited number of files are kept open.
+         * When another file is needed, the one used least recently is
+         * closed. Files are always opened for appending, so they should
+         * not exist from an earlier run.
+         */
+        class TileBucketFiles : boost::noncopyable {
+
+            struct OpenFile {
+                FILE* file;
+                std::list<Osmium::Geometry::Tile>::iterator lru_position;
+            };
+
+            typedef std::map<Osmium::Geometry::Tile, OpenFile> open_files_t;
+
+        public:
+
+            /// Default number of files kept open at the same time.
+            static const size_t default_max_open_files = 256;
+
+            /**
+             * @param directory Directory for the files. It is created if it doesn't exist.
+             * @param max_open_files Maximum number of files kept open at the same time.
+             */
+            TileBucketFiles(const std::string& directory, size_t max_open_files = default_max_open_files) :
+                m_directory(directory),
+                m_max_open_files(max_open_files > 0 ? max_open_files : 1),
+                m_open_files(),
+                m_lru(),
+                m_buffer(),
+                m_objects(0),
+                m_records(0),
+                m_opens(0) {
+                make_directory(m_directory);
+            }
+
+            ~TileBucketFiles() {
+                try {
+                    close();
+                } catch (...) {
+                    // ignore errors in destructor
+                }
+            }
+
+            /// Name of the file for a tile.
+            std::string filename(const Osmium::Geometry::Tile& tile) const {
+                std::ostringstream name;
+                name << m_directory << '/' << tile.z() << '/' << tile.x() << '/' << tile.y() << ".osmb";
+                return name.str();
+            }
+
+            /**
+             * Write a node, way, relation, or area to the files of all
+             * the given tiles. The object is serialized only once.
+             *
+             * @throws std::runtime_error if a file can't be opened or written.
+             */
+            void write(const std::vector<Osmium::Geometry::Tile>& tiles, const Osmium::OSM::Object& object) {
+                if (tiles.empty()) {
+                    return;
+                }
+
+                m_buffer.clear();
+                if (object.type() == AREA) {
+                    serialize_area(static_cast<const Osmium::OSM::Area&>(object));
+                } else {
+                    Osmium::Relations::SpillFile::serialize(object, m_buffer);
+                }
+
+                const uint32_t length = m_buffer.size();
+                for (std::vector<Osmium::Geometry::Tile>::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+                    FILE* file = get_file(*it);
+                    if (fwrite(&length, sizeof(length), 1, file) != 1 ||
+                        fwrite(m_buffer.data(), m_buffer.size(), 1, file) != 1) {
+                        throw std::runtime_error(std::string("can't write to tile bucket file: ") + strerror(errno));
+                    }
+                }
+
+                ++m_objects;
+                m_records += tiles.size();
+            }
+
+            /**
+             * Close all open files.
+             *
+             * @throws std::runtime_error if a file can't be closed.
+             */
+            void close() {
+                while (!m_lru.empty()) {
+                    close_least_recently_used();
+                }
+            }
+
+            /// Number of objects written.
+            uint64_t objects() const {
+                return m_objects;
+            }
+
+            /// Number of records written, one per object and tile.
+            uint64_t records() const {
+                return m_records;
+            }
+
+            /**
+             * Number of times a file was opened. If this is much larger
+             * than the number of tiles, more open files should be allowed.
+             */
+            uint64_t opens() const {
+                return m_opens;
+            }
+
+            /**
+             * Read all objects from a tile bucket file and call the
+             * node(), way(), relation(), or area() method of the
+             * handler for each of them.
+             *
+             * @returns Number of objects read.
+             * @throws std::runtime_error if the file can't be read.
+             */
+            template <class THandler>
+            static uint64_t read(const std::string& filename, THandler& handler) {
+                FILE* file = fopen(filename.c_str(), "rb");
+                if (!file) {
+                    throw std::runtime_error(std::string("can't open tile bucket file '") + filename + "': " + strerror(errno));
+                }
+
+                std::string buffer;
+                uint64_t count = 0;
+                uint32_t length;
+                while (fread(&length, sizeof(length), 1, file) == 1) {
+                    buffer.resize(length);
+                    if (length > 0 && fread(&buffer[0], length, 1, file) != 1) {
+                        fclose(file);
+                        throw std::runtime_error(std::string("truncated tile bucket file '") + filename + "'");
+                    }
+                    const char* data = buffer.data();
+                    if (static_cast<uint8_t>(*data) == AREA) {
+                        handler.area(deserialize_area(data));
+                    } else {
+                        shared_ptr<Osmium::OSM::Object> object = const_pointer_cast<Osmium::OSM::Object>(Osmium::Relations::SpillFile::deserialize(data));
+                        switch (object->type()) {
+                            case NODE:
+                                handler.node(static_pointer_cast<Osmium::OSM::Node>(object));
+                                break;
+                            case WAY:
+                                handler.way(static_pointer_cast<Osmium::OSM::Way>(object));
+                                break;
+                            case RELATION:
+                                handler.relation(static_pointer_cast<Osmium::OSM::Relation>(object));
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+                    ++count;
+                }
+
+                fclose(file);
+                return count;
+            }
+
+        private:
+
+            static void make_directory(const std::string& name) {
+                if (mkdir(name.c_str(), 0777) != 0 && errno != EEXIST) {
+                    throw std::runtime_error(std::string("can't create directory '") + name + "': " + strerror(errno));
+                }
+            }
+
+            /**
+             * Get the open file for a tile, opening it if necessary, and
+             * mark it as the most recently used one.
+             */
+            FILE* get_file(const Osmium::Geometry::Tile& tile) {
+                open_files_t::iterator it = m_open_files.find(tile);
+                if (it != m_open_files.end()) {
+                    m_lru.splice(m_lru.begin(), m_lru, it->second.lru_position);
+                    return it->second.file;
+                }
+
+                if (m_open_files.size() >= m_max_open_files) {
+                    close_least_recently_used();
+                }
+
+                std::ostringstream directory;
+                directory << m_directory << '/' << tile.z();
+                make_directory(directory.str());
+                directory << '/' << tile.x();
+                make_directory(directory.str());
+
+                const std::string name = filename(tile);
+                FILE* file = fopen(name.c_str(), "ab");
+                if (!file) {
+                    throw std::runtime_error(std::string("can't open tile bucket file '") + name + "': " + strerror(errno));
+                }
+                ++m_opens;
+
+                m_lru.push_front(tile);
+                OpenFile open_file = { file, m_lru.begin() };
+                m_open_files.insert(std::make_pair(tile, open_file));
+                return file;
+            }
+
+            void close_least_recently_used() {
+                open_files_t::iterator it = m_open_files.find(m_lru.back());
+                FILE* file = it->second.file;
+                m_open_files.erase(it);
+                m_lru.pop_back();
+                if (fclose(file) != 0) {
+                    throw std::runtime_error(std::string("can't close tile bucket file: ") + strerror(errno));
+                }
+            }
+
+            static void copy_attributes(const Osmium::OSM::Area& area, Osmium::OSM::Object& object) {
+                object.id(area.orig_id());
+                object.version(area.version());
+                object.changeset(area.changeset());
+                object.timestamp(area.timestamp());
+                object.endtime(area.endtime());
+                object.uid(area.uid());
+                object.user(area.user());
+                object.visible(area.visible());
+                object.tags(area.tags());
+            }
+
+            /**
+             * Areas are written as the AREA type, a flag whether it was
+             * created from a way, and the way (with the nodes of the
+             * area) or relation (without members) it was created from.
+             * Areas from relations are followed by the length of their
+             * WKB geometry and the WKB itself.
+             */
+            void serialize_area(const Osmium::OSM::Area& area) {
+                m_buffer.push_back(static_cast<char>(AREA));
+                m_buffer.push_back(area.from_way() ? 1 : 0);
+
+                if (area.from_way()) {
+                    Osmium::OSM::Way way;
+                    copy_attributes(area, way);
+                    way.nodes() = area.nodes();
+                    Osmium::Relations::SpillFile::serialize(way, m_buffer);
+                } else {
+                    Osmium::OSM::Relation relation;
+                    copy_attributes(area, relation);
+                    Osmium::Relations::SpillFile::serialize(relation, m_buffer);
+
+                    std::ostringstream wkb;
+                    geos::io::WKBWriter writer;
+                    writer.write(*Osmium::Geometry::MultiPolygon(area).borrow_geos_geometry(), wkb);
+                    const std::string& geometry = wkb.str();
+                    const uint32_t length = geometry.size();
+                    m_buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+                    m_buffer.append(geometry);
+                }
+            }
+
+            static shared_ptr<Osmium::OSM::Area> deserialize_area(const char*& data) {
+                ++data;
+                const bool from_way = *data++ != 0;
+                shared_ptr<Osmium::OSM::Object const> object = Osmium::Relations::SpillFile::deserialize(data);
+
+                if (from_way) {
+                    return make_shared<Osmium::OSM::Area>(static_cast<const Osmium::OSM::Way&>(*object));
+                }
+
+                shared_ptr<Osmium::OSM::Area> area = make_shared<Osmium::OSM::Area>(static_cast<const Osmium::OSM::Relation&>(*object));
+
+                uint32_t length;
+                memcpy(&length, data, sizeof(length));
+                data += sizeof(length);
+                std::istringstream wkb(std::string(data, length));
+                data += length;
+
+                geos::io::WKBReader reader(*Osmium::Geometry::geos_geometry_factory());
+                geos::geom::Geometry* geometry = reader.read(wkb);
+                geos::geom::MultiPolygon* multipolygon = dynamic_cast<geos::geom::MultiPolygon*>(geometry);
+                if (!multipolygon) {
+                    delete geometry;
+                    throw std::runtime_error("tile bucket file contains area geometry that is not a multipolygon");
+                }
+                area->geos_geometry(multipolygon);
+                return area;
+            }
+
+            const std::string m_directory;
+            const size_t m_max_open_files;
+
+            open_files_t m_open_files;
+
+            /// Tiles of the open files, most recently used first.
+            std::list<Osmium::Geometry::Tile> m_lru;
+
+            /// Serialized object, reused between objects.
+            std::string m_buffer;
+
+            uint64_t m_objects;
+            uint64_t m_records;
+            uint64_t m_opens;
+
+        }; // class TileBucketFiles
+
+    } // namespace Export
+
+} // namespace Osmium
+
+#endif // OSMIUM_EXPORT_TILE_BUCKETS_HPP
@@ -0,0 +1,399 @@
+#ifndef OSMIUM_GEOMETRY_CLIP_HPP
+#define OSMIUM_GEOMETRY_CLIP_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <osmium/osm/bounds.hpp>
+#include <osmium/osm/position.hpp>
+#include <osmium/osm/way_node_list.hpp>
+#include <osmium/geometry/ring.hpp>
+
+namespace Osmium {
+
+    namespace Geometry {
+
+        /**
+         * @brief Clipping of lines and rings against a bounding box or a
+         * convex polygon.
+         *
+         * The input is a range of Positions or WayNodes, the output goes
+         * into a std::vector<Position> or a WayNodeList. Positions where
+         * the geometry crosses the border of the clip region are new
+         * WayNodes with id 0. All calculations are done in the integer
+         * coordinate space of Position.
+         */
+        namespace Clip {
+
+            inline void append(std::vector<Osmium::OSM::Position>& out, const Osmium::OSM::Position& position) {
+                out.push_back(position);
+            }
+
+            inline void append(std::vector<Osmium::OSM::Position>& out, const Osmium::OSM::WayNode& way_node) {
+                out.push_back(way_node.position());
+            }
+
+            inline void append(Osmium::OSM::WayNodeList& out, const Osmium::OSM::Position& position) {
+                out.add(Osmium::OSM::WayNode(0, position));
+            }
+
+            inline void append(Osmium::OSM::WayNodeList& out, const Osmium::OSM::WayNode& way_node) {
+                out.add(way_node);
+            }
+
+            /**
+             * Convex region geometries are clipped against.
+             *
+             * Lines are clipped segment by segment (Cyrus-Beck) and can
+             * result in several pieces. Rings are clipped with the
+             * Sutherland-Hodgman algorithm and result in at most one
+             * ring. If a concave ring leaves and re-enters the region,
+             * the parts inside are connected along the border of the
+             * region.
+             */
+            class ConvexRegion {
+
+            public:
+
+                /**
+                 * Create region from a bounding box.
+                 */
+                ConvexRegion(const Osmium::OSM::Bounds& bounds) :
+                    m_vertices(),
+                    m_bounds(bounds) {
+                    if (!bounds.defined()) {
+                        throw std::invalid_argument("clip bounds not defined");
+                    }
+                    const Osmium::OSM::Position& bl = bounds.bottom_left();
+                    const Osmium::OSM::Position& tr = bounds.top_right();
+                    m_vertices.push_back(bl);
+                    m_vertices.push_back(Osmium::OSM::Position(tr.x(), bl.y()));
+                    m_vertices.push_back(tr);
+                    m_vertices.push_back(Osmium::OSM::Position(bl.x(), tr.y()));
+                }
+
+                /**
+                 * Create region from a convex polygon given as a range of
+                 * Positions or WayNodes. The polygon can be closed or not
+                 * and it can be oriented either way.
+                 *
+                 * @throws std::invalid_argument if the polygon is not convex.
+                 */
+                template <class TIterator>
+                ConvexRegion(TIterator begin, TIterator end) :
+                    m_vertices(),
+                    m_bounds() {
+                    for (TIterator it = begin; it != end; ++it) {
+                        const Osmium::OSM::Position& position = Ring::position(*it);
+                        if (m_vertices.empty() || !(m_vertices.back() == position)) {
+                            m_vertices.push_back(position);
+                            m_bounds.extend(position);
+                        }
+                    }
+                    if (m_vertices.size() > 1 && m_vertices.front() == m_vertices.back()) {
+                        m_vertices.pop_back();
+                    }
+                    if (m_vertices.size() < 3) {
+                        throw std::invalid_argument("clip polygon needs at least three positions");
+                    }
+
+                    bool ccw = false;
+                    bool cw = false;
+                    for (size_t i = 0; i < m_vertices.size(); ++i) {
+                        const double turn = cross(m_vertices[i], m_vertices[(i + 1) % m_vertices.size()], m_vertices[(i + 2) % m_vertices.size()]);
+                        ccw = ccw || turn > 0;
+                        cw = cw || turn < 0;
+                    }
+                    if (ccw == cw) {
+                        throw std::invalid_argument("clip polygon is not convex");
+                    }
+                    if (cw) {
+                        std::reverse(m_vertices.begin(), m_vertices.end());
+                    }
+                }
+
+                /// Bounding box of the region.
+                const Osmium::OSM::Bounds& bounds() const {
+                    return m_bounds;
+                }
+
+                /// Vertices of the region in counterclockwise order (not closed).
+                const std::vector<Osmium::OSM::Position>& vertices() const {
+                    return m_vertices;
+                }
+
+                /**
+                 * Is the position inside the region or on its border?
+                 */
+                bool contains(const Osmium::OSM::Position& position) const {
+                    if (!in_bounds(position)) {
+                        return false;
+                    }
+                    for (size_t edge = 0; edge < m_vertices.size(); ++edge) {
+                        if (side(edge, position) < 0) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                /**
+                 * Are all positions in the range inside the region? Because
+                 * the region is convex, the whole line or ring is inside
+                 * then.
+                 */
+                template <class TIterator>
+                bool contains(TIterator begin, TIterator end) const {
+                    for (TIterator it = begin; it != end; ++it) {
+                        if (!contains(Ring::position(*it))) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                /**
+                 * Clip a line.
+                 *
+                 * @param begin, end Range of Positions or WayNodes.
+                 * @param pieces The parts of the line inside the region
+                 *               are added here.
+                 * @returns Number of pieces added.
+                 */
+                template <class TIterator, class TContainer>
+                size_t clip_line(TIterator begin, TIterator end, std::vector<TContainer>& pieces) const {
+                    const size_t old_size = pieces.size();
+                    if (begin == end || outside_bounds(begin, end)) {
+                        return 0;
+                    }
+
+                    bool open = false;
+                    for (TIterator it = begin, next = begin; ++next != end; ++it) {
+                        const Osmium::OSM::Position& p = Ring::position(*it);
+                        const Osmium::OSM::Position& q = Ring::position(*next);
+                        double t0 = 0;
+                        double t1 = 1;
+                        if (!clip_segment(p, q, t0, t1)) {
+                            open = false;
+                            continue;
+                        }
+                        if (!open) {
+                            pieces.push_back(TContainer());
+                            if (t0 > 0) {
+                                append(pieces.back(), interpolate(p, q, t0));
+                            } else {
+                                append(pieces.back(), *it);
+                            }
+                            open = true;
+                        }
+                        if (t1 < 1) {
+                            append(pieces.back(), interpolate(p, q, t1));
+                            open = false;
+                        } else {
+                            append(pieces.back(), *next);
+                        }
+                    }
+
+                    // remove pieces that are only a point on the border
+                    typename std::vector<TContainer>::iterator last = pieces.begin() + old_size;
+                    for (typename std::vector<TContainer>::iterator piece = last; piece != pieces.end(); ++piece) {
+                        if (!is_point(*piece)) {
+                            if (piece != last) {
+                                *last = *piece;
+                            }
+                            ++last;
+                        }
+                    }
+                    pieces.erase(last, pieces.end());
+
+                    return pieces.size() - old_size;
+                }
+
+                /**
+                 * Clip a closed ring.
+                 *
+                 * @param begin, end Range of Positions or WayNodes. The
+                 *                   first and last position must be the same.
+                 * @param out The clipped ring is written here. It is closed.
+                 * @returns false if nothing of the ring is inside the region.
+                 */
+                template <class TIterator, class TContainer>
+                bool clip_ring(TIterator begin, TIterator end, TContainer& out) const {
+                    out.clear();
+                    if (begin == end || outside_bounds(begin, end)) {
+                        return false;
+                    }
+                    if (contains(begin, end)) {
+                        for (TIterator it = begin; it != end; ++it) {
+                            append(out, *it);
+                        }
+                        return true;
+                    }
+
+                    // the closing position is not copied
+                    TContainer buffer[2];
+                    int current = 0;
+                    for (TIterator it = begin, next = begin; ++next != end; ++it) {
+                        append(buffer[current], *it);
+                    }
+
+                    for (size_t edge = 0; edge < m_vertices.size() && buffer[current].size() > 0; ++edge) {
+                        const TContainer& in = buffer[current];
+                        TContainer& clipped = buffer[1 - current];
+                        clipped.clear();
+
+                        const size_t size = in.size();
+                        for (size_t i = 0; i < size; ++i) {
+                            const Osmium::OSM::Position& prev = Ring::position(in[(i + size - 1) % size]);
+                            const Osmium::OSM::Position& cur = Ring::position(in[i]);
+                            const double side_prev = side(edge, prev);
+                            const double side_cur = side(edge, cur);
+                            if (side_cur >= 0) {
+                                if (side_prev < 0) {
+                                    append(clipped, interpolate(prev, cur, side_prev / (side_prev - side_cur)));
+                                }
+                                append(clipped, in[i]);
+                            } else if (side_prev > 0) {
+                                append(clipped, interpolate(prev, cur, side_prev / (side_prev - side_cur)));
+                            }
+                        }
+
+                        current = 1 - current;
+                    }
+
+                    // remove duplicate positions created by rounding or
+                    // by vertices on the border
+                    const TContainer& result = buffer[current];
+                    std::vector<size_t> indexes;
+                    for (size_t i = 0; i < result.size(); ++i) {
+                        if (indexes.empty() || !(Ring::position(result[indexes.back()]) == Ring::position(result[i]))) {
+                            indexes.push_back(i);
+                        }
+                    }
+                    while (indexes.size() > 1 && Ring::position(result[indexes.back()]) == Ring::position(result[indexes.front()])) {
+                        indexes.pop_back();
+                    }
+                    if (indexes.size() < 3) {
+                        return false;
+                    }
+
+                    for (std::vector<size_t>::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
+                        append(out, result[*it]);
+                    }
+                    append(out, result[indexes.front()]);
+                    return true;
+                }
+
+            private:
+
+                /// Twice the signed area of the triangle a, b, c.
+                static double cross(const Osmium::OSM::Position& a, const Osmium::OSM::Position& b, const Osmium::OSM::Position& c) {
+                    return (static_cast<double>(b.x()) - a.x()) * (static_cast<double>(c.y()) - a.y()) -
+                           (static_cast<double>(b.y()) - a.y()) * (static_cast<double>(c.x()) - a.x());
+                }
+
+                /// Are all positions in the container the same?
+                template <class TContainer>
+                static bool is_point(const TContainer& container) {
+                    for (size_t i = 1; i < container.size(); ++i) {
+                        if (!(Ring::position(container[i]) == Ring::position(container[0]))) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                static Osmium::OSM::Position interpolate(const Osmium::OSM::Position& p, const Osmium::OSM::Position& q, double t) {
+                    return Osmium::OSM::Position(static_cast<int32_t>(lround(p.x() + t * (static_cast<double>(q.x()) - p.x()))),
+                                                 static_cast<int32_t>(lround(p.y() + t * (static_cast<double>(q.y()) - p.y()))));
+                }
+
+                /**
+                 * Positive if the position is on the inner side of the
+                 * edge, 0 if on the edge, negative if outside.
+                 */
+                double side(size_t edge, const Osmium::OSM::Position& position) const {
+                    return cross(m_vertices[edge], m_vertices[(edge + 1) % m_vertices.size()], position);
+                }
+
+                bool in_bounds(const Osmium::OSM::Position& position) const {
+                    return position.x() >= m_bounds.bottom_left().x() && position.x() <= m_bounds.top_right().x() &&
+                           position.y() >= m_bounds.bottom_left().y() && position.y() <= m_bounds.top_right().y();
+                }
+
+                /**
+                 * Check whether the bounding box of the range is
+                 * completely outside the bounding box of the region.
+                 */
+                template <class TIterator>
+                bool outside_bounds(TIterator begin, TIterator end) const {
+                    Osmium::OSM::Bounds bounds;
+                    for (TIterator it = begin; it != end; ++it) {
+                        bounds.extend(Ring::position(*it));
+                    }
+                    return bounds.top_right().x() < m_bounds.bottom_left().x() || bounds.bottom_left().x() > m_bounds.top_right().x() ||
+                           bounds.top_right().y() < m_bounds.bottom_left().y() || bounds.bottom_left().y() > m_bounds.top_right().y();
+                }
+
+                /**
+                 * Clip the segment p-q to the region. On return t0 and t1
+                 * are the parameters of the part inside.
+                 *
+                 * @returns false if no part of the segment is inside.
+                 */
+                bool clip_segment(const Osmium::OSM::Position& p, const Osmium::OSM::Position& q, double& t0, double& t1) const {
+                    for (size_t edge = 0; edge < m_vertices.size(); ++edge) {
+                        const double side_p = side(edge, p);
+                        const double side_q = side(edge, q);
+                        if (side_p < 0 && side_q < 0) {
+                            return false;
+                        }
+                        if (side_p < 0) {
+                            t0 = std::max(t0, side_p / (side_p - side_q));
+                        } else if (side_q < 0) {
+                            t1 = std::min(t1, side_p / (side_p - side_q));
+                        }
+                        if (t0 > t1) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                /// Vertices of the region in counterclockwise order.
+                std::vector<Osmium::OSM::Position> m_vertices;
+
+                Osmium::OSM::Bounds m_bounds;
+
+            }; // class ConvexRegion
+
+        } // namespace Clip
+
+    } // namespace Geometry
+
+} // namespace Osmium
+
+#endif // OSMIUM_GEOMETRY_CLIP_HPP
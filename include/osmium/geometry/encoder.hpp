@@ -0,0 +1,453 @@
+#ifndef OSMIUM_GEOMETRY_ENCODER_HPP
+#define OSMIUM_GEOMETRY_ENCODER_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <cstring>
+#include <iterator>
+#include <string>
+
+#include <osmium/geometry.hpp>
+#include <osmium/geometry/point.hpp>
+#include <osmium/geometry/linestring.hpp>
+#include <osmium/geometry/polygon.hpp>
+#include <osmium/geometry/ring.hpp>
+
+namespace Osmium {
+
+    namespace Geometry {
+
+        /**
+         * Encode geometries as WKB, EWKB, or hex encoded (E)WKB into a
+         * std::string buffer given by the caller.
+         *
+         * This does the same as the write_to_stream() methods of the
+         * geometry classes, but without going through a std::ostream
+         * for every value: The size of the encoded geometry is calculated
+         * up front, the buffer is grown once, and the data is copied
+         * into it. Hex encoding is done in place with a lookup table.
+         * Encoded geometries are appended to the buffer, clear it
+         * yourself if you want to reuse it.
+         *
+         * The coordinates can be given as ranges of Positions or WayNodes.
+         * Like the other WKB code in Osmium this assumes a little endian
+         * machine.
+         */
+        class WKBEncoder {
+
+        public:
+
+            WKBEncoder(std::string& buffer, bool hex=false, bool with_srid=false) :
+                m_buffer(buffer),
+                m_hex(hex),
+                m_with_srid(with_srid),
+                m_start(0) {
+            }
+
+            void point(const Osmium::OSM::Position& position) {
+                char* out = reserve(header_size() + coordinates_size(1));
+                out = header(out, wkbPoint);
+                out = coordinate(out, position);
+                finish();
+            }
+
+            template <class TIterator>
+            void linestring(TIterator begin, TIterator end) {
+                const uint32_t count = std::distance(begin, end);
+                char* out = reserve(header_size() + sizeof(uint32_t) + coordinates_size(count));
+                out = header(out, wkbLineString);
+                out = put<uint32_t>(out, count);
+                coordinates(out, begin, end);
+                finish();
+            }
+
+            /**
+             * Encode a polygon with a single ring. The ring must be closed.
+             */
+            template <class TIterator>
+            void polygon(TIterator begin, TIterator end) {
+                const uint32_t count = std::distance(begin, end);
+                char* out = reserve(header_size() + ring_size(count));
+                out = header(out, wkbPolygon);
+                out = ring(out, begin, end, count);
+                finish();
+            }
+
+            /**
+             * Encode a multipolygon with a single polygon with a single
+             * ring. The ring must be closed.
+             */
+            template <class TIterator>
+            void multipolygon(TIterator begin, TIterator end) {
+                const uint32_t count = std::distance(begin, end);
+                char* out = reserve(header_size() + sizeof(uint32_t) + plain_header_size + ring_size(count));
+                out = header(out, wkbMultiPolygon);
+                out = put<uint32_t>(out, 1); // polygon count
+                out = put<uint8_t>(out, wkbNDR);
+                out = put<uint32_t>(out, wkbPolygon);
+                out = ring(out, begin, end, count);
+                finish();
+            }
+
+            void encode(const Osmium::Geometry::Point& point) {
+                this->point(point.position());
+            }
+
+            void encode(const Osmium::Geometry::LineString& linestring) {
+                if (linestring.reverse()) {
+                    this->linestring(linestring.nodes().rbegin(), linestring.nodes().rend());
+                } else {
+                    this->linestring(linestring.nodes().begin(), linestring.nodes().end());
+                }
+            }
+
+            void encode(const Osmium::Geometry::Polygon& polygon) {
+                if (polygon.reverse()) {
+                    this->polygon(polygon.nodes().rbegin(), polygon.nodes().rend());
+                } else {
+                    this->polygon(polygon.nodes().begin(), polygon.nodes().end());
+                }
+            }
+
+        private:
+
+            // Encodes MultiPolygon geometries, see encoder_multipolygon.hpp.
+            friend class MultiPolygonEncoder;
+
+            /// Size of byte order marker and geometry type.
+            static const size_t plain_header_size = sizeof(uint8_t) + sizeof(uint32_t);
+
+            size_t header_size() const {
+                return plain_header_size + (m_with_srid ? sizeof(uint32_t) : 0);
+            }
+
+            static size_t coordinates_size(uint32_t count) {
+                return count * 2 * sizeof(double);
+            }
+
+            static size_t ring_size(uint32_t count) {
+                return sizeof(uint32_t) /* ring count */ + sizeof(uint32_t) /* point count */ + coordinates_size(count);
+            }
+
+            /**
+             * Grow the buffer by size bytes and return a pointer to the
+             * start of the new space. Enough space for the hex encoding is
+             * reserved at the same time.
+             */
+            char* reserve(size_t size) {
+                m_start = m_buffer.size();
+                m_buffer.reserve(m_start + (m_hex ? 2 * size : size));
+                m_buffer.resize(m_start + size);
+                return &m_buffer[m_start];
+            }
+
+            /**
+             * Hex encode the binary data written since the last reserve()
+             * if needed. This works from the back so that every byte is
+             * read before its place is overwritten.
+             */
+            void finish() {
+                if (!m_hex) {
+                    return;
+                }
+
+                static const char* lookup_hex =
+                    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+                    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+                    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+                    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+                    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+                    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+                    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+                    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+                const size_t size = m_buffer.size() - m_start;
+                m_buffer.resize(m_start + 2 * size);
+                char* data = &m_buffer[m_start];
+                for (size_t i = size; i > 0; --i) {
+                    const char* hex = lookup_hex + 2 * static_cast<unsigned char>(data[i - 1]);
+                    data[2 * i - 1] = hex[1];
+                    data[2 * i - 2] = hex[0];
+                }
+            }
+
+            template <typename T>
+            static char* put(char* out, const T value) {
+                memcpy(out, &value, sizeof(T));
+                return out + sizeof(T);
+            }
+
+            char* header(char* out, uint32_t type) const {
+                out = put<uint8_t>(out, wkbNDR);
+                if (m_with_srid) {
+                    out = put<uint32_t>(out, type | wkbSRID);
+                    out = put<uint32_t>(out, srid);
+                } else {
+                    out = put<uint32_t>(out, type);
+                }
+                return out;
+            }
+
+            static char* coordinate(char* out, const Osmium::OSM::Position& position) {
+                out = put<double>(out, position.lon());
+                return put<double>(out, position.lat());
+            }
+
+            template <class TIterator>
+            static char* coordinates(char* out, TIterator begin, TIterator end) {
+                for (TIterator it = begin; it != end; ++it) {
+                    out = coordinate(out, Osmium::Geometry::Ring::position(*it));
+                }
+                return out;
+            }
+
+            template <class TIterator>
+            static char* ring(char* out, TIterator begin, TIterator end, uint32_t count) {
+                out = put<uint32_t>(out, 1); // ring count
+                out = put<uint32_t>(out, count); // ring #1 point count
+                return coordinates(out, begin, end);
+            }
+
+            std::string& m_buffer;
+            const bool m_hex;
+            const bool m_with_srid;
+
+            /// Position in the buffer where the geometry currently encoded starts.
+            size_t m_start;
+
+        }; // class WKBEncoder
+
+        /**
+         * Encode geometries as WKT or EWKT (WKT with SRID) into a
+         * std::string buffer given by the caller.
+         *
+         * This does the same as the write_to_stream() methods of the
+         * geometry classes, but without going through a std::ostream.
+         * Coordinates are written directly from the fixed point values
+         * in the Positions. This gives the shortest representation that
+         * reads back to the same Position without any floating point
+         * formatting. Unlike the stream output it never uses exponents,
+         * so very small coordinates are written as "0.00001", not "1e-05".
+         * Encoded geometries are appended to the buffer.
+         */
+        class WKTEncoder {
+
+        public:
+
+            WKTEncoder(std::string& buffer, bool with_srid=false) :
+                m_buffer(buffer),
+                m_with_srid(with_srid),
+                m_start(0) {
+            }
+
+            void point(const Osmium::OSM::Position& position) {
+                char* out = reserve("POINT(", 1);
+                out = coordinate(out, position);
+                *out++ = ')';
+                finish(out);
+            }
+
+            template <class TIterator>
+            void linestring(TIterator begin, TIterator end) {
+                char* out = reserve("LINESTRING(", std::distance(begin, end));
+                out = coordinates(out, begin, end);
+                *out++ = ')';
+                finish(out);
+            }
+
+            /**
+             * Encode a polygon with a single ring. The ring must be closed.
+             */
+            template <class TIterator>
+            void polygon(TIterator begin, TIterator end) {
+                char* out = reserve("POLYGON((", std::distance(begin, end));
+                out = coordinates(out, begin, end);
+                *out++ = ')';
+                *out++ = ')';
+                finish(out);
+            }
+
+            /**
+             * Encode a multipolygon with a single polygon with a single
+             * ring. The ring must be closed.
+             */
+            template <class TIterator>
+            void multipolygon(TIterator begin, TIterator end) {
+                char* out = reserve("MULTIPOLYGON(((", std::distance(begin, end));
+                out = coordinates(out, begin, end);
+                *out++ = ')';
+                *out++ = ')';
+                *out++ = ')';
+                finish(out);
+            }
+
+            void encode(const Osmium::Geometry::Point& point) {
+                this->point(point.position());
+            }
+
+            void encode(const Osmium::Geometry::LineString& linestring) {
+                if (linestring.reverse()) {
+                    this->linestring(linestring.nodes().rbegin(), linestring.nodes().rend());
+                } else {
+                    this->linestring(linestring.nodes().begin(), linestring.nodes().end());
+                }
+            }
+
+            void encode(const Osmium::Geometry::Polygon& polygon) {
+                if (polygon.reverse()) {
+                    this->polygon(polygon.nodes().rbegin(), polygon.nodes().rend());
+                } else {
+                    this->polygon(polygon.nodes().begin(), polygon.nodes().end());
+                }
+            }
+
+            /**
+             * Write a fixed point coordinate as decimal number with as few
+             * digits as possible.
+             *
+             * @returns pointer to the character after the number
+             */
+            static char* format_coordinate(char* out, int32_t value) {
+                uint32_t v = value;
+                if (value < 0) {
+                    *out++ = '-';
+                    v = -static_cast<int64_t>(value);
+                }
+
+                uint32_t integer = v / Osmium::OSM::coordinate_precision;
+                uint32_t fraction = v % Osmium::OSM::coordinate_precision;
+
+                char digits[10];
+                int n = 0;
+                do {
+                    digits[n++] = '0' + integer % 10;
+                    integer /= 10;
+                } while (integer);
+                while (n) {
+                    *out++ = digits[--n];
+                }
+
+                if (fraction) {
+                    *out++ = '.';
+                    int ndigits = 7;
+                    while (fraction % 10 == 0) {
+                        fraction /= 10;
+                        --ndigits;
+                    }
+                    for (int i = ndigits - 1; i >= 0; --i) {
+                        out[i] = '0' + fraction % 10;
+                        fraction /= 10;
+                    }
+                    out += ndigits;
+                }
+
+                return out;
+            }
+
+        private:
+
+            // Encodes MultiPolygon geometries, see encoder_multipolygon.hpp.
+            friend class MultiPolygonEncoder;
+
+            /// Maximum length of one coordinate: "-214.7483648 -214.7483648,"
+            static const size_t max_coordinate_size = 2 * 12 + 2;
+
+            /**
+             * Grow the buffer by the maximum size the geometry could need and
+             * write the SRID and geometry type. The buffer is shrunk to the
+             * real size in finish().
+             *
+             * @param type Geometry type including the opening parentheses.
+             * @param count Number of coordinates.
+             * @param extra Number of parentheses and commas needed beyond
+             *              those for a single ring.
+             */
+            char* reserve(const char* type, size_t count, size_t extra=0) {
+                const size_t type_size = strlen(type);
+                size_t max_size = type_size + count * max_coordinate_size + 3 + extra;
+                if (m_with_srid) {
+                    max_size += srid_prefix_size;
+                }
+
+                m_start = m_buffer.size();
+                m_buffer.resize(m_start + max_size);
+                char* out = &m_buffer[m_start];
+
+                if (m_with_srid) {
+                    memcpy(out, srid_prefix(), srid_prefix_size);
+                    out += srid_prefix_size;
+                }
+                memcpy(out, type, type_size);
+                return out + type_size;
+            }
+
+            void finish(const char* out) {
+                m_buffer.resize(out - m_buffer.data());
+            }
+
+            static const char* srid_prefix() {
+                return "SRID=4326;";
+            }
+
+            static const size_t srid_prefix_size = 10;
+
+            static char* coordinate(char* out, const Osmium::OSM::Position& position) {
+                out = format_coordinate(out, position.x());
+                *out++ = ' ';
+                return format_coordinate(out, position.y());
+            }
+
+            template <class TIterator>
+            static char* coordinates(char* out, TIterator begin, TIterator end) {
+                for (TIterator it = begin; it != end; ++it) {
+                    if (it != begin) {
+                        *out++ = ',';
+                    }
+                    out = coordinate(out, Osmium::Geometry::Ring::position(*it));
+                }
+                return out;
+            }
+
+            std::string& m_buffer;
+            const bool m_with_srid;
+
+            /// Position in the buffer where the geometry currently encoded starts.
+            size_t m_start;
+
+        }; // class WKTEncoder
+
+        /**
+         * Encode a geometry with the given WKBEncoder or WKTEncoder. Call
+         * this unqualified from templates, so that the overloads for
+         * MultiPolygon geometries in osmium/geometry/encoder_multipolygon.hpp
+         * are found if that header is included.
+         */
+        template <class TEncoder, class TGeometry>
+        inline void encode(TEncoder& encoder, const TGeometry& geometry) {
+            encoder.encode(geometry);
+        }
+
+    } // namespace Geometry
+
+} // namespace Osmium
+
+#endif // OSMIUM_GEOMETRY_ENCODER_HPP
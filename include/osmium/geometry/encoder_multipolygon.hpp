@@ -0,0 +1,167 @@
+#ifndef OSMIUM_GEOMETRY_ENCODER_MULTIPOLYGON_HPP
+#define OSMIUM_GEOMETRY_ENCODER_MULTIPOLYGON_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <geos/geom/CoordinateSequence.h>
+#include <geos/geom/LineString.h>
+#include <geos/geom/MultiPolygon.h>
+#include <geos/geom/Polygon.h>
+
+#include <osmium/geometry/encoder.hpp>
+#include <osmium/geometry/multipolygon.hpp>
+
+namespace Osmium {
+
+    namespace Geometry {
+
+        /**
+         * Encode MultiPolygon geometries and GEOS multipolygons with the
+         * WKBEncoder and WKTEncoder. This is in its own header because
+         * it needs GEOS, the encoders for the other geometries don't.
+         */
+        class MultiPolygonEncoder {
+
+        public:
+
+            /**
+             * Encode a GEOS multipolygon with any number of polygons and
+             * rings as (E)WKB.
+             */
+            static void multipolygon(WKBEncoder& encoder, const geos::geom::MultiPolygon& multipolygon) {
+                size_t size = encoder.header_size() + sizeof(uint32_t);
+                for (size_t i = 0; i < multipolygon.getNumGeometries(); ++i) {
+                    const geos::geom::Polygon* polygon = dynamic_cast<const geos::geom::Polygon*>(multipolygon.getGeometryN(i));
+                    size += WKBEncoder::plain_header_size + sizeof(uint32_t) + sizeof(uint32_t) + WKBEncoder::coordinates_size(polygon->getExteriorRing()->getNumPoints());
+                    for (size_t j = 0; j < polygon->getNumInteriorRing(); ++j) {
+                        size += sizeof(uint32_t) + WKBEncoder::coordinates_size(polygon->getInteriorRingN(j)->getNumPoints());
+                    }
+                }
+
+                char* out = encoder.reserve(size);
+                out = encoder.header(out, wkbMultiPolygon);
+                out = WKBEncoder::put<uint32_t>(out, multipolygon.getNumGeometries());
+                for (size_t i = 0; i < multipolygon.getNumGeometries(); ++i) {
+                    const geos::geom::Polygon* polygon = dynamic_cast<const geos::geom::Polygon*>(multipolygon.getGeometryN(i));
+                    out = WKBEncoder::put<uint8_t>(out, wkbNDR);
+                    out = WKBEncoder::put<uint32_t>(out, wkbPolygon);
+                    out = WKBEncoder::put<uint32_t>(out, 1 + polygon->getNumInteriorRing());
+                    out = wkb_ring(out, *polygon->getExteriorRing());
+                    for (size_t j = 0; j < polygon->getNumInteriorRing(); ++j) {
+                        out = wkb_ring(out, *polygon->getInteriorRingN(j));
+                    }
+                }
+                encoder.finish();
+            }
+
+            /**
+             * Encode a GEOS multipolygon with any number of polygons and
+             * rings as (E)WKT.
+             */
+            static void multipolygon(WKTEncoder& encoder, const geos::geom::MultiPolygon& multipolygon) {
+                size_t count = 0;
+                size_t parens = 0;
+                for (size_t i = 0; i < multipolygon.getNumGeometries(); ++i) {
+                    const geos::geom::Polygon* polygon = dynamic_cast<const geos::geom::Polygon*>(multipolygon.getGeometryN(i));
+                    count += polygon->getExteriorRing()->getNumPoints();
+                    for (size_t j = 0; j < polygon->getNumInteriorRing(); ++j) {
+                        count += polygon->getInteriorRingN(j)->getNumPoints();
+                    }
+                    parens += 3 * (2 + polygon->getNumInteriorRing());
+                }
+
+                char* out = encoder.reserve("MULTIPOLYGON(", count, parens);
+                for (size_t i = 0; i < multipolygon.getNumGeometries(); ++i) {
+                    const geos::geom::Polygon* polygon = dynamic_cast<const geos::geom::Polygon*>(multipolygon.getGeometryN(i));
+                    if (i > 0) {
+                        *out++ = ',';
+                    }
+                    *out++ = '(';
+                    out = wkt_ring(out, *polygon->getExteriorRing());
+                    for (size_t j = 0; j < polygon->getNumInteriorRing(); ++j) {
+                        *out++ = ',';
+                        out = wkt_ring(out, *polygon->getInteriorRingN(j));
+                    }
+                    *out++ = ')';
+                }
+                *out++ = ')';
+                encoder.finish(out);
+            }
+
+            /**
+             * Encode the multipolygon of an area. Areas created from ways
+             * are written from their node list, all others from their
+             * GEOS geometry.
+             */
+            template <class TEncoder>
+            static void encode(TEncoder& encoder, const Osmium::Geometry::MultiPolygon& multipolygon) {
+                if (!multipolygon.from_nodes()) {
+                    MultiPolygonEncoder::multipolygon(encoder, *multipolygon.borrow_geos_geometry());
+                } else if (multipolygon.reverse()) {
+                    encoder.multipolygon(multipolygon.nodes().rbegin(), multipolygon.nodes().rend());
+                } else {
+                    encoder.multipolygon(multipolygon.nodes().begin(), multipolygon.nodes().end());
+                }
+            }
+
+        private:
+
+            /// Write point count and coordinates of a GEOS ring as WKB.
+            static char* wkb_ring(char* out, const geos::geom::LineString& ring) {
+                const geos::geom::CoordinateSequence* cs = ring.getCoordinatesRO();
+                out = WKBEncoder::put<uint32_t>(out, cs->getSize());
+                for (size_t i = 0; i < cs->getSize(); ++i) {
+                    out = WKBEncoder::put<double>(out, cs->getAt(i).x);
+                    out = WKBEncoder::put<double>(out, cs->getAt(i).y);
+                }
+                return out;
+            }
+
+            /// Write a GEOS ring in parentheses as WKT.
+            static char* wkt_ring(char* out, const geos::geom::LineString& ring) {
+                const geos::geom::CoordinateSequence* cs = ring.getCoordinatesRO();
+                *out++ = '(';
+                for (size_t i = 0; i < cs->getSize(); ++i) {
+                    if (i > 0) {
+                        *out++ = ',';
+                    }
+                    out = WKTEncoder::coordinate(out, Osmium::OSM::Position(cs->getAt(i).x, cs->getAt(i).y));
+                }
+                *out++ = ')';
+                return out;
+            }
+
+        }; // class MultiPolygonEncoder
+
+        inline void encode(WKBEncoder& encoder, const Osmium::Geometry::MultiPolygon& multipolygon) {
+            MultiPolygonEncoder::encode(encoder, multipolygon);
+        }
+
+        inline void encode(WKTEncoder& encoder, const Osmium::Geometry::MultiPolygon& multipolygon) {
+            MultiPolygonEncoder::encode(encoder, multipolygon);
+        }
+
+    } // namespace Geometry
+
+} // namespace Osmium
+
+#endif // OSMIUM_GEOMETRY_ENCODER_MULTIPOLYGON_HPP
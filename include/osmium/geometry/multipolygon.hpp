@@ -22,6 +22,11 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 
 */
 
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <vector>
+
 #include <geos/geom/Geometry.h>
 #include <geos/geom/MultiPolygon.h>
 #include <geos/io/WKBWriter.h>
@@ -32,37 +37,82 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 #include <osmium/geometry.hpp>
 #include <osmium/geometry/polygon.hpp>
 #include <osmium/geometry/geos.hpp>
+#include <osmium/geometry/ring.hpp>
 
 namespace Osmium {
 
     namespace Geometry {
 
+        /**
+         * MultiPolygon geometry of an Area.
+         *
+         * Areas created from relations already have a GEOS geometry which
+         * is used for all output. Areas created from closed ways are
+         * written directly from their node list with the ring oriented
+         * counterclockwise, no GEOS geometry is created for them unless
+         * the ring touches or intersects itself or somebody asks for the
+         * GEOS geometry.
+         */
         class MultiPolygon : public Geometry {
 
         public:
 
             MultiPolygon(const Osmium::OSM::Area& area) :
                 Geometry(area.id()),
-                m_area(area) {
+                m_area(area),
+                m_reverse(false) {
 
                 // if the area doesn't have a geometry yet it means it was created from a way
-                // and we create the geometry from the node list.
                 if (!area.geos_geometry()) {
-                    Osmium::Geometry::Polygon polygon(area.m_node_list, false, area.id());
-                    std::vector<geos::geom::Geometry*>* geos_polygons = new std::vector<geos::geom::Geometry*>(1, Osmium::Geometry::create_geos_geometry(polygon));
-                    geos::geom::MultiPolygon* geos_multipolygon = Osmium::Geometry::geos_geometry_factory()->createMultiPolygon(geos_polygons);
-                    assert(geos_multipolygon);
-                    m_area.geos_geometry(geos_multipolygon);
+                    const Osmium::OSM::WayNodeList& nodes = area.nodes();
+                    if (!nodes.is_closed()) {
+                        throw RingNotClosed();
+                    }
+                    m_reverse = !Osmium::Geometry::Ring::is_ccw(nodes.begin(), nodes.end());
+                    if (nodes.size() < 4 || !Osmium::Geometry::Ring::is_simple(nodes.begin(), nodes.end())) {
+                        create_geos_geometry_from_nodes();
+                    }
                 }
             }
 
             ~MultiPolygon() {
             }
 
+            /**
+             * Is this the geometry of an area created from a way that is
+             * written directly from its node list?
+             */
+            bool from_nodes() const {
+                return !m_area.geos_geometry();
+            }
+
+            /// Node list of an area created from a way.
+            const Osmium::OSM::WayNodeList& nodes() const {
+                return m_area.nodes();
+            }
+
+            /**
+             * Does the node list of an area created from a way have to be
+             * reversed to get a counterclockwise ring?
+             */
+            bool reverse() const {
+                return m_reverse;
+            }
+
             std::ostream& write_to_stream(std::ostream& out, AsWKT, bool with_srid=false) const {
                 if (with_srid) {
                     out << "SRID=4326;";
                 }
+                if (!m_area.geos_geometry()) {
+                    LonLatListWriter<Osmium::OSM::WayNode> writer(out);
+                    out << "MULTIPOLYGON(((" << std::setprecision(10);
+                    if (m_reverse) {
+                        std::for_each(m_area.nodes().rbegin(), m_area.nodes().rend(), writer);
+                    } else {
+                        std::for_each(m_area.nodes().begin(), m_area.nodes().end(), writer);
+                    }
+                    return out << ")))";
+                }
                 geos::io::WKTWriter writer;
                 // XXX only available in later GEOS versions
 //                writer.setRoundingPrecision(10);
@@ -70,6 +120,25 @@ namespace Osmium {
             }
 
             std::ostream& write_to_stream(std::ostream& out, AsWKB, bool with_srid=false) const {
+                if (!m_area.geos_geometry()) {
+                    write_binary_wkb_header(out, with_srid, wkbMultiPolygon);
+                    write_binary<uint32_t>(out, 1); // polygon count
+                    write_binary_wkb_header(out, false, wkbPolygon);
+                    write_binary<uint32_t>(out, 1); // ring count
+                    write_binary<uint32_t>(out, m_area.nodes().size()); // ring #1 point count
+                    if (m_reverse) {
+                        for (Osmium::OSM::WayNodeList::const_reverse_iterator it = m_area.nodes().rbegin(); it != m_area.nodes().rend(); ++it) {
+                            write_binary<double>(out, it->lon());
+                            write_binary<double>(out, it->lat());
+                        }
+                    } else {
+                        for (Osmium::OSM::WayNodeList::const_iterator it = m_area.nodes().begin(); it != m_area.nodes().end(); ++it) {
+                            write_binary<double>(out, it->lon());
+                            write_binary<double>(out, it->lat());
+                        }
+                    }
+                    return out;
+                }
                 geos::io::WKBWriter writer;
                 writer.setIncludeSRID(with_srid);
                 writer.write(*borrow_geos_geometry(), out);
@@ -77,6 +146,25 @@ namespace Osmium {
             }
 
             std::ostream& write_to_stream(std::ostream& out, AsHexWKB, bool with_srid=false) const {
+                if (!m_area.geos_geometry()) {
+                    write_hex_wkb_header(out, with_srid, wkbMultiPolygon);
+                    write_hex<uint32_t>(out, 1); // polygon count
+                    write_hex_wkb_header(out, false, wkbPolygon);
+                    write_hex<uint32_t>(out, 1); // ring count
+                    write_hex<uint32_t>(out, m_area.nodes().size()); // ring #1 point count
+                    if (m_reverse) {
+                        for (Osmium::OSM::WayNodeList::const_reverse_iterator it = m_area.nodes().rbegin(); it != m_area.nodes().rend(); ++it) {
+                            write_hex<double>(out, it->lon());
+                            write_hex<double>(out, it->lat());
+                        }
+                    } else {
+                        for (Osmium::OSM::WayNodeList::const_iterator it = m_area.nodes().begin(); it != m_area.nodes().end(); ++it) {
+                            write_hex<double>(out, it->lon());
+                            write_hex<double>(out, it->lat());
+                        }
+                    }
+                    return out;
+                }
                 geos::io::WKBWriter writer;
                 writer.setIncludeSRID(with_srid);
                 writer.writeHEX(*borrow_geos_geometry(), out);
@@ -87,8 +175,15 @@ namespace Osmium {
              * Get GEOS MultiPolygon geometry. The geometry still
              * belongs to this object, you are not allowed to change
              * or free it.
+             *
+             * For areas created from ways the GEOS geometry is created
+             * on the first call.
              */
             const geos::geom::MultiPolygon* borrow_geos_geometry() const {
+                if (!m_area.geos_geometry() && !m_area.nodes().empty()) {
+                    create_geos_geometry_from_nodes();
+                }
+
                 if (!m_area.geos_geometry()) {
                     throw Osmium::Geometry::NoGeometry();
                 }
@@ -98,8 +193,23 @@ namespace Osmium {
 
         private:
 
+            /**
+             * Create GEOS geometry from the node list of an area created
+             * from a way and store it in the area.
+             */
+            void create_geos_geometry_from_nodes() const {
+                Osmium::Geometry::Polygon polygon(m_area.nodes(), m_reverse, m_area.id());
+                std::vector<geos::geom::Geometry*>* geos_polygons = new std::vector<geos::geom::Geometry*>(1, Osmium::Geometry::create_geos_geometry(polygon));
+                geos::geom::MultiPolygon* geos_multipolygon = Osmium::Geometry::geos_geometry_factory()->createMultiPolygon(geos_polygons);
+                assert(geos_multipolygon);
+                m_area.geos_geometry(geos_multipolygon);
+            }
+
             const Osmium::OSM::Area& m_area;
 
+            /// Write the nodes of an area created from a way in reverse order to get a counterclockwise ring.
+            bool m_reverse;
+
         }; // class MultiPolygon
 
     } // namespace Geometry
@@ -0,0 +1,112 @@
+#ifndef OSMIUM_GEOMETRY_RING_HPP
+#define OSMIUM_GEOMETRY_RING_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include <osmium/osm/position.hpp>
+#include <osmium/osm/way_node.hpp>
+#include <osmium/geometry/segment_intersections.hpp>
+
+namespace Osmium {
+
+    namespace Geometry {
+
+        /**
+         * @brief Functions working on rings given as a range of Positions or WayNodes.
+         *
+         * The rings must be closed, ie the first and last position must
+         * be the same.
+         */
+        namespace Ring {
+
+            inline const Osmium::OSM::Position& position(const Osmium::OSM::Position& position) {
+                return position;
+            }
+
+            inline const Osmium::OSM::Position& position(const Osmium::OSM::WayNode& way_node) {
+                return way_node.position();
+            }
+
+            /**
+             * Calculate twice the signed area of a ring in coordinate units.
+             * It is positive if the ring is oriented counterclockwise and
+             * negative if it is oriented clockwise.
+             */
+            template <class TIterator>
+            inline double signed_area(TIterator begin, TIterator end) {
+                double area = 0;
+                if (begin == end) {
+                    return area;
+                }
+                for (TIterator it = begin, next = begin; ++next != end; ++it) {
+                    const Osmium::OSM::Position& p1 = position(*it);
+                    const Osmium::OSM::Position& p2 = position(*next);
+                    area += static_cast<int64_t>(p1.x()) * p2.y() - static_cast<int64_t>(p2.x()) * p1.y();
+                }
+                return area;
+            }
+
+            /**
+             * Is this ring oriented counterclockwise?
+             */
+            template <class TIterator>
+            inline bool is_ccw(TIterator begin, TIterator end) {
+                return signed_area(begin, end) > 0;
+            }
+
+            /**
+             * Check whether a ring is simple, ie it doesn't touch or
+             * intersect itself. The ring must have at least four positions.
+             *
+             * This is much cheaper than asking GEOS, so it can be used as a
+             * first test and GEOS only gets to look at rings that fail it.
+             */
+            template <class TIterator>
+            inline bool is_simple(TIterator begin, TIterator end) {
+                std::vector<Osmium::OSM::Position> positions;
+                for (TIterator it = begin; it != end; ++it) {
+                    positions.push_back(position(*it));
+                }
+
+                Osmium::Geometry::SegmentIntersections segments;
+                segments.add(positions.begin(), positions.end());
+
+                // a ring going through the same position twice touches itself
+                positions.pop_back();
+                std::sort(positions.begin(), positions.end());
+                if (std::adjacent_find(positions.begin(), positions.end()) != positions.end()) {
+                    return false;
+                }
+
+                return !segments.any();
+            }
+
+        } // namespace Ring
+
+    } // namespace Geometry
+
+} // namespace Osmium
+
+#endif // OSMIUM_GEOMETRY_RING_HPP
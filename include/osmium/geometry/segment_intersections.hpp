@@ -0,0 +1,216 @@
+#ifndef OSMIUM_GEOMETRY_SEGMENT_INTERSECTIONS_HPP
+#define OSMIUM_GEOMETRY_SEGMENT_INTERSECTIONS_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <osmium/osm/position.hpp>
+#include <osmium/osm/undirected_segment.hpp>
+
+namespace Osmium {
+
+    namespace Geometry {
+
+        /**
+         * Orientation of the Position c relative to the line from a to b.
+         *
+         * The products are compared instead of subtracted, each of them
+         * fits into 64 bit for all valid coordinates, so the result is
+         * exact.
+         *
+         * @returns 1 if c is left of the line, -1 if it is right of it, 0 if all three are collinear.
+         */
+        inline int orientation(const Osmium::OSM::Position& a, const Osmium::OSM::Position& b, const Osmium::OSM::Position& c) {
+            const int64_t left  = (static_cast<int64_t>(b.x()) - a.x()) * (static_cast<int64_t>(c.y()) - a.y());
+            const int64_t right = (static_cast<int64_t>(b.y()) - a.y()) * (static_cast<int64_t>(c.x()) - a.x());
+            if (left > right) {
+                return 1;
+            } else if (left < right) {
+                return -1;
+            }
+            return 0;
+        }
+
+        /**
+         * Is the Position p, which must be collinear with the segment,
+         * on the segment (including its end points)?
+         */
+        inline bool on_segment(const Osmium::OSM::UndirectedSegment& segment, const Osmium::OSM::Position& p) {
+            return std::min(segment.first().x(), segment.second().x()) <= p.x() && p.x() <= std::max(segment.first().x(), segment.second().x()) &&
+                   std::min(segment.first().y(), segment.second().y()) <= p.y() && p.y() <= std::max(segment.first().y(), segment.second().y());
+        }
+
+        /**
+         * Check whether two segments intersect.
+         *
+         * Segments that only touch at a common end point do not count as
+         * intersecting, this is what two consecutive segments of a ring do.
+         * Segments touching at an end point of only one of them, crossing,
+         * or overlapping each other (including identical segments) count
+         * as intersecting.
+         */
+        inline bool segments_intersect(const Osmium::OSM::UndirectedSegment& s1, const Osmium::OSM::UndirectedSegment& s2) {
+            const Osmium::OSM::Position& p1 = s1.first();
+            const Osmium::OSM::Position& p2 = s1.second();
+            const Osmium::OSM::Position& q1 = s2.first();
+            const Osmium::OSM::Position& q2 = s2.second();
+
+            const int d1 = orientation(q1, q2, p1);
+            const int d2 = orientation(q1, q2, p2);
+            const int d3 = orientation(p1, p2, q1);
+            const int d4 = orientation(p1, p2, q2);
+
+            if (d1 == 0 && d2 == 0) {
+                // collinear segments: they intersect if they have more than a common end point in common
+                if (p2 == q1) {
+                    return on_segment(s2, p1) || on_segment(s1, q2);
+                }
+                if (q2 == p1) {
+                    return on_segment(s1, q1) || on_segment(s2, p2);
+                }
+                return on_segment(s2, p1) || on_segment(s2, p2) || on_segment(s1, q1) || on_segment(s1, q2);
+            }
+
+            if (p1 == q1 || p1 == q2 || p2 == q1 || p2 == q2) {
+                return false;
+            }
+
+            if (d1 * d2 < 0 && d3 * d4 < 0) {
+                return true;
+            }
+
+            return (d1 == 0 && on_segment(s2, p1)) ||
+                   (d2 == 0 && on_segment(s2, p2)) ||
+                   (d3 == 0 && on_segment(s1, q1)) ||
+                   (d4 == 0 && on_segment(s1, q2));
+        }
+
+        /**
+         * Finds intersections between segments without going through
+         * GEOS. Used to check whether rings are simple before doing
+         * anything expensive with them.
+         *
+         * The segments are sorted by their left end and swept from left
+         * to right. Each segment is only tested against the segments
+         * starting before it ends. This is fast for the usual OSM data
+         * where segments are short compared to the extent of the rings.
+         */
+        class SegmentIntersections {
+
+        public:
+
+            SegmentIntersections() :
+                m_segments(),
+                m_intersections() {
+            }
+
+            /**
+             * Add a segment. Segments of length zero are ignored.
+             */
+            void add(const Osmium::OSM::Position& p1, const Osmium::OSM::Position& p2) {
+                if (!(p1 == p2)) {
+                    m_segments.push_back(Osmium::OSM::UndirectedSegment(p1, p2));
+                }
+            }
+
+            /**
+             * Add the segments between consecutive positions in the range.
+             */
+            template <class TIterator>
+            void add(TIterator begin, TIterator end) {
+                if (begin == end) {
+                    return;
+                }
+                for (TIterator it = begin, next = begin; ++next != end; ++it) {
+                    add(*it, *next);
+                }
+            }
+
+            size_t size() const {
+                return m_segments.size();
+            }
+
+            void clear() {
+                m_segments.clear();
+                m_intersections.clear();
+            }
+
+            /**
+             * Find intersecting pairs of segments.
+             *
+             * @param stop_at_first Stop after the first intersection was found.
+             * @returns Number of intersecting pairs found.
+             */
+            size_t find(bool stop_at_first=false) {
+                m_intersections.clear();
+                std::sort(m_segments.begin(), m_segments.end());
+
+                for (std::vector<Osmium::OSM::UndirectedSegment>::const_iterator it = m_segments.begin(); it != m_segments.end(); ++it) {
+                    const int32_t ymin = std::min(it->first().y(), it->second().y());
+                    const int32_t ymax = std::max(it->first().y(), it->second().y());
+                    for (std::vector<Osmium::OSM::UndirectedSegment>::const_iterator other = it+1; other != m_segments.end() && other->first().x() <= it->second().x(); ++other) {
+                        if (std::max(other->first().y(), other->second().y()) < ymin ||
+                            std::min(other->first().y(), other->second().y()) > ymax) {
+                            continue;
+                        }
+                        if (segments_intersect(*it, *other)) {
+                            m_intersections.push_back(std::make_pair(*it, *other));
+                            if (stop_at_first) {
+                                return m_intersections.size();
+                            }
+                        }
+                    }
+                }
+
+                return m_intersections.size();
+            }
+
+            /**
+             * Is there at least one intersection?
+             */
+            bool any() {
+                return find(true) > 0;
+            }
+
+            /**
+             * Intersecting pairs of segments found by the last call to find().
+             */
+            const std::vector< std::pair<Osmium::OSM::UndirectedSegment, Osmium::OSM::UndirectedSegment> >& intersections() const {
+                return m_intersections;
+            }
+
+        private:
+
+            std::vector<Osmium::OSM::UndirectedSegment> m_segments;
+
+            std::vector< std::pair<Osmium::OSM::UndirectedSegment, Osmium::OSM::UndirectedSegment> > m_intersections;
+
+        }; // class SegmentIntersections
+
+    } // namespace Geometry
+
+} // namespace Osmium
+
+#endif // OSMIUM_GEOMETRY_SEGMENT_INTERSECTIONS_HPP
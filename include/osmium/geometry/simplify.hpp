@@ -0,0 +1,292 @@
+#ifndef OSMIUM_GEOMETRY_SIMPLIFY_HPP
+#define OSMIUM_GEOMETRY_SIMPLIFY_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include <osmium/osm/position.hpp>
+#include <osmium/osm/way_node_list.hpp>
+#include <osmium/geometry/ring.hpp>
+
+namespace Osmium {
+
+    namespace Geometry {
+
+        /**
+         * @brief Line simplification on way node lists.
+         *
+         * All calculations are done in the integer coordinate space of
+         * Position, so tolerances are given in coordinate units (degrees
+         * times Osmium::OSM::coordinate_precision). The first and last
+         * node are always kept, so ways sharing end nodes stay connected.
+         *
+         * Both algorithms give the same result when run on a node list
+         * and on the reversed node list. Borders shared by two ways
+         * running in opposite directions are simplified the same way.
+         */
+        namespace Simplify {
+
+            enum algorithm_t {
+                DOUGLAS_PEUCKER    = 0,
+                VISVALINGAM_WHYATT = 1
+            };
+
+            /**
+             * Squared distance of position p from the segment between a
+             * and b in coordinate units.
+             */
+            inline double distance_squared(const Osmium::OSM::Position& p, const Osmium::OSM::Position& a, const Osmium::OSM::Position& b) {
+                const double dx = static_cast<double>(b.x()) - a.x();
+                const double dy = static_cast<double>(b.y()) - a.y();
+                double px = static_cast<double>(p.x()) - a.x();
+                double py = static_cast<double>(p.y()) - a.y();
+
+                const double length_squared = dx * dx + dy * dy;
+                if (length_squared > 0) {
+                    const double t = (px * dx + py * dy) / length_squared;
+                    if (t >= 1) {
+                        px -= dx;
+                        py -= dy;
+                    } else if (t > 0) {
+                        px -= t * dx;
+                        py -= t * dy;
+                    }
+                }
+
+                return px * px + py * py;
+            }
+
+            /**
+             * Area of the triangle between three positions in squared
+             * coordinate units.
+             */
+            inline double triangle_area(const Osmium::OSM::Position& a, const Osmium::OSM::Position& b, const Osmium::OSM::Position& c) {
+                const double area = (static_cast<double>(b.x()) - a.x()) * (static_cast<double>(c.y()) - a.y()) -
+                                    (static_cast<double>(c.x()) - a.x()) * (static_cast<double>(b.y()) - a.y());
+                return (area < 0 ? -area : area) / 2;
+            }
+
+            /**
+             * Mark the positions in the range that are kept by the
+             * Douglas-Peucker algorithm.
+             *
+             * @param begin, end Random access range of Positions or WayNodes.
+             * @param tolerance Maximum distance of removed positions from the simplified line.
+             * @param keep Set to one entry per position, true if it is kept.
+             */
+            template <class TIterator>
+            inline void douglas_peucker(TIterator begin, TIterator end, double tolerance, std::vector<bool>& keep) {
+                const size_t size = end - begin;
+                keep.assign(size, false);
+                if (size == 0) {
+                    return;
+                }
+                keep.front() = true;
+                keep.back() = true;
+
+                const double tolerance_squared = tolerance * tolerance;
+                std::vector< std::pair<size_t, size_t> > stack;
+                stack.push_back(std::make_pair(0, size - 1));
+
+                while (!stack.empty()) {
+                    const size_t first = stack.back().first;
+                    const size_t last = stack.back().second;
+                    stack.pop_back();
+
+                    const Osmium::OSM::Position& a = Ring::position(begin[first]);
+                    const Osmium::OSM::Position& b = Ring::position(begin[last]);
+
+                    double max_distance = -1;
+                    size_t max_index = first;
+                    for (size_t i = first + 1; i < last; ++i) {
+                        const Osmium::OSM::Position& p = Ring::position(begin[i]);
+                        const double distance = distance_squared(p, a, b);
+                        // ties are decided by position so the result
+                        // doesn't depend on the direction of the line
+                        if (distance > max_distance || (distance == max_distance && p < Ring::position(begin[max_index]))) {
+                            max_distance = distance;
+                            max_index = i;
+                        }
+                    }
+
+                    if (max_distance > tolerance_squared) {
+                        keep[max_index] = true;
+                        stack.push_back(std::make_pair(first, max_index));
+                        stack.push_back(std::make_pair(max_index, last));
+                    }
+                }
+            }
+
+            /**
+             * Entry in the priority queue of the Visvalingam-Whyatt
+             * algorithm.
+             */
+            struct Triangle {
+
+                double area;
+                Osmium::OSM::Position position;
+                size_t index;
+
+                Triangle(double a, const Osmium::OSM::Position& p, size_t i) :
+                    area(a),
+                    position(p),
+                    index(i) {
+                }
+
+                /// Reversed, so that the priority queue returns the smallest area first.
+                bool operator<(const Triangle& other) const {
+                    if (area == other.area) {
+                        return other.position < position;
+                    }
+                    return area > other.area;
+                }
+
+            }; // struct Triangle
+
+            /**
+             * Mark the positions in the range that are kept by the
+             * Visvalingam-Whyatt algorithm. Positions are removed in
+             * order of the area of the triangle they form with their
+             * neighbours, as long as that area is smaller than the
+             * square of the tolerance.
+             *
+             * @param begin, end Random access range of Positions or WayNodes.
+             * @param tolerance Positions with an effective area smaller than tolerance squared are removed.
+             * @param keep Set to one entry per position, true if it is kept.
+             */
+            template <class TIterator>
+            inline void visvalingam_whyatt(TIterator begin, TIterator end, double tolerance, std::vector<bool>& keep) {
+                const size_t size = end - begin;
+                keep.assign(size, true);
+                if (size < 3) {
+                    return;
+                }
+
+                std::vector<size_t> prev(size);
+                std::vector<size_t> next(size);
+                std::vector<double> area(size, 0);
+                std::priority_queue<Triangle> queue;
+
+                for (size_t i = 0; i < size; ++i) {
+                    prev[i] = i - 1;
+                    next[i] = i + 1;
+                }
+                for (size_t i = 1; i < size - 1; ++i) {
+                    area[i] = triangle_area(Ring::position(begin[i-1]), Ring::position(begin[i]), Ring::position(begin[i+1]));
+                    queue.push(Triangle(area[i], Ring::position(begin[i]), i));
+                }
+
+                const double min_area = tolerance * tolerance;
+                while (!queue.empty()) {
+                    const Triangle triangle = queue.top();
+                    queue.pop();
+
+                    const size_t i = triangle.index;
+                    if (!keep[i] || triangle.area != area[i]) {
+                        continue; // outdated entry
+                    }
+                    if (triangle.area >= min_area) {
+                        break;
+                    }
+
+                    keep[i] = false;
+                    next[prev[i]] = next[i];
+                    prev[next[i]] = prev[i];
+
+                    // the effective area of the neighbours never gets
+                    // smaller than that of the position just removed
+                    const size_t neighbours[2] = { prev[i], next[i] };
+                    for (int n = 0; n < 2; ++n) {
+                        const size_t j = neighbours[n];
+                        if (j == 0 || j == size - 1) {
+                            continue;
+                        }
+                        area[j] = std::max(triangle.area, triangle_area(Ring::position(begin[prev[j]]), Ring::position(begin[j]), Ring::position(begin[next[j]])));
+                        queue.push(Triangle(area[j], Ring::position(begin[j]), j));
+                    }
+                }
+            }
+
+            /**
+             * Simplify a way node list.
+             *
+             * @param nodes Nodes to simplify. They must have positions.
+             * @param algorithm Algorithm used.
+             * @param tolerance Tolerance in coordinate units.
+             * @param out Simplified nodes are written here.
+             */
+            inline void simplify(const Osmium::OSM::WayNodeList& nodes, algorithm_t algorithm, double tolerance, Osmium::OSM::WayNodeList& out) {
+                std::vector<bool> keep;
+                if (algorithm == VISVALINGAM_WHYATT) {
+                    visvalingam_whyatt(nodes.begin(), nodes.end(), tolerance, keep);
+                } else {
+                    douglas_peucker(nodes.begin(), nodes.end(), tolerance, keep);
+                }
+
+                out.clear();
+                for (osm_sequence_id_t i = 0; i < nodes.size(); ++i) {
+                    if (keep[i]) {
+                        out.add(nodes[i]);
+                    }
+                }
+            }
+
+            /**
+             * Simplify a closed ring keeping it valid: The result has at
+             * least four nodes and doesn't touch or intersect itself. If
+             * the simplified ring is not valid, the tolerance is halved
+             * and simplification is tried again.
+             *
+             * @param nodes Nodes of the ring. They must have positions.
+             * @param algorithm Algorithm used.
+             * @param tolerance Tolerance in coordinate units.
+             * @param out Simplified nodes are written here.
+             * @param max_tries Number of times the tolerance is halved.
+             * @returns false if every try gave an invalid ring. In that
+             *          case out contains a copy of the nodes.
+             */
+            inline bool simplify_ring(const Osmium::OSM::WayNodeList& nodes, algorithm_t algorithm, double tolerance, Osmium::OSM::WayNodeList& out, int max_tries=8) {
+                for (int i = 0; i <= max_tries; ++i, tolerance /= 2) {
+                    simplify(nodes, algorithm, tolerance, out);
+                    if (out.size() == nodes.size()) {
+                        return true;
+                    }
+                    if (out.size() >= 4 && Ring::is_simple(out.begin(), out.end())) {
+                        return true;
+                    }
+                }
+
+                out = nodes;
+                return false;
+            }
+
+        } // namespace Simplify
+
+    } // namespace Geometry
+
+} // namespace Osmium
+
+#endif // OSMIUM_GEOMETRY_SIMPLIFY_HPP
@@ -0,0 +1,397 @@
+#ifndef OSMIUM_GEOMETRY_TILE_HPP
+#define OSMIUM_GEOMETRY_TILE_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <osmium/osm/bounds.hpp>
+#include <osmium/osm/position.hpp>
+#include <osmium/geometry/projection.hpp>
+
+namespace Osmium {
+
+    namespace Geometry {
+
+        /**
+         * A map tile in the usual z/x/y scheme of Web Mercator tiles with
+         * x growing to the east and y growing to the south.
+         */
+        class Tile {
+
+        public:
+
+            Tile(uint32_t z, uint32_t x, uint32_t y) :
+                m_z(z),
+                m_x(x),
+                m_y(y) {
+            }
+
+            uint32_t z() const {
+                return m_z;
+            }
+
+            uint32_t x() const {
+                return m_x;
+            }
+
+            uint32_t y() const {
+                return m_y;
+            }
+
+            friend bool operator==(const Tile& lhs, const Tile& rhs) {
+                return lhs.m_z == rhs.m_z && lhs.m_x == rhs.m_x && lhs.m_y == rhs.m_y;
+            }
+
+            friend bool operator!=(const Tile& lhs, const Tile& rhs) {
+                return !(lhs == rhs);
+            }
+
+            /// Tiles are ordered by zoom, then row by row.
+            friend bool operator<(const Tile& lhs, const Tile& rhs) {
+                if (lhs.m_z != rhs.m_z) {
+                    return lhs.m_z < rhs.m_z;
+                }
+                if (lhs.m_y != rhs.m_y) {
+                    return lhs.m_y < rhs.m_y;
+                }
+                return lhs.m_x < rhs.m_x;
+            }
+
+        private:
+
+            uint32_t m_z;
+            uint32_t m_x;
+            uint32_t m_y;
+
+        }; // class Tile
+
+        /**
+         * Finds the tiles at a zoom level a geometry intersects.
+         *
+         * Positions are projected with Mercator::project() and then
+         * scaled to tile units, so that the integer part of a coordinate
+         * is the tile number. Positions beyond the latitude limit of Web
+         * Mercator are put into the first or last row of tiles.
+         *
+         * Lines are rasterized segment by segment, visiting every tile
+         * a segment passes through. Lines with a bounding box of at most
+         * two tiles skip this step because they always touch all tiles
+         * in their bounding box. Rings additionally get all tiles whose
+         * center is inside the ring.
+         *
+         * The tiles are returned sorted and without duplicates. All
+         * methods reuse internal buffers, so a TileCover should be kept
+         * around and used for many geometries.
+         */
+        class TileCover {
+
+        public:
+
+            /// Highest zoom level supported.
+            static const uint32_t max_zoom = 30;
+
+            /**
+             * @throws std::invalid_argument if zoom is larger than max_zoom.
+             */
+            TileCover(uint32_t zoom) :
+                m_zoom(zoom),
+                m_tiles_per_side(check_zoom(zoom)),
+                m_limit(m_tiles_per_side * (1 - 1e-12)),
+                m_scale(m_tiles_per_side / (2 * Mercator::MAX_COORDINATE)),
+                m_x(),
+                m_y(),
+                m_min_x(0),
+                m_max_x(0),
+                m_min_y(0),
+                m_max_y(0),
+                m_crossings() {
+            }
+
+            uint32_t zoom() const {
+                return m_zoom;
+            }
+
+            uint32_t tiles_per_side() const {
+                return m_tiles_per_side;
+            }
+
+            /// Tile containing the position.
+            Tile tile(const Osmium::OSM::Position& position) {
+                double lon = position.lon();
+                double lat = position.lat();
+                double x;
+                double y;
+                Mercator::project(1, &lon, &lat, &x, &y);
+                return Tile(m_zoom, cell(tile_x(x)), cell(tile_y(y)));
+            }
+
+            /**
+             * Tiles intersecting a line.
+             *
+             * @param begin, end Range of Positions or WayNodes.
+             * @param tiles The tiles are written here, old content is removed.
+             * @returns Number of tiles.
+             */
+            template <class TIterator>
+            size_t line(TIterator begin, TIterator end, std::vector<Tile>& tiles) {
+                tiles.clear();
+                if (load(begin, end) == 0) {
+                    return 0;
+                }
+
+                if (find_bbox() <= 2) {
+                    add_bbox(tiles);
+                } else {
+                    rasterize(tiles);
+                    sort_and_unique(tiles);
+                }
+                return tiles.size();
+            }
+
+            /**
+             * Tiles intersecting a closed ring. The ring must have the
+             * first node repeated at the end.
+             *
+             * @param begin, end Range of Positions or WayNodes.
+             * @param tiles The tiles are written here, old content is removed.
+             * @returns Number of tiles.
+             */
+            template <class TIterator>
+            size_t ring(TIterator begin, TIterator end, std::vector<Tile>& tiles) {
+                tiles.clear();
+                if (load(begin, end) == 0) {
+                    return 0;
+                }
+
+                if (find_bbox() <= 2) {
+                    add_bbox(tiles);
+                } else {
+                    rasterize(tiles);
+                    fill(tiles);
+                    sort_and_unique(tiles);
+                }
+                return tiles.size();
+            }
+
+            /**
+             * Tiles intersecting a bounding box. Note that large boxes at
+             * high zoom levels contain a lot of tiles.
+             *
+             * @param bounds Bounding box, nothing is returned if it is undefined.
+             * @param tiles The tiles are written here, old content is removed.
+             * @returns Number of tiles.
+             */
+            size_t box(const Osmium::OSM::Bounds& bounds, std::vector<Tile>& tiles) {
+                tiles.clear();
+                if (!bounds.defined()) {
+                    return 0;
+                }
+                const Osmium::OSM::Position corners[2] = { bounds.bottom_left(), bounds.top_right() };
+                load(corners, corners + 2);
+                find_bbox();
+                add_bbox(tiles);
+                return tiles.size();
+            }
+
+        private:
+
+            static uint32_t check_zoom(uint32_t zoom) {
+                if (zoom > max_zoom) {
+                    throw std::invalid_argument("zoom level too large for tiles");
+                }
+                return 1U << zoom;
+            }
+
+            double limit(double value) const {
+                return value < 0 ? 0 : (value > m_limit ? m_limit : value);
+            }
+
+            double tile_x(double x) const {
+                return limit((x + Mercator::MAX_COORDINATE) * m_scale);
+            }
+
+            double tile_y(double y) const {
+                return limit((Mercator::MAX_COORDINATE - y) * m_scale);
+            }
+
+            static uint32_t cell(double value) {
+                return static_cast<uint32_t>(value);
+            }
+
+            /**
+             * Project the positions and convert them to tile units in
+             * m_x and m_y.
+             *
+             * @returns Number of positions.
+             */
+            template <class TIterator>
+            size_t load(TIterator begin, TIterator end) {
+                m_x.clear();
+                m_y.clear();
+                Mercator::project(begin, end, m_x, m_y);
+                for (size_t i = 0; i < m_x.size(); ++i) {
+                    m_x[i] = tile_x(m_x[i]);
+                    m_y[i] = tile_y(m_y[i]);
+                }
+                return m_x.size();
+            }
+
+            /**
+             * Find the bounding box of the loaded positions in tiles and
+             * remember it in m_min_* and m_max_*.
+             *
+             * @returns Number of tiles in the box.
+             */
+            size_t find_bbox() {
+                m_min_x = m_max_x = cell(m_x[0]);
+                m_min_y = m_max_y = cell(m_y[0]);
+                for (size_t i = 1; i < m_x.size(); ++i) {
+                    m_min_x = std::min(m_min_x, cell(m_x[i]));
+                    m_max_x = std::max(m_max_x, cell(m_x[i]));
+                    m_min_y = std::min(m_min_y, cell(m_y[i]));
+                    m_max_y = std::max(m_max_y, cell(m_y[i]));
+                }
+                return static_cast<size_t>(m_max_x - m_min_x + 1) * (m_max_y - m_min_y + 1);
+            }
+
+            /// Add all tiles in the bounding box found by find_bbox().
+            void add_bbox(std::vector<Tile>& tiles) const {
+                for (uint32_t y = m_min_y; y <= m_max_y; ++y) {
+                    for (uint32_t x = m_min_x; x <= m_max_x; ++x) {
+                        tiles.push_back(Tile(m_zoom, x, y));
+                    }
+                }
+            }
+
+            /**
+             * Add the tiles each segment of the loaded positions passes
+             * through. This is a grid traversal (Amanatides-Woo) that
+             * steps from tile to tile, always crossing the nearer of the
+             * next vertical or horizontal tile border.
+             */
+            void rasterize(std::vector<Tile>& tiles) const {
+                const double infinity = std::numeric_limits<double>::infinity();
+
+                uint32_t x = cell(m_x[0]);
+                uint32_t y = cell(m_y[0]);
+                tiles.push_back(Tile(m_zoom, x, y));
+
+                for (size_t i = 1; i < m_x.size(); ++i) {
+                    const uint32_t end_x = cell(m_x[i]);
+                    const uint32_t end_y = cell(m_y[i]);
+                    const double dx = std::fabs(m_x[i] - m_x[i-1]);
+                    const double dy = std::fabs(m_y[i] - m_y[i-1]);
+                    const int step_x = m_x[i] > m_x[i-1] ? 1 : -1;
+                    const int step_y = m_y[i] > m_y[i-1] ? 1 : -1;
+
+                    // distance (as fraction of the segment) to the next
+                    // tile border and between tile borders on each axis
+                    double next_x = dx > 0 ? (step_x > 0 ? x + 1 - m_x[i-1] : m_x[i-1] - x) / dx : infinity;
+                    double next_y = dy > 0 ? (step_y > 0 ? y + 1 - m_y[i-1] : m_y[i-1] - y) / dy : infinity;
+                    const double delta_x = dx > 0 ? 1 / dx : infinity;
+                    const double delta_y = dy > 0 ? 1 / dy : infinity;
+
+                    while (x != end_x || y != end_y) {
+                        if (y == end_y || (x != end_x && next_x < next_y)) {
+                            x += step_x;
+                            next_x += delta_x;
+                        } else {
+                            y += step_y;
+                            next_y += delta_y;
+                        }
+                        tiles.push_back(Tile(m_zoom, x, y));
+                    }
+                }
+            }
+
+            /**
+             * Add the tiles whose center is inside the loaded ring. For
+             * each row of tiles the ring is intersected with the
+             * horizontal line through the tile centers (even-odd rule).
+             * The first and last row and column of the bounding box are
+             * skipped because their tiles inside the ring are always
+             * border tiles already found by rasterize().
+             */
+            void fill(std::vector<Tile>& tiles) {
+                for (uint32_t row = m_min_y + 1; row < m_max_y; ++row) {
+                    const double center = row + 0.5;
+
+                    m_crossings.clear();
+                    for (size_t i = 1; i < m_x.size(); ++i) {
+                        const double y1 = m_y[i-1];
+                        const double y2 = m_y[i];
+                        if ((y1 <= center) != (y2 <= center)) {
+                            m_crossings.push_back(m_x[i-1] + (center - y1) * (m_x[i] - m_x[i-1]) / (y2 - y1));
+                        }
+                    }
+                    std::sort(m_crossings.begin(), m_crossings.end());
+
+                    for (size_t i = 1; i < m_crossings.size(); i += 2) {
+                        const double first = std::max(m_min_x + 1.0, std::ceil(m_crossings[i-1] - 0.5));
+                        const double last = std::min(m_max_x - 1.0, std::floor(m_crossings[i] - 0.5));
+                        for (double column = first; column <= last; ++column) {
+                            tiles.push_back(Tile(m_zoom, cell(column), row));
+                        }
+                    }
+                }
+            }
+
+            static void sort_and_unique(std::vector<Tile>& tiles) {
+                std::sort(tiles.begin(), tiles.end());
+                tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+            }
+
+            const uint32_t m_zoom;
+            const uint32_t m_tiles_per_side;
+
+            /// Largest tile coordinate, just below m_tiles_per_side.
+            const double m_limit;
+
+            /// Factor from Mercator coordinates to tile units.
+            const double m_scale;
+
+            /// Positions in tile units, reused between geometries.
+            std::vector<double> m_x;
+            std::vector<double> m_y;
+
+            /// Bounding box of the loaded positions in tiles, set by find_bbox().
+            uint32_t m_min_x;
+            uint32_t m_max_x;
+            uint32_t m_min_y;
+            uint32_t m_max_y;
+
+            /// Ring crossings of the current row in fill().
+            std::vector<double> m_crossings;
+
+        }; // class TileCover
+
+    } // namespace Geometry
+
+} // namespace Osmium
+
+#endif // OSMIUM_GEOMETRY_TILE_HPP
@@ -0,0 +1,192 @@
+#ifndef OSMIUM_HANDLER_BATCHED_COORDINATES_FOR_WAYS_HPP
+#define OSMIUM_HANDLER_BATCHED_COORDINATES_FOR_WAYS_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <osmium/handler.hpp>
+
+namespace Osmium {
+
+    namespace Handler {
+
+        /**
+         * Handler to retrieve locations from nodes and add them to ways,
+         * like CoordinatesForWays, but looking up the locations for many
+         * ways at once.
+         *
+         * Ways are collected until the batch is full. Then all node
+         * references of all ways in the batch are sorted by node id and
+         * each distinct location is read from the storage only once, in
+         * ascending id order. This turns the random access pattern of
+         * the per-way lookup into a mostly sequential sweep over the
+         * storage. Storage classes that support it are told to prefetch
+         * locations a few ids ahead of the current one.
+         *
+         * After the locations are set the ways are forwarded to the next
+         * handler in the order they were read. Everything else is
+         * forwarded immediately; the nodes also go to the
+         * CoordinatesForWays handler given in the constructor, so it
+         * does not need to be called separately.
+         *
+         * Note that ways are held back until the batch is full or until
+         * after_ways() is called, so the next handler must not rely on
+         * getting a way before the following one is read.
+         *
+         * @tparam TCoordinatesForWays CoordinatesForWays class used for storing
+         *                             and retrieving the node locations.
+         * @tparam THandler Handler the ways with locations are forwarded to.
+         */
+        template <class TCoordinatesForWays, class THandler>
+        class BatchedCoordinatesForWays : public Forward<THandler> {
+
+            typedef std::pair<osm_object_id_t, Osmium::OSM::WayNode*> node_ref_t;
+
+        public:
+
+            /// Default number of ways in a batch.
+            static const size_t default_batch_size = 1000;
+
+            /// Number of distinct node ids to look ahead when prefetching.
+            static const size_t prefetch_distance = 8;
+
+            BatchedCoordinatesForWays(TCoordinatesForWays& coordinates_for_ways,
+                                      THandler& next_handler,
+                                      size_t batch_size = default_batch_size) :
+                Forward<THandler>(next_handler),
+                m_coordinates_for_ways(coordinates_for_ways),
+                m_batch_size(batch_size > 0 ? batch_size : 1),
+                m_ways(),
+                m_node_refs() {
+                m_ways.reserve(m_batch_size);
+            }
+
+            void node(const shared_ptr<Osmium::OSM::Node>& node) {
+                m_coordinates_for_ways.node(node);
+                this->next_handler().node(node);
+            }
+
+            void after_nodes() {
+                m_coordinates_for_ways.after_nodes();
+                this->next_handler().after_nodes();
+            }
+
+            void way(const shared_ptr<Osmium::OSM::Way>& way) {
+                m_ways.push_back(way);
+                if (m_ways.size() >= m_batch_size) {
+                    flush();
+                }
+            }
+
+            void after_ways() {
+                flush();
+                this->next_handler().after_ways();
+            }
+
+            void final() {
+                flush();
+                this->next_handler().final();
+            }
+
+            /**
+             * Set the locations in all buffered ways and forward them to
+             * the next handler.
+             */
+            void flush() {
+                if (m_ways.empty()) {
+                    return;
+                }
+
+                for (typename std::vector< shared_ptr<Osmium::OSM::Way> >::iterator way_it = m_ways.begin(); way_it != m_ways.end(); ++way_it) {
+                    Osmium::OSM::WayNodeList& nodes = (*way_it)->nodes();
+                    for (Osmium::OSM::WayNodeList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+                        m_node_refs.push_back(std::make_pair(it->ref(), &*it));
+                    }
+                }
+
+                std::sort(m_node_refs.begin(), m_node_refs.end(), compare_ids);
+                lookup_sorted();
+                m_node_refs.clear();
+
+                for (typename std::vector< shared_ptr<Osmium::OSM::Way> >::iterator way_it = m_ways.begin(); way_it != m_ways.end(); ++way_it) {
+                    this->next_handler().way(*way_it);
+                }
+                m_ways.clear();
+            }
+
+        private:
+
+            static bool compare_ids(const node_ref_t& a, const node_ref_t& b) {
+                return a.first < b.first;
+            }
+
+            /**
+             * Walk the sorted node references, reading each distinct
+             * location once and copying it to all way nodes referencing
+             * it. Prefetch hints are kept prefetch_distance ids ahead.
+             */
+            void lookup_sorted() {
+                const size_t size = m_node_refs.size();
+                size_t ahead = 0;
+                size_t prefetched = 0;
+
+                size_t i = 0;
+                while (i < size) {
+                    const osm_object_id_t id = m_node_refs[i].first;
+
+                    while (prefetched < prefetch_distance && ahead < size) {
+                        const osm_object_id_t ahead_id = m_node_refs[ahead].first;
+                        m_coordinates_for_ways.prefetch_node_pos(ahead_id);
+                        while (ahead < size && m_node_refs[ahead].first == ahead_id) {
+                            ++ahead;
+                        }
+                        ++prefetched;
+                    }
+
+                    const Osmium::OSM::Position position = m_coordinates_for_ways.get_node_pos(id);
+                    for (; i < size && m_node_refs[i].first == id; ++i) {
+                        m_node_refs[i].second->position(position);
+                    }
+                    --prefetched;
+                }
+            }
+
+            TCoordinatesForWays& m_coordinates_for_ways;
+
+            const size_t m_batch_size;
+
+            /// Ways waiting for their locations.
+            std::vector< shared_ptr<Osmium::OSM::Way> > m_ways;
+
+            /// Node references of all buffered ways, reused between batches.
+            std::vector<node_ref_t> m_node_refs;
+
+        }; // class BatchedCoordinatesForWays
+
+    } // namespace Handler
+
+} // namespace Osmium
+
+#endif // OSMIUM_HANDLER_BATCHED_COORDINATES_FOR_WAYS_HPP
@@ -0,0 +1,270 @@
+#ifndef OSMIUM_HANDLER_CLIP_HPP
+#define OSMIUM_HANDLER_CLIP_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <vector>
+
+#include <geos/geom/Coordinate.h>
+#include <geos/geom/Envelope.h>
+#include <geos/geom/LinearRing.h>
+#include <geos/geom/MultiPolygon.h>
+#include <geos/geom/Polygon.h>
+#include <geos/util/GEOSException.h>
+
+#include <osmium/handler.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/geometry/clip.hpp>
+#include <osmium/geometry/geos.hpp>
+#include <osmium/geometry/multipolygon.hpp>
+
+namespace Osmium {
+
+    namespace Handler {
+
+        /**
+         * Handler clipping nodes, ways, and areas to a region before
+         * forwarding them to the next handler. It can be put in front of
+         * any exporter to cut out extracts or tiles.
+         *
+         * - Nodes outside the region are dropped.
+         * - Ways completely inside are forwarded unchanged, ways
+         *   completely outside are dropped. Other ways are cut into
+         *   pieces, each forwarded as a copy of the way with the same
+         *   id. Nodes added on the border of the region have id 0.
+         * - Closed ways are clipped as rings unless this is disabled
+         *   in the constructor.
+         * - Areas created from ways are clipped as rings. Areas created
+         *   from multipolygon relations only have a GEOS geometry, it is
+         *   intersected with the region using GEOS, so holes crossing
+         *   the border are cut out of the outer ring. Areas with nothing
+         *   left are dropped. Areas without a geometry or where GEOS
+         *   fails are forwarded unclipped (see unclipped_areas()).
+         *
+         * The ways must have node locations, so this handler must come
+         * after CoordinatesForWays. Ways without locations are forwarded
+         * unchanged.
+         *
+         * @tparam THandler Handler the clipped objects are forwarded to.
+         */
+        template <class THandler>
+        class Clip : public Forward<THandler> {
+
+        public:
+
+            /**
+             * @param next_handler Handler the objects are forwarded to.
+             * @param region Region to clip to.
+             * @param closed_ways_as_rings Clip closed ways as rings (if
+             *                             false they are clipped as lines).
+             */
+            Clip(THandler& next_handler,
+                 const Osmium::Geometry::Clip::ConvexRegion& region,
+                 bool closed_ways_as_rings = true) :
+                Forward<THandler>(next_handler),
+                m_region(region),
+                m_closed_ways_as_rings(closed_ways_as_rings),
+                m_ring(),
+                m_pieces(),
+                m_region_polygon(),
+                m_unclipped_areas(0) {
+            }
+
+            void node(const shared_ptr<Osmium::OSM::Node>& node) {
+                if (m_region.contains(node->position())) {
+                    this->next_handler().node(node);
+                }
+            }
+
+            void way(const shared_ptr<Osmium::OSM::Way>& way) {
+                Osmium::OSM::WayNodeList& nodes = way->nodes();
+                if (!nodes.has_position() || m_region.contains(nodes.begin(), nodes.end())) {
+                    this->next_handler().way(way);
+                    return;
+                }
+
+                if (m_closed_ways_as_rings && nodes.size() > 3 && nodes.is_closed()) {
+                    if (m_region.clip_ring(nodes.begin(), nodes.end(), m_ring)) {
+                        nodes = m_ring;
+                        this->next_handler().way(way);
+                    }
+                    return;
+                }
+
+                m_pieces.clear();
+                if (m_region.clip_line(nodes.begin(), nodes.end(), m_pieces) == 0) {
+                    return;
+                }
+
+                // copy the way for all pieces but the first before
+                // changing its nodes
+                std::vector< shared_ptr<Osmium::OSM::Way> > ways(1, way);
+                for (size_t i = 1; i < m_pieces.size(); ++i) {
+                    ways.push_back(make_shared<Osmium::OSM::Way>(*way));
+                }
+                for (size_t i = 0; i < m_pieces.size(); ++i) {
+                    ways[i]->nodes() = m_pieces[i];
+                    this->next_handler().way(ways[i]);
+                }
+            }
+
+            void area(const shared_ptr<Osmium::OSM::Area>& area) {
+                if (!area->from_way()) {
+                    relation_area(area);
+                    return;
+                }
+
+                const Osmium::OSM::WayNodeList& nodes = area->nodes();
+                if (!nodes.has_position() || m_region.contains(nodes.begin(), nodes.end())) {
+                    this->next_handler().area(area);
+                    return;
+                }
+
+                if (m_region.clip_ring(nodes.begin(), nodes.end(), m_ring)) {
+                    Osmium::OSM::Way way;
+                    copy_attributes(*area, way);
+                    way.nodes() = m_ring;
+                    this->next_handler().area(make_shared<Osmium::OSM::Area>(way));
+                }
+            }
+
+            /// Number of areas from relations forwarded without clipping because they have no geometry or GEOS failed.
+            uint64_t unclipped_areas() const {
+                return m_unclipped_areas;
+            }
+
+        private:
+
+            /**
+             * Set id (of the original object), meta data, and tags of a
+             * way or relation an area is created from.
+             */
+            static void copy_attributes(const Osmium::OSM::Area& area, Osmium::OSM::Object& object) {
+                object.id(area.orig_id());
+                object.version(area.version());
+                object.changeset(area.changeset());
+                object.timestamp(area.timestamp());
+                object.endtime(area.endtime());
+                object.uid(area.uid());
+                object.user(area.user());
+                object.visible(area.visible());
+                object.tags(area.tags());
+            }
+
+            void relation_area(const shared_ptr<Osmium::OSM::Area>& area) {
+                const geos::geom::MultiPolygon* multipolygon;
+                try {
+                    multipolygon = Osmium::Geometry::MultiPolygon(*area).borrow_geos_geometry();
+                } catch (Osmium::Geometry::GeometryException&) {
+                    ++m_unclipped_areas;
+                    this->next_handler().area(area);
+                    return;
+                }
+
+                const geos::geom::Envelope* envelope = multipolygon->getEnvelopeInternal();
+                const Osmium::OSM::Position corners[4] = {
+                    Osmium::OSM::Position(envelope->getMinX(), envelope->getMinY()),
+                    Osmium::OSM::Position(envelope->getMaxX(), envelope->getMinY()),
+                    Osmium::OSM::Position(envelope->getMaxX(), envelope->getMaxY()),
+                    Osmium::OSM::Position(envelope->getMinX(), envelope->getMaxY())
+                };
+                const Osmium::OSM::Bounds& bounds = m_region.bounds();
+                if (corners[2].x() < bounds.bottom_left().x() || corners[0].x() > bounds.top_right().x() ||
+                    corners[2].y() < bounds.bottom_left().y() || corners[0].y() > bounds.top_right().y()) {
+                    return;
+                }
+                if (m_region.contains(corners, corners + 4)) {
+                    this->next_handler().area(area);
+                    return;
+                }
+
+                // Holes crossing the border of the region have to be
+                // subtracted from the clipped outer ring, so this can't
+                // be done ring by ring.
+                scoped_ptr<geos::geom::Geometry> intersection;
+                try {
+                    intersection.reset(multipolygon->intersection(region_polygon()));
+                } catch (const geos::util::GEOSException&) {
+                    ++m_unclipped_areas;
+                    this->next_handler().area(area);
+                    return;
+                }
+
+                // The intersection can contain points and lines where the
+                // area touches the border, only the polygons are kept.
+                std::vector<geos::geom::Geometry*>* polygons = new std::vector<geos::geom::Geometry*>();
+                for (size_t i = 0; i < intersection->getNumGeometries(); ++i) {
+                    const geos::geom::Geometry* part = intersection->getGeometryN(i);
+                    if (part->getGeometryTypeId() == geos::geom::GEOS_POLYGON && !part->isEmpty()) {
+                        polygons->push_back(part->clone());
+                    }
+                }
+
+                if (polygons->empty()) {
+                    delete polygons;
+                    return;
+                }
+
+                Osmium::OSM::Relation relation;
+                copy_attributes(*area, relation);
+                shared_ptr<Osmium::OSM::Area> clipped_area = make_shared<Osmium::OSM::Area>(relation);
+                clipped_area->geos_geometry(Osmium::Geometry::geos_geometry_factory()->createMultiPolygon(polygons));
+                this->next_handler().area(clipped_area);
+            }
+
+            /**
+             * GEOS polygon of the region, created when it is first needed.
+             */
+            const geos::geom::Polygon* region_polygon() {
+                if (!m_region_polygon) {
+                    const std::vector<Osmium::OSM::Position>& vertices = m_region.vertices();
+                    std::vector<geos::geom::Coordinate>* coordinates = new std::vector<geos::geom::Coordinate>();
+                    coordinates->reserve(vertices.size() + 1);
+                    for (std::vector<Osmium::OSM::Position>::const_iterator it = vertices.begin(); it != vertices.end(); ++it) {
+                        coordinates->push_back(Osmium::Geometry::create_geos_coordinate(*it));
+                    }
+                    coordinates->push_back(coordinates->front());
+                    geos::geom::GeometryFactory* factory = Osmium::Geometry::geos_geometry_factory();
+                    geos::geom::LinearRing* shell = factory->createLinearRing(factory->getCoordinateSequenceFactory()->create(coordinates));
+                    m_region_polygon.reset(factory->createPolygon(shell, NULL));
+                }
+                return m_region_polygon.get();
+            }
+
+            const Osmium::Geometry::Clip::ConvexRegion m_region;
+            const bool m_closed_ways_as_rings;
+
+            /// Buffers for the clipped geometries, reused between objects.
+            Osmium::OSM::WayNodeList m_ring;
+            std::vector<Osmium::OSM::WayNodeList> m_pieces;
+
+            scoped_ptr<geos::geom::Polygon> m_region_polygon;
+
+            uint64_t m_unclipped_areas;
+
+        }; // class Clip
+
+    } // namespace Handler
+
+} // namespace Osmium
+
+#endif // OSMIUM_HANDLER_CLIP_HPP
@@ -31,11 +31,14 @@ namespace Osmium {
         /**
          * Handler to retrieve locations from nodes and add them to ways.
          *
-         * @tparam TStorage Class that handles the actual storage of the node locations.
-         *                  It must support the set(id, value) method and operator[] for
-         *                  reading a value.
+         * @tparam TStoragePosIDs Class that handles the actual storage of the node locations
+         *                        with positive IDs. It must support the set(id, value)
+         *                        method and operator[] for reading a value.
+         * @tparam TStorageNegIDs Class that handles the storage of the node locations with
+         *                        negative IDs. If this is void, all node locations are kept
+         *                        in one storage which must handle signed IDs, see below.
          */
-        template <class TStoragePosIDs, class TStorageNegIDs>
+        template <class TStoragePosIDs, class TStorageNegIDs = void>
         class CoordinatesForWays : public Base {
 
         public:
@@ -58,10 +61,31 @@ namespace Osmium {
                 }
             }
 
+            /**
+             * All nodes have been stored, tell the storage that only lookups
+             * will follow.
+             */
+            void after_nodes() {
+                m_storage_pos.writes_complete();
+                m_storage_neg.writes_complete();
+            }
+
             Osmium::OSM::Position get_node_pos(const int64_t id) const {
                 return id >= 0 ? m_storage_pos[id] : m_storage_neg[-id];
             }
 
+            /**
+             * Tell the storage that the location of the node with the given
+             * id will be needed soon.
+             */
+            void prefetch_node_pos(const int64_t id) const {
+                if (id >= 0) {
+                    m_storage_pos.prefetch(id);
+                } else {
+                    m_storage_neg.prefetch(-id);
+                }
+            }
+
             /**
              * Retrieve locations of all nodes in the way from storage and add
              * them to the way object.
@@ -83,6 +107,67 @@ namespace Osmium {
 
         }; // class CoordinatesForWays
 
+        /**
+         * Handler to retrieve locations from nodes and add them to ways,
+         * using a single storage for all node IDs.
+         *
+         * @tparam TStorage Class that handles the actual storage of the node locations.
+         *                  It must accept negative IDs in set(id, value) and operator[],
+         *                  for instance Osmium::Storage::ById::SignedIds.
+         */
+        template <class TStorage>
+        class CoordinatesForWays<TStorage, void> : public Base {
+
+        public:
+
+            CoordinatesForWays(TStorage& storage) :
+                m_storage(storage) {
+            }
+
+            /**
+             * Store the location of the node in the storage.
+             */
+            void node(const shared_ptr<Osmium::OSM::Node const>& node) {
+                m_storage.set(node->id(), node->position());
+            }
+
+            /**
+             * All nodes have been stored, tell the storage that only lookups
+             * will follow.
+             */
+            void after_nodes() {
+                m_storage.writes_complete();
+            }
+
+            Osmium::OSM::Position get_node_pos(const int64_t id) const {
+                return m_storage[id];
+            }
+
+            /**
+             * Tell the storage that the location of the node with the given
+             * id will be needed soon.
+             */
+            void prefetch_node_pos(const int64_t id) const {
+                m_storage.prefetch(id);
+            }
+
+            /**
+             * Retrieve locations of all nodes in the way from storage and add
+             * them to the way object.
+             */
+            void way(const shared_ptr<Osmium::OSM::Way>& way) {
+                for (Osmium::OSM::WayNodeList::iterator it = way->nodes().begin(); it != way->nodes().end(); ++it) {
+                    it->position(m_storage[it->ref()]);
+                }
+            }
+
+        private:
+
+            /// Object that handles the actual storage of the node locations.
+            TStorage& m_storage;
+
+        }; // class CoordinatesForWays<TStorage, void>
+
     } // namespace Handler
 
 } // namespace Osmium
@@ -0,0 +1,118 @@
+#ifndef OSMIUM_HANDLER_SIMPLIFY_HPP
+#define OSMIUM_HANDLER_SIMPLIFY_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <osmium/handler.hpp>
+#include <osmium/geometry/simplify.hpp>
+
+namespace Osmium {
+
+    namespace Handler {
+
+        /**
+         * Handler simplifying the geometry of ways before forwarding them
+         * to the next handler. Nodes are removed from the way node lists
+         * in place, so all geometries built from the ways later on are
+         * simplified.
+         *
+         * The ways must have node locations, so this handler must come
+         * after CoordinatesForWays. Ways without locations are forwarded
+         * unchanged. To get simplified multipolygons the handler must
+         * come before the multipolygon assembler.
+         *
+         * If topology preservation is enabled, closed ways are simplified
+         * as rings with Simplify::simplify_ring(), so they don't
+         * degenerate or start to intersect themselves. Multipolygon rings
+         * assembled from several ways stay closed in any case, because
+         * the end nodes of all ways are kept.
+         *
+         * @tparam THandler Handler the simplified ways are forwarded to.
+         */
+        template <class THandler>
+        class Simplify : public Forward<THandler> {
+
+        public:
+
+            /**
+             * @param next_handler Handler the ways are forwarded to.
+             * @param tolerance Tolerance in coordinate units.
+             * @param algorithm Simplification algorithm.
+             * @param preserve_topology Keep closed ways valid rings.
+             */
+            Simplify(THandler& next_handler,
+                     double tolerance,
+                     Osmium::Geometry::Simplify::algorithm_t algorithm = Osmium::Geometry::Simplify::DOUGLAS_PEUCKER,
+                     bool preserve_topology = false) :
+                Forward<THandler>(next_handler),
+                m_tolerance(tolerance),
+                m_algorithm(algorithm),
+                m_preserve_topology(preserve_topology),
+                m_nodes(),
+                m_nodes_in(0),
+                m_nodes_out(0) {
+            }
+
+            void way(const shared_ptr<Osmium::OSM::Way>& way) {
+                Osmium::OSM::WayNodeList& nodes = way->nodes();
+                if (nodes.size() > 2 && nodes.has_position()) {
+                    if (m_preserve_topology && nodes.is_closed()) {
+                        Osmium::Geometry::Simplify::simplify_ring(nodes, m_algorithm, m_tolerance, m_nodes);
+                    } else {
+                        Osmium::Geometry::Simplify::simplify(nodes, m_algorithm, m_tolerance, m_nodes);
+                    }
+                    m_nodes_in += nodes.size();
+                    m_nodes_out += m_nodes.size();
+                    nodes = m_nodes;
+                }
+                this->next_handler().way(way);
+            }
+
+            /// Number of way nodes before simplification.
+            uint64_t nodes_in() const {
+                return m_nodes_in;
+            }
+
+            /// Number of way nodes after simplification.
+            uint64_t nodes_out() const {
+                return m_nodes_out;
+            }
+
+        private:
+
+            const double m_tolerance;
+            const Osmium::Geometry::Simplify::algorithm_t m_algorithm;
+            const bool m_preserve_topology;
+
+            /// Buffer for the simplified nodes, reused between ways.
+            Osmium::OSM::WayNodeList m_nodes;
+
+            uint64_t m_nodes_in;
+            uint64_t m_nodes_out;
+
+        }; // class Simplify
+
+    } // namespace Handler
+
+} // namespace Osmium
+
+#endif // OSMIUM_HANDLER_SIMPLIFY_HPP
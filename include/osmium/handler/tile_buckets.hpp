@@ -0,0 +1,170 @@
+#ifndef OSMIUM_HANDLER_TILE_BUCKETS_HPP
+#define OSMIUM_HANDLER_TILE_BUCKETS_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <algorithm>
+#include <vector>
+
+#include <geos/geom/CoordinateSequence.h>
+#include <geos/geom/MultiPolygon.h>
+#include <geos/geom/Polygon.h>
+
+#include <osmium/handler.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/position.hpp>
+#include <osmium/geometry/multipolygon.hpp>
+#include <osmium/geometry/tile.hpp>
+#include <osmium/export/tile_buckets.hpp>
+
+namespace Osmium {
+
+    namespace Handler {
+
+        /**
+         * Handler writing each node, way, and area into the tile bucket
+         * files of all tiles it intersects at a given zoom level. All
+         * objects are forwarded unchanged to the next handler.
+         *
+         * - Nodes go into the tile they are in.
+         * - Ways go into all tiles a segment of the way passes through.
+         * - Areas go into all tiles their (outer) rings touch or that
+         *   have their center inside an outer ring.
+         *
+         * Relations have no location and are not written. Ways without
+         * node locations and areas without a geometry are not written
+         * either, they are counted in skipped(). The ways must have node
+         * locations, so this handler must come after CoordinatesForWays.
+         *
+         * @tparam THandler Handler the objects are forwarded to.
+         */
+        template <class THandler>
+        class TileBuckets : public Forward<THandler> {
+
+        public:
+
+            /**
+             * @param next_handler Handler the objects are forwarded to.
+             * @param files Tile bucket files the objects are written to.
+             * @param zoom Zoom level of the tiles.
+             */
+            TileBuckets(THandler& next_handler,
+                        Osmium::Export::TileBucketFiles& files,
+                        uint32_t zoom) :
+                Forward<THandler>(next_handler),
+                m_files(files),
+                m_cover(zoom),
+                m_tiles(),
+                m_ring_tiles(),
+                m_positions(),
+                m_skipped(0) {
+            }
+
+            void node(const shared_ptr<Osmium::OSM::Node>& node) {
+                if (node->position().defined()) {
+                    m_tiles.assign(1, m_cover.tile(node->position()));
+                    m_files.write(m_tiles, *node);
+                } else {
+                    ++m_skipped;
+                }
+                this->next_handler().node(node);
+            }
+
+            void way(const shared_ptr<Osmium::OSM::Way>& way) {
+                const Osmium::OSM::WayNodeList& nodes = way->nodes();
+                if (nodes.has_position()) {
+                    m_cover.line(nodes.begin(), nodes.end(), m_tiles);
+                    m_files.write(m_tiles, *way);
+                } else {
+                    ++m_skipped;
+                }
+                this->next_handler().way(way);
+            }
+
+            void area(const shared_ptr<Osmium::OSM::Area>& area) {
+                if (area->from_way()) {
+                    const Osmium::OSM::WayNodeList& nodes = area->nodes();
+                    if (nodes.has_position()) {
+                        m_cover.ring(nodes.begin(), nodes.end(), m_tiles);
+                        m_files.write(m_tiles, *area);
+                    } else {
+                        ++m_skipped;
+                    }
+                } else {
+                    try {
+                        relation_area_tiles(*Osmium::Geometry::MultiPolygon(*area).borrow_geos_geometry());
+                        m_files.write(m_tiles, *area);
+                    } catch (Osmium::Geometry::GeometryException&) {
+                        ++m_skipped;
+                    }
+                }
+                this->next_handler().area(area);
+            }
+
+            /// Number of objects not written because they have no location.
+            uint64_t skipped() const {
+                return m_skipped;
+            }
+
+        private:
+
+            /**
+             * Put the tiles of all outer rings of the multipolygon into
+             * m_tiles.
+             */
+            void relation_area_tiles(const geos::geom::MultiPolygon& multipolygon) {
+                m_tiles.clear();
+                for (size_t i = 0; i < multipolygon.getNumGeometries(); ++i) {
+                    const geos::geom::Polygon* polygon = dynamic_cast<const geos::geom::Polygon*>(multipolygon.getGeometryN(i));
+                    const geos::geom::CoordinateSequence* cs = polygon->getExteriorRing()->getCoordinatesRO();
+                    m_positions.clear();
+                    for (size_t j = 0; j < cs->getSize(); ++j) {
+                        m_positions.push_back(Osmium::OSM::Position(cs->getAt(j).x, cs->getAt(j).y));
+                    }
+                    m_cover.ring(m_positions.begin(), m_positions.end(), m_ring_tiles);
+                    m_tiles.insert(m_tiles.end(), m_ring_tiles.begin(), m_ring_tiles.end());
+                }
+                std::sort(m_tiles.begin(), m_tiles.end());
+                m_tiles.erase(std::unique(m_tiles.begin(), m_tiles.end()), m_tiles.end());
+            }
+
+            Osmium::Export::TileBucketFiles& m_files;
+
+            Osmium::Geometry::TileCover m_cover;
+
+            /// Tiles of the current object, reused between objects.
+            std::vector<Osmium::Geometry::Tile> m_tiles;
+
+            /// Buffers for the outer rings of relation areas.
+            std::vector<Osmium::Geometry::Tile> m_ring_tiles;
+            std::vector<Osmium::OSM::Position> m_positions;
+
+            uint64_t m_skipped;
+
+        }; // class TileBuckets
+
+    } // namespace Handler
+
+} // namespace Osmium
+
+#endif // OSMIUM_HANDLER_TILE_BUCKETS_HPP
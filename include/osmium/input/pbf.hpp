@@ -28,6 +28,9 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
+#include <sys/types.h>
+#include <unistd.h>
 #include <zlib.h>
 
 #include <osmpbf/osmpbf.h>
@@ -88,58 +91,28 @@ namespace Osmium {
             void parse() {
                 try {
                     while (read_blob_header()) {
-                        const array_t a = read_blob(m_pbf_blob_header.datasize());
-
-                        if (m_pbf_blob_header.type() == "OSMData") {
-                            if (!m_pbf_primitive_block.ParseFromArray(a.first, a.second)) {
-                                throw std::runtime_error("Failed to parse PrimitiveBlock.");
-                            }
-                            const OSMPBF::StringTable& stringtable = m_pbf_primitive_block.stringtable();
-                            m_date_factor = m_pbf_primitive_block.date_granularity() / 1000;
-                            for (int i=0; i < m_pbf_primitive_block.primitivegroup_size(); ++i) {
-                                parse_group(m_pbf_primitive_block.primitivegroup(i), stringtable);
-                            }
-                        } else if (m_pbf_blob_header.type() == "OSMHeader") {
-                            OSMPBF::HeaderBlock pbf_header_block;
-                            if (!pbf_header_block.ParseFromArray(a.first, a.second)) {
-                                throw std::runtime_error("Failed to parse HeaderBlock.");
-                            }
-
-                            bool has_historical_information_feature = false;
-                            for (int i=0; i < pbf_header_block.required_features_size(); ++i) {
-                                const std::string& feature = pbf_header_block.required_features(i);
-
-                                if (feature == "OsmSchema-V0.6") continue;
-                                if (feature == "DenseNodes") continue;
-                                if (feature == "HistoricalInformation") {
-                                    has_historical_information_feature = true;
-                                    continue;
-                                }
-
-                                std::ostringstream errmsg;
-                                errmsg << "Required feature not supported: " << feature;
-                                throw std::runtime_error(errmsg.str());
-                            }
-
-                            const Osmium::OSMFile::FileType* expected_file_type = this->file().type();
-                            if (expected_file_type == Osmium::OSMFile::FileType::OSM() && has_historical_information_feature) {
-                                throw Osmium::OSMFile::FileTypeOSMExpected();
-                            }
-                            if (expected_file_type == Osmium::OSMFile::FileType::History() && !has_historical_information_feature) {
-                                throw Osmium::OSMFile::FileTypeHistoryExpected();
-                            }
-
-                            if (pbf_header_block.has_writingprogram()) {
-                                this->meta().generator(pbf_header_block.writingprogram());
-                            }
-                            if (pbf_header_block.has_bbox()) {
-                                const OSMPBF::HeaderBBox& bbox = pbf_header_block.bbox();
-                                const int64_t resolution_convert = OSMPBF::lonlat_resolution / Osmium::OSM::coordinate_precision;
-                                this->meta().bounds().extend(Osmium::OSM::Position(bbox.left()  / resolution_convert, bbox.bottom() / resolution_convert));
-                                this->meta().bounds().extend(Osmium::OSM::Position(bbox.right() / resolution_convert, bbox.top()    / resolution_convert));
-                            }
-                        } else {
-//                            std::cerr << "Ignoring unknown blob type (" << m_pbf_blob_header.type().data() << ").\n";
+                        parse_blob();
+                    }
+                    this->call_after_and_before_on_handler(UNKNOWN);
+                } catch (Osmium::Handler::StopReading) {
+                    // if a handler says to stop reading, we do
+                }
+                this->call_final_on_handler();
+            }
+
+            /**
+            * Parse only some blobs of the PBF file.
+            *
+            * @param index Blob index as created by build_index().
+            * @param begin Index of the first blob to parse.
+            * @param end Index one past the last blob to parse.
+            */
+            void parse(const std::vector<off_t>& index, size_t begin, size_t end) {
+                try {
+                    if (begin < end) {
+                        seek(index[begin]);
+                        for (size_t i = begin; i < end && read_blob_header(); ++i) {
+                            parse_blob();
                         }
                     }
                     this->call_after_and_before_on_handler(UNKNOWN);
@@ -149,8 +122,168 @@ namespace Osmium {
                 this->call_final_on_handler();
             }
 
+            /**
+            * Create an index of all blobs in the file with the file offset
+            * of each blob. The blob contents are skipped, not read.
+            *
+            * @param index Vector the offsets are appended to.
+            * @returns false if the input is not seekable (for instance
+            *          if it is read from stdin), true otherwise.
+            */
+            bool build_index(std::vector<off_t>& index) {
+                while (true) {
+                    const off_t offset = ::lseek(this->fd(), 0, SEEK_CUR);
+                    if (offset == static_cast<off_t>(-1)) {
+                        return false;
+                    }
+                    if (!read_blob_header()) {
+                        return true;
+                    }
+                    index.push_back(offset);
+                    if (::lseek(this->fd(), m_pbf_blob_header.datasize(), SEEK_CUR) == static_cast<off_t>(-1)) {
+                        return false;
+                    }
+                }
+            }
+
+            /**
+            * Find the first blob containing relations with a binary
+            * search. This only works for files sorted in the usual
+            * way (nodes, then ways, then relations).
+            *
+            * @param index Blob index as created by build_index().
+            * @param mixed Set to true if the first blob with relations
+            *              also contains other objects.
+            * @returns Index of the blob, index.size() if there are no relations.
+            */
+            size_t find_first_relation_blob(const std::vector<off_t>& index, bool& mixed) {
+                size_t low = 0;
+                size_t high = index.size();
+                while (low < high) {
+                    const size_t middle = low + (high - low) / 2;
+                    osm_object_type_t first;
+                    osm_object_type_t last;
+                    blob_types(index[middle], first, last);
+                    if (last == RELATION) {
+                        high = middle;
+                    } else {
+                        low = middle + 1;
+                    }
+                }
+                mixed = false;
+                if (low < index.size()) {
+                    osm_object_type_t first;
+                    osm_object_type_t last;
+                    blob_types(index[low], first, last);
+                    mixed = (first != RELATION);
+                }
+                return low;
+            }
+
         private:
 
+            /**
+            * Find out which kind of objects are in the first and the last
+            * group of the blob at the given offset. Blobs not containing
+            * OSM data get UNKNOWN for both.
+            */
+            void blob_types(off_t offset, osm_object_type_t& first, osm_object_type_t& last) {
+                first = UNKNOWN;
+                last = UNKNOWN;
+                seek(offset);
+                if (!read_blob_header()) {
+                    return;
+                }
+                const array_t a = read_blob(m_pbf_blob_header.datasize());
+                if (m_pbf_blob_header.type() != "OSMData") {
+                    return;
+                }
+                if (!m_pbf_primitive_block.ParseFromArray(a.first, a.second)) {
+                    throw std::runtime_error("Failed to parse PrimitiveBlock.");
+                }
+                const int groups = m_pbf_primitive_block.primitivegroup_size();
+                if (groups > 0) {
+                    first = group_type(m_pbf_primitive_block.primitivegroup(0));
+                    last = group_type(m_pbf_primitive_block.primitivegroup(groups - 1));
+                }
+            }
+
+            static osm_object_type_t group_type(const OSMPBF::PrimitiveGroup& group) {
+                if (group.has_dense() || group.nodes_size() != 0) {
+                    return NODE;
+                } else if (group.ways_size() != 0) {
+                    return WAY;
+                } else if (group.relations_size() != 0) {
+                    return RELATION;
+                }
+                return UNKNOWN;
+            }
+
+            void seek(off_t offset) {
+                if (::lseek(this->fd(), offset, SEEK_SET) != offset) {
+                    throw std::runtime_error("seek error");
+                }
+            }
+
+            /**
+            * Read and parse the blob following the blob header that was just read.
+            */
+            void parse_blob() {
+                const array_t a = read_blob(m_pbf_blob_header.datasize());
+
+                if (m_pbf_blob_header.type() == "OSMData") {
+                    if (!m_pbf_primitive_block.ParseFromArray(a.first, a.second)) {
+                        throw std::runtime_error("Failed to parse PrimitiveBlock.");
+                    }
+                    const OSMPBF::StringTable& stringtable = m_pbf_primitive_block.stringtable();
+                    m_date_factor = m_pbf_primitive_block.date_granularity() / 1000;
+                    for (int i=0; i < m_pbf_primitive_block.primitivegroup_size(); ++i) {
+                        parse_group(m_pbf_primitive_block.primitivegroup(i), stringtable);
+                    }
+                } else if (m_pbf_blob_header.type() == "OSMHeader") {
+                    OSMPBF::HeaderBlock pbf_header_block;
+                    if (!pbf_header_block.ParseFromArray(a.first, a.second)) {
+                        throw std::runtime_error("Failed to parse HeaderBlock.");
+                    }
+
+                    bool has_historical_information_feature = false;
+                    for (int i=0; i < pbf_header_block.required_features_size(); ++i) {
+                        const std::string& feature = pbf_header_block.required_features(i);
+
+                        if (feature == "OsmSchema-V0.6") continue;
+                        if (feature == "DenseNodes") continue;
+                        if (feature == "HistoricalInformation") {
+                            has_historical_information_feature = true;
+                            continue;
+                        }
+
+                        std::ostringstream errmsg;
+                        errmsg << "Required feature not supported: " << feature;
+                        throw std::runtime_error(errmsg.str());
+                    }
+
+                    const Osmium::OSMFile::FileType* expected_file_type = this->file().type();
+                    if (expected_file_type == Osmium::OSMFile::FileType::OSM() && has_historical_information_feature) {
+                        throw Osmium::OSMFile::FileTypeOSMExpected();
+                    }
+                    if (expected_file_type == Osmium::OSMFile::FileType::History() && !has_historical_information_feature) {
+                        throw Osmium::OSMFile::FileTypeHistoryExpected();
+                    }
+
+                    if (pbf_header_block.has_writingprogram()) {
+                        this->meta().generator(pbf_header_block.writingprogram());
+                    }
+                    if (pbf_header_block.has_bbox()) {
+                        const OSMPBF::HeaderBBox& bbox = pbf_header_block.bbox();
+                        const int64_t resolution_convert = OSMPBF::lonlat_resolution / Osmium::OSM::coordinate_precision;
+                        this->meta().bounds().extend(Osmium::OSM::Position(bbox.left()  / resolution_convert, bbox.bottom() / resolution_convert));
+                        this->meta().bounds().extend(Osmium::OSM::Position(bbox.right() / resolution_convert, bbox.top()    / resolution_convert));
+                    }
+                } else {
+//                    std::cerr << "Ignoring unknown blob type (" << m_pbf_blob_header.type().data() << ").\n";
+                }
+            }
+
             /**
             * Parse one PrimitiveGroup inside a PrimitiveBlock. This function will check what
             * type of data the group contains (nodes, dense nodes, ways, or relations) and
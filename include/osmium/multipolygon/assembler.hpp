@@ -22,12 +22,18 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 
 */
 
+#include <iostream>
+#include <string>
+#include <sys/time.h>
+#include <boost/exception_ptr.hpp>
+
 #include <osmium/smart_ptr.hpp>
 #include <osmium/debug.hpp>
 #include <osmium/osm/area.hpp>
 #include <osmium/relations/relation_info.hpp>
 #include <osmium/relations/assembler.hpp>
 #include <osmium/multipolygon/builder.hpp>
+#include <osmium/utils/worker_pool.hpp>
 
 namespace Osmium {
 
@@ -40,6 +46,13 @@ namespace Osmium {
          * This class assembles MultiPolygons from relations tagged with
          * type=multipolygon or type=boundary.
          *
+         * The areas can be built in worker threads, so that building large
+         * multipolygons does not stall reading the input. The areas are
+         * still handed to the nested handler from the thread reading the
+         * input, either in the order the relations (and closed ways) were
+         * completed or in the order they were built. All areas are
+         * delivered before the nested handler gets the after_ways() call.
+         *
          * @tparam THandler Chained handler class.
          * @tparam TBuilder MultiPolygon Builder class.
          */
@@ -48,13 +61,180 @@ namespace Osmium {
 
             typedef typename Osmium::Relations::Assembler<Osmium::MultiPolygon::Assembler<THandler>, Osmium::Relations::RelationInfo, false, true, false, THandler> AssemblerType;
 
+            /**
+             * Job for the worker pool. Builds the area(s) from a complete
+             * relation. Areas from closed ways are created when the way
+             * is read and only passed through the pool, so that all areas
+             * are handed on in input order.
+             */
+            class BuildJob {
+
+                const Osmium::Relations::RelationInfo m_relation_info;
+                const bool m_attempt_repair;
+                const bool m_timing;
+                std::vector< shared_ptr<Osmium::OSM::Area> > m_areas;
+                long m_build_time;
+                std::string m_messages;
+                boost::exception_ptr m_error;
+
+            public:
+
+                BuildJob(const Osmium::Relations::RelationInfo& relation_info, bool attempt_repair, bool timing=false) :
+                    m_relation_info(relation_info),
+                    m_attempt_repair(attempt_repair),
+                    m_timing(timing),
+                    m_areas(),
+                    m_build_time(0),
+                    m_messages(),
+                    m_error() {
+                }
+
+                BuildJob(const shared_ptr<Osmium::OSM::Area>& area) :
+                    m_relation_info(),
+                    m_attempt_repair(false),
+                    m_timing(false),
+                    m_areas(1, area),
+                    m_build_time(0),
+                    m_messages(),
+                    m_error() {
+                }
+
+                /**
+                 * Build the areas. Errors are kept in the job, they are
+                 * reported from the thread reading the input.
+                 */
+                void run() {
+                    if (!relation()) {
+                        return;
+                    }
+                    try {
+                        timeval start;
+                        if (m_timing) {
+                            gettimeofday(&start, 0);
+                        }
+
+                        TBuilder builder(m_relation_info, m_attempt_repair);
+                        m_areas = builder.build();
+                        m_messages = builder.messages();
+
+                        if (m_timing) {
+                            timeval end;
+                            gettimeofday(&end, 0);
+                            m_build_time = (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec);
+                        }
+                    } catch (...) {
+                        m_error = boost::current_exception();
+                    }
+                }
+
+                /// The relation the areas are built from (empty if they are built from a way).
+                const shared_ptr<Osmium::OSM::Relation const>& relation() const {
+                    return m_relation_info.relation();
+                }
+
+                /// Time needed to build the areas in microseconds (only measured if timing was requested).
+                long build_time() const {
+                    return m_build_time;
+                }
+
+                const std::vector< shared_ptr<Osmium::OSM::Area> >& areas() const {
+                    return m_areas;
+                }
+
+                /// Diagnostic messages from the builder.
+                const std::string& messages() const {
+                    return m_messages;
+                }
+
+                /// Rethrow the exception that stopped run() (if any).
+                void rethrow_error() const {
+                    if (m_error) {
+                        boost::rethrow_exception(m_error);
+                    }
+                }
+
+            }; // class BuildJob
+
             bool m_attempt_repair;
 
+            Osmium::WorkerPool<BuildJob> m_workers;
+
+            /**
+             * Send areas from finished jobs to the nested handler. The
+             * diagnostic messages of the builder are written to std::cerr
+             * here and errors from building the areas are rethrown.
+             *
+             * @param wait Wait for all jobs to finish.
+             */
+            void deliver_areas(bool wait) {
+                while (shared_ptr<BuildJob> job = m_workers.next_finished(wait)) {
+                    std::cerr << job->messages();
+                    job->rethrow_error();
+                    if (debug && has_debug_level(2) && job->relation()) {
+                        std::cout << "MultiPolygon from relation " << job->relation()->id() << ": " << job->areas().size() << " area(s) built in " << job->build_time() << " us\n";
+                    }
+                    BOOST_FOREACH(const shared_ptr<Osmium::OSM::Area>& area, job->areas()) {
+                        AssemblerType::nested_handler().area(area);
+                    }
+                }
+            }
+
+            /**
+             * Make a copy of a way with a node list only as large as needed
+             * (the original reserves room for many more nodes).
+             *
+             * @param way The way to copy.
+             * @param with_tags Copy the tags, too.
+             */
+            static shared_ptr<Osmium::OSM::Way const> compact_copy(const Osmium::OSM::Way& way, bool with_tags) {
+                shared_ptr<Osmium::OSM::Way> compact_way = make_shared<Osmium::OSM::Way>(way.nodes().size());
+
+                compact_way->id(way.id());
+                compact_way->version(way.version());
+                compact_way->changeset(way.changeset());
+                compact_way->timestamp(way.timestamp());
+                compact_way->endtime(way.endtime());
+                compact_way->uid(way.uid());
+                compact_way->user(way.user());
+                compact_way->visible(way.visible());
+                if (with_tags) {
+                    compact_way->tags(way.tags());
+                }
+
+                Osmium::OSM::WayNodeList& nodes = compact_way->nodes();
+                nodes.insert(nodes.end(), way.nodes().begin(), way.nodes().end());
+
+                return compact_way;
+            }
+
+            /**
+             * Create the area for a closed way. If the node list of the
+             * way isn't much larger than needed the area keeps the way
+             * itself, nothing is copied. Otherwise (the parser reserves
+             * room for many more nodes) the area gets its own exact-size
+             * copy of the nodes. Either way the tags are copied only once.
+             */
+            static shared_ptr<Osmium::OSM::Area> area_from_way(const shared_ptr<Osmium::OSM::Way const>& way) {
+                if (way->nodes().capacity() <= 2 * way->nodes().size()) {
+                    return make_shared<Osmium::OSM::Area>(way);
+                }
+                return make_shared<Osmium::OSM::Area>(*way);
+            }
+
         public:
 
-            Assembler(THandler& handler, bool attempt_repair) :
+            /**
+             * Create Assembler.
+             *
+             * @param handler Nested handler getting the areas.
+             * @param attempt_repair Try to repair broken multipolygons.
+             * @param num_threads Number of threads building areas. With 0 all areas are built immediately in the reading thread.
+             * @param ordered Deliver areas in the order the relations and ways were completed.
+             */
+            Assembler(THandler& handler, bool attempt_repair, unsigned int num_threads=0, bool ordered=true) :
                 AssemblerType(handler),
-                m_attempt_repair(attempt_repair) {
+                m_attempt_repair(attempt_repair),
+                m_workers(num_threads, ordered) {
             }
 
             void relation(const shared_ptr<Osmium::OSM::Relation const>& relation) {
@@ -85,12 +265,24 @@ namespace Osmium {
                 return false;
             }
 
+            /**
+             * Keep a compact copy of member ways. Tags are dropped if the
+             * Builder would ignore all of them anyway.
+             *
+             * Overwritten from the Assembler class.
+             */
+            shared_ptr<Osmium::OSM::Object const> compact_member(const shared_ptr<Osmium::OSM::Object const>& object) {
+                const shared_ptr<Osmium::OSM::Way const> way = static_pointer_cast<Osmium::OSM::Way const>(object);
+                return compact_copy(*way, !Builder::untagged(way.get()));
+            }
+
             void way_not_in_any_relation(const shared_ptr<Osmium::OSM::Way const>& way) {
                 if (way->is_closed() && way->nodes().size() >= 4) { // way is closed and has enough nodes, build simple multipolygon
                     if (debug && has_debug_level(2)) {
                         std::cout << "MultiPolygon from way " << way->id() << "\n";
                     }
-                    AssemblerType::nested_handler().area(make_shared<Osmium::OSM::Area>(*way));
+                    m_workers.submit(make_shared<BuildJob>(area_from_way(way)));
+                    deliver_areas(false);
                 }
             }
 
@@ -99,14 +291,13 @@ namespace Osmium {
                     std::cout << "MultiPolygon from relation " << relation_info.relation()->id() << "\n";
                 }
 
-                TBuilder builder(relation_info, m_attempt_repair);
-
-                BOOST_FOREACH(shared_ptr<Osmium::OSM::Area>& area, builder.build()) {
-                    AssemblerType::nested_handler().area(area);
-                }
+                m_workers.submit(make_shared<BuildJob>(relation_info, m_attempt_repair, debug && has_debug_level(2)));
+                deliver_areas(false);
             }
 
             void all_members_available() {
+                deliver_areas(true);
+
                 if (debug && has_debug_level(1)) {
                     AssemblerType::clean_assembled_relations();
                     if (! AssemblerType::relations().empty()) {
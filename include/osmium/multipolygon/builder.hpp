@@ -22,14 +22,17 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 
 */
 
+#include <algorithm>
 #include <cassert>
 #include <map>
+#include <sstream>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include <boost/foreach.hpp>
-#include <boost/dynamic_bitset.hpp>
 
+#include <geos/geom/Envelope.h>
 #include <geos/geom/Geometry.h>
 #include <geos/geom/Point.h>
 #include <geos/geom/LineString.h>
@@ -50,6 +53,7 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 #include <osmium/geometry.hpp>
 #include <osmium/geometry/geos.hpp>
 #include <osmium/geometry/haversine.hpp>
+#include <osmium/geometry/ring.hpp>
 #include <osmium/relations/relation_info.hpp>
 
 namespace Osmium {
@@ -176,6 +180,43 @@ namespace Osmium {
 
         }; // class RingInfo
 
+        /**
+         * Bounding box of a ring together with the index of the ring in
+         * the ring list. Used by the Builder to find the rings which
+         * could contain a given ring.
+         */
+        struct RingBox {
+
+            double minx;
+            double maxx;
+            double miny;
+            double maxy;
+            unsigned int ring;
+
+            RingBox(const geos::geom::Envelope& envelope, unsigned int r) :
+                minx(envelope.getMinX()),
+                maxx(envelope.getMaxX()),
+                miny(envelope.getMinY()),
+                maxy(envelope.getMaxY()),
+                ring(r) {
+            }
+
+            /// Is this box inside the given envelope (boundary included)?
+            bool inside(const geos::geom::Envelope& envelope) const {
+                return minx >= envelope.getMinX() && maxx <= envelope.getMaxX() &&
+                       miny >= envelope.getMinY() && maxy <= envelope.getMaxY();
+            }
+
+            bool operator<(const RingBox& other) const {
+                return minx < other.minx;
+            }
+
+            static bool west_of(const RingBox& box, double x) {
+                return box.minx < x;
+            }
+
+        }; // struct RingBox
+
         /**
          *
          */
@@ -195,11 +236,26 @@ namespace Osmium {
 
             std::vector< shared_ptr<RingInfo> > m_ringlist;
 
+            /**
+             * Index from node ids to the ways starting or ending at that
+             * node. Sorted by node id and position of the way in the vector
+             * of WayInfos.
+             */
+            typedef std::vector< std::pair<osm_object_id_t, unsigned int> > endpoint_index_t;
+            typedef std::pair<endpoint_index_t::const_iterator, endpoint_index_t::const_iterator> endpoint_range_t;
+
+            endpoint_index_t m_endpoints;
+
+            /// Diagnostic messages, see messages().
+            mutable std::ostringstream m_messages;
+
+        public:
+
             /**
              * Return true if the given tag key is in a fixed list of keys we are
              * not interested in.
              */
-            bool ignore_tag(const std::string& key) const {
+            static bool ignore_tag(const std::string& key) {
                 if (key == "type") return true;
                 if (key == "created_by") return true;
                 if (key == "source") return true;
@@ -207,6 +263,26 @@ namespace Osmium {
                 return false;
             }
 
+            /**
+             * Check if the object is without tags ignoring tags with certain
+             * keys defined in the ignore_tag() method.
+             *
+             * @returns true if this object has no tags, false otherwise
+             */
+            static bool untagged(const Osmium::OSM::Object* object) {
+                if (object == NULL) return true;
+
+                BOOST_FOREACH(const Osmium::OSM::Tag& tag, object->tags()) {
+                    if (!ignore_tag(tag.key())) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+        private:
+
             /**
              * Compare tags on two OSM objects ignoring tags with certain keys
              * defined in the ignore_tag() method.
@@ -236,24 +312,6 @@ namespace Osmium {
                 return true;
             }
 
-            /**
-             * Check if the object is without tags ignoring tags with certain
-             * keys defined in the ignore_tag() method.
-             *
-             * @returns true if this object has no tags, false otherwise
-             */
-            bool untagged(const Osmium::OSM::Object* object) const {
-                if (object == NULL) return true;
-
-                BOOST_FOREACH(const Osmium::OSM::Tag& tag, object->tags()) {
-                    if (!ignore_tag(tag.key())) {
-                        return false;
-                    }
-                }
-
-                return true;
-            }
-
             /**
              * Merge tags from way into the new area.
              *
@@ -295,7 +353,9 @@ namespace Osmium {
                 m_areas(),
                 m_attempt_repair(attempt_repair),
                 m_new_area(make_shared<Osmium::OSM::Area>(*relation_info.relation())),
-                m_ringlist() {
+                m_ringlist(),
+                m_endpoints(),
+                m_messages() {
             }
 
             /**
@@ -318,11 +378,20 @@ namespace Osmium {
                     build_multipolygon();
                     m_areas.push_back(m_new_area);
                 } catch (BuildError& error) {
-                    std::cerr << "Building multipolygon based on relation " << m_relation_info.relation()->id() << " failed: " << error.what() << "\n";
+                    m_messages << "Building multipolygon based on relation " << m_relation_info.relation()->id() << " failed: " << error.what() << "\n";
                 }
                 return m_areas;
             }
 
+            /**
+             * Diagnostic messages from build(), one per line. The Builder
+             * may run in a worker thread, so it doesn't write them to
+             * std::cerr itself.
+             */
+            std::string messages() const {
+                return m_messages.str();
+            }
+
         private:
 
             /**
@@ -422,26 +491,45 @@ namespace Osmium {
             }
 
             /**
-             * Create CoordinateSequence from Ways in a vector of WayInfos.
-             *
-             * Caller takes ownership.
+             * Add a position to a ring unless it is the same as the last one.
              */
-            geos::geom::CoordinateSequence* create_ring_coordinate_sequence(std::vector< shared_ptr<WayInfo> >& ways) const {
-                geos::geom::CoordinateSequence* coordinates = Osmium::Geometry::geos_geometry_factory()->getCoordinateSequenceFactory()->create(static_cast<size_t>(0), 2);
+            static void add_ring_position(std::vector<Osmium::OSM::Position>& positions, const Osmium::OSM::Position& position) {
+                if (positions.empty() || !(positions.back() == position)) {
+                    positions.push_back(position);
+                }
+            }
 
+            /**
+             * Collect positions of all nodes in the ways (in the given
+             * order and direction) forming a ring. Where one way ends and
+             * the next one starts the position is only added once.
+             */
+            static void ring_positions(const std::vector< shared_ptr<WayInfo> >& ways, std::vector<Osmium::OSM::Position>& positions) {
                 BOOST_FOREACH(const shared_ptr<WayInfo>& way_info, ways) {
                     if (way_info->invert) {
                         BOOST_REVERSE_FOREACH(const Osmium::OSM::WayNode& wn, way_info->way->nodes()) {
-                            coordinates->add(Osmium::Geometry::create_geos_coordinate(wn.position()), false);
+                            add_ring_position(positions, wn.position());
                         }
                     } else {
                         BOOST_FOREACH(const Osmium::OSM::WayNode& wn, way_info->way->nodes()) {
-                            coordinates->add(Osmium::Geometry::create_geos_coordinate(wn.position()), false);
+                            add_ring_position(positions, wn.position());
                         }
                     }
                 }
+            }
 
-                return coordinates;
+            /**
+             * Create CoordinateSequence from positions.
+             *
+             * Caller takes ownership.
+             */
+            static geos::geom::CoordinateSequence* create_ring_coordinate_sequence(const std::vector<Osmium::OSM::Position>& positions) {
+                std::vector<geos::geom::Coordinate>* coordinates = new std::vector<geos::geom::Coordinate>();
+                coordinates->reserve(positions.size());
+                BOOST_FOREACH(const Osmium::OSM::Position& position, positions) {
+                    coordinates->push_back(Osmium::Geometry::create_geos_coordinate(position));
+                }
+                return Osmium::Geometry::geos_geometry_factory()->getCoordinateSequenceFactory()->create(coordinates);
             }
 
             /**
@@ -455,25 +543,35 @@ namespace Osmium {
                     }
                 }
 
+                std::vector<Osmium::OSM::Position> positions;
+                ring_positions(sorted_ways, positions);
+
+                // a ring needs at least three different points
+                if (positions.size() < 4) {
+                    return shared_ptr<RingInfo>();
+                }
+
+                direction_t direction = Osmium::Geometry::Ring::is_ccw(positions.begin(), positions.end()) ? COUNTERCLOCKWISE : CLOCKWISE;
+
                 try {
-                    geos::geom::LinearRing* linear_ring = Osmium::Geometry::geos_geometry_factory()->createLinearRing(create_ring_coordinate_sequence(sorted_ways));
+                    geos::geom::LinearRing* linear_ring = Osmium::Geometry::geos_geometry_factory()->createLinearRing(create_ring_coordinate_sequence(positions));
 
-                    if (!linear_ring->isSimple() || !linear_ring->isValid()) {
+                    if (!Osmium::Geometry::Ring::is_simple(positions.begin(), positions.end()) && (!linear_ring->isSimple() || !linear_ring->isValid())) {
                         delete linear_ring;
                         linear_ring = NULL;
                         if (m_attempt_repair) {
-                            scoped_ptr<geos::geom::CoordinateSequence> cs(create_ring_coordinate_sequence(sorted_ways));
+                            scoped_ptr<geos::geom::CoordinateSequence> cs(create_ring_coordinate_sequence(positions));
                             linear_ring = create_non_intersecting_linear_ring(cs.get());
                             if (linear_ring) {
-                                std::cerr << "Successfully repaired an invalid ring" << std::endl;
+                                m_messages << "Successfully repaired an invalid ring\n";
+                                direction = geos::algorithm::CGAlgorithms::isCCW(linear_ring->getCoordinatesRO()) ? COUNTERCLOCKWISE : CLOCKWISE;
                             }
                         }
                         if (!linear_ring) return shared_ptr<RingInfo>();
                     }
-                    bool ccw = geos::algorithm::CGAlgorithms::isCCW(linear_ring->getCoordinatesRO());
-                    return make_shared<RingInfo>(Osmium::Geometry::geos_geometry_factory()->createPolygon(linear_ring, NULL), ccw ? COUNTERCLOCKWISE : CLOCKWISE);
+                    return make_shared<RingInfo>(Osmium::Geometry::geos_geometry_factory()->createPolygon(linear_ring, NULL), direction);
                 } catch (const geos::util::GEOSException& exc) {
-                    std::cerr << "Exception: " << exc.what() << std::endl;
+                    m_messages << "Exception: " << exc.what() << "\n";
                     return shared_ptr<RingInfo>();
                 }
             }
@@ -488,8 +586,12 @@ namespace Osmium {
                     return ring_is_complete(ways, ringcount, sequence);
                 }
 
-                // try extending our current line at the rear end
-                for (unsigned int i=0; i<ways.size(); ++i) {
+                // try extending our current line at the rear end with
+                // all ways starting or ending at the last node
+                const endpoint_range_t range = std::equal_range(m_endpoints.begin(), m_endpoints.end(), std::make_pair(last, 0u), compare_endpoints);
+                for (endpoint_index_t::const_iterator it = range.first; it != range.second; ++it) {
+                    const unsigned int i = it->second;
+
                     // ignore used ways
                     if (ways[i]->used >= 0) continue;
 
@@ -628,7 +730,7 @@ namespace Osmium {
                     way->nodes().push_back(*closest);
                     way->nodes().push_back(wn);
                     ways.push_back(make_shared<WayInfo>(way));
-                    std::cerr << "fill gap between nodes " << closest->ref() << " and " << wn.ref() << std::endl;
+                    m_messages << "fill gap between nodes " << closest->ref() << " and " << wn.ref() << "\n";
 
                     dangling_nodes.erase(closest);
                 }
@@ -658,12 +760,34 @@ namespace Osmium {
                 }
             }
 
+            static bool compare_endpoints(const std::pair<osm_object_id_t, unsigned int>& a, const std::pair<osm_object_id_t, unsigned int>& b) {
+                return a.first < b.first;
+            }
+
+            /**
+             * Build index of the first and last nodes of all ways, so that
+             * the ways connecting to a node can be found with a binary
+             * search when assembling the rings.
+             */
+            void build_endpoint_index(const std::vector< shared_ptr<WayInfo> >& ways) {
+                m_endpoints.clear();
+                m_endpoints.reserve(ways.size() * 2);
+                for (unsigned int i=0; i < ways.size(); ++i) {
+                    m_endpoints.push_back(std::make_pair(ways[i]->firstnode(), i));
+                    if (ways[i]->lastnode() != ways[i]->firstnode()) {
+                        m_endpoints.push_back(std::make_pair(ways[i]->lastnode(), i));
+                    }
+                }
+                std::sort(m_endpoints.begin(), m_endpoints.end());
+            }
+
             /**
              * Try and create as many closed rings as possible from the assortment
              * of ways. make_one_ring will automatically flag those that have been
              * used so they are not used again.
              */
             void make_rings(std::vector< shared_ptr<WayInfo> >& ways) {
+                build_endpoint_index(ways);
                 while (make_one_ring(ways)) {
                 };
 
@@ -674,6 +798,7 @@ namespace Osmium {
                 if (!find_and_repair_holes_in_rings(ways)) {
                     throw DanglingEnds("un-connectable dangling ends");
                 }
+                build_endpoint_index(ways);
 
                 // re-run ring building, taking into account the newly created "repair" bits.
                 // (in case there were no dangling bits, make_one_ring terminates quickly.)
@@ -689,60 +814,70 @@ namespace Osmium {
              * Find out which ring contains which other ring, so we know
              * which are inner rings and which outer. Don't trust the "role"
              * specifications.
+             *
+             * A ring can only contain another ring if its bounding box
+             * contains the bounding box of the other ring. The rings are
+             * sorted by the west edge of their bounding boxes, so the
+             * candidates for each ring can be found with a binary search
+             * and the expensive contains test is only done for them.
              */
             void determine_inner_outer_rings() {
-                typedef boost::dynamic_bitset<> bs_t;
-
-                std::vector<bs_t> contains(m_ringlist.size(), bs_t(m_ringlist.size()));
-
-                bs_t contained_by_even_number(m_ringlist.size());
-                contained_by_even_number.set();
-
-                // build contains relationships.
-                // we use contained_by_even_number as a helper for us to determine
-                // whether something is an inner (false) or outer (true) ring.
+                const unsigned int size = m_ringlist.size();
 
-                for (unsigned int i=0; i < m_ringlist.size(); ++i) {
-                    const scoped_ptr<geos::geom::prep::PreparedPolygon> pp(new geos::geom::prep::PreparedPolygon(m_ringlist[i]->polygon));
-                    for (unsigned int j=0; j < m_ringlist.size(); ++j) {
-                        if (i==j) continue;
-                        if (contains[j][i]) continue;
-                        contains[i][j] = pp->contains(m_ringlist[j]->polygon);
-                        contained_by_even_number[j] ^= contains[i][j];
-                    }
+                std::vector<RingBox> boxes;
+                boxes.reserve(size);
+                for (unsigned int i=0; i < size; ++i) {
+                    boxes.push_back(RingBox(*m_ringlist[i]->polygon->getEnvelopeInternal(), i));
                 }
-
-                // we now have an array that has a true value whenever something is
-                // contained by something else; if a contains b and b contains c, then
-                // our array says that a contains b, b contains c, and a contains c.
-                // thin out the array so that only direct relationships remain (and
-                // the "a contains c" is dropped).
-
-                for (unsigned int i=0; i < m_ringlist.size(); ++i) {
-                    for (unsigned j=0; j < m_ringlist.size(); ++j) {
-                        if (contains[i][j]) {
-                            // see if there is an intermediary relationship
-                            for (unsigned int k=0; k < m_ringlist.size(); ++k) {
-                                if (k==i) continue;
-                                if (k==j) continue;
-                                if (contains[i][k] && contains[k][j]) {
-                                    // intermediary relationship exists; break this
-                                    // one up.
-                                    contains[i][j] = false;
-                                    break;
-                                }
-                            }
+                std::sort(boxes.begin(), boxes.end());
+
+                // build contains relationships. for every ring we collect
+                // the indexes of all rings containing it (in ascending order).
+                // if a contains b and b contains c, then a and b are both
+                // in the list for c.
+                std::vector< std::vector<unsigned int> > containers(size);
+
+                for (unsigned int i=0; i < size; ++i) {
+                    const geos::geom::Envelope& envelope = *m_ringlist[i]->polygon->getEnvelopeInternal();
+                    scoped_ptr<geos::geom::prep::PreparedPolygon> pp;
+
+                    std::vector<RingBox>::const_iterator it = std::lower_bound(boxes.begin(), boxes.end(), envelope.getMinX(), RingBox::west_of);
+                    for (; it != boxes.end() && it->minx <= envelope.getMaxX(); ++it) {
+                        const unsigned int j = it->ring;
+                        if (i == j) continue;
+                        if (!it->inside(envelope)) continue;
+                        if (j < i && std::binary_search(containers[i].begin(), containers[i].end(), j)) continue;
+                        if (!pp) {
+                            pp.reset(new geos::geom::prep::PreparedPolygon(m_ringlist[i]->polygon));
+                        }
+                        if (pp->contains(m_ringlist[j]->polygon)) {
+                            containers[j].push_back(i);
                         }
                     }
                 }
 
+                // a ring contained by an odd number of rings is an inner ring.
+                // it is linked to the rings directly containing it, ie those
+                // not containing another of its containers. a ring can only
+                // contain rings nested deeper than itself, so only those have
+                // to be checked.
+                //
                 // populate the "inner_rings" list and the "contained_by" pointer
-                // in the ring list based on the data collected. the "contains"
-                // array can be thrown away afterwards.
-
-                for (unsigned int i=0; i < m_ringlist.size(); ++i) {
-                    for (unsigned int j=0; j < m_ringlist.size(); ++j) {
-                        if (contains[i][j] && !contained_by_even_number[j]) {
+                // in the ring list based on the data collected.
+
+                for (unsigned int j=0; j < size; ++j) {
+                    const std::vector<unsigned int>& cj = containers[j];
+                    if (cj.size() % 2 == 0) continue;
+
+                    BOOST_FOREACH(unsigned int i, cj) {
+                        bool direct = true;
+                        BOOST_FOREACH(unsigned int k, cj) {
+                            if (containers[k].size() > containers[i].size() && std::binary_search(containers[k].begin(), containers[k].end(), i)) {
+                                direct = false;
+                                break;
+                            }
+                        }
+                        if (direct) {
                             m_ringlist[j]->contained_by = m_ringlist[i];
                             m_ringlist[i]->inner_rings.push_back(m_ringlist[j]);
                         }
@@ -773,7 +908,7 @@ namespace Osmium {
 
                 geometries->push_back(Osmium::Geometry::geos_geometry_factory()->createPolygon(ring_info.ring_in_direction(CLOCKWISE), NULL));
 
-                shared_ptr<Osmium::OSM::Area> internal_area = make_shared<Osmium::OSM::Area>(*(ring_info.ways[0]->way));
+                shared_ptr<Osmium::OSM::Area> internal_area = make_shared<Osmium::OSM::Area>(ring_info.ways[0]->way);
                 internal_area->geos_geometry(Osmium::Geometry::geos_geometry_factory()->createMultiPolygon(geometries));
                 m_areas.push_back(internal_area);
             }
@@ -815,10 +950,11 @@ namespace Osmium {
                         const geos::geom::Geometry* ring2_geom = inner_rings[k]->polygon->getExteriorRing();
                         geos::geom::Geometry* inter = NULL;
                         try {
+                            if (!ring1_geom->getEnvelopeInternal()->intersects(ring2_geom->getEnvelopeInternal())) continue;
                             if (!ring1_geom->intersects(ring2_geom)) continue;
                             inter = ring1_geom->intersection(ring2_geom);
                         } catch (const geos::util::GEOSException& exc) {
-                            std::cerr << "Exception while checking intersection of rings\n";
+                            m_messages << "Exception while checking intersection of rings\n";
                             // nop;
                         }
 
@@ -898,7 +1034,7 @@ namespace Osmium {
                         if (p) valid = p->isValid();
                     } catch (const geos::util::GEOSException& exc) {
                         // nop
-                        std::cerr << "Exception during creation of polygon for relation #" << m_relation_info.relation()->id() << ": " << exc.what() << " (treating as invalid polygon)" << std::endl;
+                        m_messages << "Exception during creation of polygon for relation #" << m_relation_info.relation()->id() << ": " << exc.what() << " (treating as invalid polygon)\n";
                     }
                     if (!valid) {
                         // polygon is invalid.
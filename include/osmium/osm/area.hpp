@@ -26,6 +26,7 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 
 #include <geos/geom/MultiPolygon.h>
 
+#include <osmium/smart_ptr.hpp>
 #include <osmium/osm/object.hpp>
 #include <osmium/osm/way.hpp>
 #include <osmium/osm/relation.hpp>
@@ -59,6 +60,10 @@ namespace Osmium {
             friend class Osmium::Geometry::MultiPolygon;
 
             WayNodeList m_node_list;
+
+            /// The way this area was created from (if it was created without copying the way).
+            shared_ptr<Way const> m_way;
+
             mutable geos::geom::MultiPolygon* m_geos_geometry;
 
             const geos::geom::MultiPolygon* geos_geometry() const {
@@ -70,7 +75,8 @@ namespace Osmium {
             /// Construct an Area object from a Relation object.
             Area(const Relation& relation) :
                 Object(relation),
-                m_node_list(),
+                m_node_list(0),
+                m_way(),
                 m_geos_geometry() {
                 id((id() * 2) + sgn(id()));
             }
@@ -79,6 +85,20 @@ namespace Osmium {
             Area(const Way& way) :
                 Object(way),
                 m_node_list(way.nodes()),
+                m_way(),
+                m_geos_geometry() {
+                id(id() * 2);
+            }
+
+            /**
+             * Construct an Area object from a Way object. The nodes of
+             * the way are not copied, the area keeps a pointer to the way
+             * instead.
+             */
+            Area(const shared_ptr<Way const>& way) :
+                Object(*way),
+                m_node_list(0),
+                m_way(way),
                 m_geos_geometry() {
                 id(id() * 2);
             }
@@ -86,7 +106,8 @@ namespace Osmium {
             Area(const Area& area) :
                 Object(area),
                 m_node_list(area.m_node_list),
-                m_geos_geometry(dynamic_cast<geos::geom::MultiPolygon*>(area.m_geos_geometry->clone())) {
+                m_way(area.m_way),
+                m_geos_geometry(area.m_geos_geometry ? dynamic_cast<geos::geom::MultiPolygon*>(area.m_geos_geometry->clone()) : NULL) {
             }
 
             Area& operator=(const Area& area) {
@@ -100,7 +121,10 @@ namespace Osmium {
                 visible(area.visible());
                 tags(area.tags());
                 m_node_list = area.m_node_list;
-                m_geos_geometry = dynamic_cast<geos::geom::MultiPolygon*>(area.m_geos_geometry->clone());
+                m_way = area.m_way;
+                geos::geom::MultiPolygon* geometry = area.m_geos_geometry ? dynamic_cast<geos::geom::MultiPolygon*>(area.m_geos_geometry->clone()) : NULL;
+                delete m_geos_geometry;
+                m_geos_geometry = geometry;
                 return *this;
             }
 
@@ -117,6 +141,14 @@ namespace Osmium {
                 return (id() % 2) == 0;
             }
 
+            /**
+             * The nodes of the Way this Area was created from. Empty if
+             * it was created from a Relation.
+             */
+            const WayNodeList& nodes() const {
+                return m_way ? m_way->nodes() : m_node_list;
+            }
+
             /// ID of the Way or Relation objects this Area was created from.
             osm_object_id_t orig_id() const {
                 return id() / 2;
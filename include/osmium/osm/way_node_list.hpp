@@ -50,6 +50,11 @@ namespace Osmium {
                 return m_list.size();
             }
 
+            /// Return the number of nodes this list has room for without reallocating.
+            osm_sequence_id_t capacity() const {
+                return m_list.capacity();
+            }
+
             bool empty() const {
                 return m_list.empty();
             }
@@ -58,6 +63,11 @@ namespace Osmium {
                 m_list.clear();
             }
 
+            /// Exchange the nodes (and the memory used for them) with another list.
+            void swap(WayNodeList& other) {
+                m_list.swap(other.m_list);
+            }
+
             typedef std::vector<WayNode>::iterator iterator;
             typedef std::vector<WayNode>::const_iterator const_iterator;
             typedef std::vector<WayNode>::reverse_iterator reverse_iterator;
@@ -124,8 +134,9 @@ namespace Osmium {
                 return m_list.back();
             }
 
+            /// Is the list closed (same first and last node)? An empty list is not.
             bool is_closed() const {
-                return m_list.front().ref() == m_list.back().ref();
+                return !m_list.empty() && m_list.front().ref() == m_list.back().ref();
             }
 
             bool has_position() const {
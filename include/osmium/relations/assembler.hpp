@@ -24,7 +24,10 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <set>
 #include <utility>
 #include <vector>
 #include <boost/foreach.hpp>
@@ -32,6 +35,8 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 
 #include <osmium/handler.hpp>
 #include <osmium/relations/relation_info.hpp>
+#include <osmium/relations/spill_file.hpp>
+#include <osmium/utils/bloom_filter.hpp>
 
 namespace Osmium {
 
@@ -106,11 +111,31 @@ namespace Osmium {
          *
          * Later the m_member_(nodes|ways|relations) vectors are sorted according to the
          * member ids so that a binary search (with equal_range) can be used in the second
-         * pass to find the relations for each node, way, or relation coming along. The
+         * pass to find the relations for each node, way, or relation coming along. Most
+         * objects are not members of any relation, so before the binary search the id is
+         * checked against the range of member ids and a Bloom filter. The
          * member objects are stored together with their relation and once a relation is
          * complete the complete_relation() method is called which you can overwrite in
          * a child class of Assembler.
          *
+         * Relations can wait a long time for their last member, so the
+         * members collected in the second pass can take a lot of memory.
+         * If a memory budget is set with memory_budget(), members of the
+         * relations that have been waiting longest are written to a
+         * temporary SpillFile whenever the estimated memory used by
+         * members goes over the budget. They are read back when the
+         * relation is complete or before all_members_available() is called.
+         *
+         * If resolve_nested_relations() is switched on, relation members
+         * that are themselves relations we are interested in are not taken
+         * from the input in the second pass. Instead a parent relation gets
+         * its child relation as member when the child is complete. So
+         * complete_relation() is called for all children before their
+         * parents and nested relations are assembled in one run without
+         * reading relations in the second pass. Relations referencing each
+         * other in a cycle can never be complete this way; the members
+         * closing a cycle are taken from the input as usual.
+         *
          * @tparam TAssembler Child class of this class.
          *
          * @tparam TRelationInfo RelationInfo or a child class of it.
@@ -133,6 +158,56 @@ namespace Osmium {
             /// This is the type used for results of the equal_range algorithm.
             typedef std::pair<typename member_info_vector_t::iterator, typename member_info_vector_t::iterator> member_info_range_t;
 
+            /**
+             * Book keeping for the members of one relation when a memory
+             * budget is set.
+             */
+            struct SpillInfo {
+
+                /// Estimated memory used by the members of this relation still in memory.
+                uint64_t memory;
+
+                /// Value of m_member_count when the first member still in memory arrived.
+                uint64_t since;
+
+                /// Positions and spill file offsets of the members written to the spill file.
+                std::vector< std::pair<osm_sequence_id_t, SpillFile::offset_t> > spilled;
+
+                SpillInfo() :
+                    memory(0),
+                    since(0),
+                    spilled() {
+                }
+
+            }; // struct SpillInfo
+
+            /**
+             * Edge from a parent relation to a child relation in the graph
+             * of nested relations. Only used while building the graph.
+             */
+            struct NestedEdge {
+
+                /// Position of the parent relation in m_relations.
+                unsigned int parent_pos;
+
+                /// Position of the child relation in m_relations.
+                unsigned int child_pos;
+
+                /// Index of the MemberInfo for this member in m_member_infos[RELATION].
+                unsigned int member_info_pos;
+
+                NestedEdge(unsigned int parent, unsigned int child, unsigned int member_info) :
+                    parent_pos(parent),
+                    child_pos(child),
+                    member_info_pos(member_info) {
+                }
+
+                bool operator<(const NestedEdge& other) const {
+                    return parent_pos < other.parent_pos;
+                }
+
+            }; // struct NestedEdge
+
         public:
 
             /**
@@ -144,7 +219,19 @@ namespace Osmium {
                 m_handler_pass1(*static_cast<TAssembler*>(this)),
                 m_handler_pass2(*static_cast<TAssembler*>(this)),
                 m_relations(),
-                m_member_infos() {
+                m_member_infos(),
+                m_member_filters(),
+                m_memory_budget(0),
+                m_member_memory(0),
+                m_member_count(0),
+                m_spill_infos(),
+                m_spill_file(),
+                m_resolve_nested(false),
+                m_nested_members(),
+                m_depths(),
+                m_relations_per_depth(),
+                m_completed_per_depth(),
+                m_cyclic_members(0) {
             }
 
             /**
@@ -156,7 +243,19 @@ namespace Osmium {
                 m_handler_pass1(*static_cast<TAssembler*>(this)),
                 m_handler_pass2(*static_cast<TAssembler*>(this)),
                 m_relations(),
-                m_member_infos() {
+                m_member_infos(),
+                m_member_filters(),
+                m_memory_budget(0),
+                m_member_memory(0),
+                m_member_count(0),
+                m_spill_infos(),
+                m_spill_file(),
+                m_resolve_nested(false),
+                m_nested_members(),
+                m_depths(),
+                m_relations_per_depth(),
+                m_completed_per_depth(),
+                m_cyclic_members(0) {
             }
 
         protected:
@@ -193,6 +292,22 @@ namespace Osmium {
                 return true;
             }
 
+            /**
+             * This method is called once for every object that is a member
+             * of at least one relation we are interested in, before it is
+             * stored in the RelationInfo objects of those relations. The
+             * object returned is stored instead of the original and shared
+             * between all relations.
+             *
+             * Overwrite this method in a child class to keep only the parts
+             * of the object needed to assemble the relations. Members can
+             * be held for a long time until the last member of a relation
+             * arrives, so this can save a lot of memory.
+             */
+            shared_ptr<Osmium::OSM::Object const> compact_member(const shared_ptr<Osmium::OSM::Object const>& object) {
+                return object;
+            }
+
             /**
              * This method is called for all nodes that are not a member of
              * any relation.
@@ -283,20 +398,222 @@ namespace Osmium {
 
             /**
              * Sort the vectors with the member infos so that we can do binary
-             * search on them.
+             * search on them and build the member filters.
              */
             void sort_member_infos() {
-                std::sort(m_member_infos[NODE].begin(),     m_member_infos[NODE].end());
-                std::sort(m_member_infos[WAY].begin(),      m_member_infos[WAY].end());
-                std::sort(m_member_infos[RELATION].begin(), m_member_infos[RELATION].end());
+                if (m_resolve_nested) {
+                    build_nested_relations();
+                }
+
+                for (int type = NODE; type <= RELATION; ++type) {
+                    member_info_vector_t& miv = m_member_infos[type];
+                    std::sort(miv.begin(), miv.end());
+
+                    BloomFilter filter(miv.size());
+                    BOOST_FOREACH(const MemberInfo& member_info, miv) {
+                        filter.add(member_info.m_member_id);
+                    }
+                    std::swap(m_member_filters[type], filter);
+                }
+
+                if (m_memory_budget > 0) {
+                    m_spill_infos.resize(m_relations.size());
+                }
+            }
+
+            /**
+             * Build the graph of relations that are members of other
+             * relations we are interested in. The MemberInfos for these
+             * members are moved from m_member_infos[RELATION] to
+             * m_nested_members, except for those closing a cycle, which
+             * are found with a depth first search. The search also
+             * calculates the nesting depth of each relation: Relations
+             * without nested relations have depth 0, others have one more
+             * than their deepest child.
+             */
+            void build_nested_relations() {
+                const unsigned int nrelations = m_relations.size();
+
+                std::vector< std::pair<osm_object_id_t, unsigned int> > positions;
+                positions.reserve(nrelations);
+                for (unsigned int pos = 0; pos < nrelations; ++pos) {
+                    positions.push_back(std::make_pair(m_relations[pos].relation()->id(), pos));
+                }
+                std::sort(positions.begin(), positions.end());
+
+                // Children not needing any members are never completed, so
+                // they are left to be read from the input.
+                member_info_vector_t& miv = m_member_infos[RELATION];
+                std::vector<NestedEdge> edges;
+                for (unsigned int i = 0; i < miv.size(); ++i) {
+                    std::vector< std::pair<osm_object_id_t, unsigned int> >::const_iterator it =
+                        std::lower_bound(positions.begin(), positions.end(), std::make_pair(miv[i].m_member_id, 0u));
+                    if (it != positions.end() && it->first == miv[i].m_member_id && m_relations[it->second].need_members() > 0) {
+                        edges.push_back(NestedEdge(miv[i].m_relation_pos, it->second, i));
+                    }
+                }
+                std::stable_sort(edges.begin(), edges.end());
+
+                // index of the first edge of each relation in edges
+                std::vector<unsigned int> first_edge(nrelations + 1, 0);
+                BOOST_FOREACH(const NestedEdge& edge, edges) {
+                    ++first_edge[edge.parent_pos + 1];
+                }
+                for (unsigned int pos = 0; pos < nrelations; ++pos) {
+                    first_edge[pos + 1] += first_edge[pos];
+                }
+
+                enum { unvisited = 0, on_stack = 1, done = 2 };
+                std::vector<unsigned char> state(nrelations, unvisited);
+                std::vector<bool> closes_cycle(edges.size(), false);
+                m_depths.assign(nrelations, 0);
+
+                // stack of relation positions and the next edge to look at
+                std::vector< std::pair<unsigned int, unsigned int> > stack;
+                for (unsigned int root = 0; root < nrelations; ++root) {
+                    if (state[root] != unvisited) {
+                        continue;
+                    }
+                    state[root] = on_stack;
+                    stack.push_back(std::make_pair(root, first_edge[root]));
+                    while (!stack.empty()) {
+                        const unsigned int pos = stack.back().first;
+                        if (stack.back().second < first_edge[pos + 1]) {
+                            const unsigned int e = stack.back().second++;
+                            const unsigned int child = edges[e].child_pos;
+                            if (state[child] == on_stack) {
+                                closes_cycle[e] = true;
+                            } else if (state[child] == unvisited) {
+                                state[child] = on_stack;
+                                stack.push_back(std::make_pair(child, first_edge[child]));
+                            }
+                        } else {
+                            for (unsigned int e = first_edge[pos]; e < first_edge[pos + 1]; ++e) {
+                                if (!closes_cycle[e]) {
+                                    m_depths[pos] = std::max(m_depths[pos], m_depths[edges[e].child_pos] + 1);
+                                }
+                            }
+                            state[pos] = done;
+                            stack.pop_back();
+                        }
+                    }
+                }
+
+                std::vector<bool> nested(miv.size(), false);
+                for (unsigned int e = 0; e < edges.size(); ++e) {
+                    if (closes_cycle[e]) {
+                        ++m_cyclic_members;
+                    } else {
+                        nested[edges[e].member_info_pos] = true;
+                    }
+                }
+
+                member_info_vector_t stream_members;
+                for (unsigned int i = 0; i < miv.size(); ++i) {
+                    if (nested[i]) {
+                        m_nested_members.push_back(miv[i]);
+                    } else {
+                        stream_members.push_back(miv[i]);
+                    }
+                }
+                std::swap(miv, stream_members);
+                std::sort(m_nested_members.begin(), m_nested_members.end());
+
+                BOOST_FOREACH(unsigned int depth, m_depths) {
+                    if (depth >= m_relations_per_depth.size()) {
+                        m_relations_per_depth.resize(depth + 1, 0);
+                    }
+                    ++m_relations_per_depth[depth];
+                }
+                m_completed_per_depth.assign(m_relations_per_depth.size(), 0);
             }
 
         public:
 
+            /**
+             * Set the memory budget in bytes for the member objects
+             * collected in the second pass. If the estimated memory used by
+             * them goes over this, members are written to a spill file until
+             * it is down to half the budget. Set to 0 (the default) to keep
+             * everything in memory.
+             *
+             * This must be called before the end of the first pass.
+             */
+            void memory_budget(uint64_t bytes) {
+                m_memory_budget = bytes;
+            }
+
+            uint64_t memory_budget() const {
+                return m_memory_budget;
+            }
+
+            /**
+             * Resolve relations that are members of other relations while
+             * assembling, see the description of this class.
+             *
+             * This must be called before the end of the first pass.
+             */
+            void resolve_nested_relations(bool resolve) {
+                m_resolve_nested = resolve;
+            }
+
+            bool resolve_nested_relations() const {
+                return m_resolve_nested;
+            }
+
+            /**
+             * Number of relations at each nesting depth. Relations without
+             * nested relations are at depth 0. Only available if nested
+             * relations are resolved.
+             */
+            const std::vector<uint64_t>& relations_per_depth() const {
+                return m_relations_per_depth;
+            }
+
+            /**
+             * Number of relations at each nesting depth that have been
+             * completed so far.
+             */
+            const std::vector<uint64_t>& completed_per_depth() const {
+                return m_completed_per_depth;
+            }
+
+            /**
+             * Number of relation members closing a cycle of nested
+             * relations. They are read from the input instead.
+             */
+            uint64_t cyclic_members() const {
+                return m_cyclic_members;
+            }
+
+            /**
+             * Number of member objects written to the spill file so far.
+             */
+            uint64_t spilled_members() const {
+                return m_spill_file ? m_spill_file->count() : 0;
+            }
+
             uint64_t used_memory() const {
                 uint64_t nmembers = m_member_infos[NODE].size() + m_member_infos[WAY].size() + m_member_infos[RELATION].size();
-                uint64_t relations = m_relations.size() * (sizeof(TRelationInfo) + sizeof(Osmium::OSM::Relation)) + nmembers * sizeof(Osmium::OSM::RelationMember); // plus tags
+                uint64_t relations = m_relations.size() * (sizeof(TRelationInfo) + sizeof(Osmium::OSM::Relation)) + nmembers * sizeof(Osmium::OSM::RelationMember);
                 uint64_t members = nmembers * sizeof(MemberInfo);
+                uint64_t filters = m_member_filters[NODE].used_memory() + m_member_filters[WAY].used_memory() + m_member_filters[RELATION].used_memory();
+
+                // tags of the relations and the member objects stored so far,
+                // member objects shared between relations are counted once
+                uint64_t tags = 0;
+                uint64_t member_objects = 0;
+                std::set<const Osmium::OSM::Object*> seen;
+                BOOST_FOREACH(const TRelationInfo& relation_info, m_relations) {
+                    if (relation_info.relation()) {
+                        tags += tags_memory(relation_info.relation()->tags());
+                    }
+                    BOOST_FOREACH(const shared_ptr<Osmium::OSM::Object const>& object, relation_info.members()) {
+                        if (object && seen.insert(object.get()).second) {
+                            member_objects += object_memory(*object);
+                        }
+                    }
+                }
 
                 std::cout << "nR  = m_relations.size()             = " << m_relations.size() << "\n";
                 std::cout << "nMN = m_member_info[NODE].size()     = " << m_member_infos[NODE].size() << "\n";
@@ -312,10 +629,202 @@ namespace Osmium {
                 std::cout << "nR * (sRI + sR) = " << m_relations.size() * (sizeof(TRelationInfo) + sizeof(Osmium::OSM::Relation)) << "\n";
                 std::cout << "nM * sRM        = " << nmembers * sizeof(Osmium::OSM::RelationMember) << "\n";
                 std::cout << "nM * sMI        = " << nmembers * sizeof(MemberInfo) << "\n";
+                std::cout << "member filters  = " << filters << "\n";
+                std::cout << "relation tags   = " << tags << "\n";
+                std::cout << "member objects  = " << member_objects << " (" << seen.size() << " objects)\n";
+                if (m_resolve_nested) {
+                    std::cout << "nested members  = " << m_nested_members.size() << " (" << m_cyclic_members << " in cycles)\n";
+                }
+                if (m_spill_file) {
+                    std::cout << "spilled members = " << m_spill_file->count() << " (" << m_spill_file->size() << " bytes on disk)\n";
+                }
+
+                return relations + members + filters + tags + member_objects;
+            }
+
+        private:
+
+            /**
+             * Estimate the memory used by the tags in the tag list.
+             */
+            static uint64_t tags_memory(const Osmium::OSM::TagList& tags) {
+                uint64_t size = 0;
+                BOOST_FOREACH(const Osmium::OSM::Tag& tag, tags) {
+                    size += sizeof(Osmium::OSM::Tag) + strlen(tag.key()) + strlen(tag.value());
+                }
+                return size;
+            }
+
+            /**
+             * Estimate the memory used by an OSM object including its
+             * tags, way nodes, and relation members.
+             */
+            static uint64_t object_memory(const Osmium::OSM::Object& object) {
+                uint64_t size = strlen(object.user()) + tags_memory(object.tags());
+                switch (object.type()) {
+                    case NODE:
+                        size += sizeof(Osmium::OSM::Node);
+                        break;
+                    case WAY:
+                        size += sizeof(Osmium::OSM::Way) + static_cast<const Osmium::OSM::Way&>(object).nodes().capacity() * sizeof(Osmium::OSM::WayNode);
+                        break;
+                    case RELATION:
+                        size += sizeof(Osmium::OSM::Relation) + static_cast<const Osmium::OSM::Relation&>(object).members().size() * sizeof(Osmium::OSM::RelationMember);
+                        break;
+                    default:
+                        break;
+                }
+                return size;
+            }
+
+            /**
+             * Account for a member of the relation at relation_pos that was
+             * just added and is held in memory.
+             */
+            void account_member(unsigned int relation_pos, uint64_t memory) {
+                SpillInfo& info = m_spill_infos[relation_pos];
+                if (info.memory == 0) {
+                    info.since = m_member_count;
+                }
+                info.memory += memory;
+                m_member_memory += memory;
+            }
+
+            /**
+             * If the members in memory go over the memory budget, write
+             * the members of the relations that have been waiting longest
+             * to the spill file until they are down to half the budget.
+             */
+            void check_memory_budget() {
+                if (m_member_memory <= m_memory_budget) {
+                    return;
+                }
+
+                std::vector< std::pair<uint64_t, unsigned int> > waiting;
+                for (unsigned int pos = 0; pos < m_spill_infos.size(); ++pos) {
+                    if (m_spill_infos[pos].memory > 0) {
+                        waiting.push_back(std::make_pair(m_spill_infos[pos].since, pos));
+                    }
+                }
+                std::sort(waiting.begin(), waiting.end());
+
+                if (!m_spill_file) {
+                    m_spill_file.reset(new SpillFile());
+                }
+
+                // objects that are members of several relations are only written once
+                std::map<const Osmium::OSM::Object*, SpillFile::offset_t> written;
+
+                for (std::vector< std::pair<uint64_t, unsigned int> >::const_iterator it = waiting.begin(); it != waiting.end() && m_member_memory > m_memory_budget / 2; ++it) {
+                    TRelationInfo& relation_info = m_relations[it->second];
+                    SpillInfo& info = m_spill_infos[it->second];
+                    for (osm_sequence_id_t n = 0; n < relation_info.members().size(); ++n) {
+                        const shared_ptr<Osmium::OSM::Object const>& member = relation_info.members()[n];
+                        if (member) {
+                            std::map<const Osmium::OSM::Object*, SpillFile::offset_t>::const_iterator w = written.find(member.get());
+                            if (w == written.end()) {
+                                w = written.insert(std::make_pair(member.get(), m_spill_file->write(*member))).first;
+                            }
+                            info.spilled.push_back(std::make_pair(n, w->second));
+                            relation_info.reset_member(n);
+                        }
+                    }
+                    m_member_memory -= info.memory;
+                    info.memory = 0;
+                }
+            }
+
+            /**
+             * Read back the spilled members of the relation at
+             * relation_pos and forget the book keeping for it.
+             */
+            void reload_members(unsigned int relation_pos) {
+                if (m_spill_infos.empty()) {
+                    return;
+                }
+
+                SpillInfo& info = m_spill_infos[relation_pos];
+                TRelationInfo& relation_info = m_relations[relation_pos];
+                for (std::vector< std::pair<osm_sequence_id_t, SpillFile::offset_t> >::const_iterator it = info.spilled.begin(); it != info.spilled.end(); ++it) {
+                    relation_info.restore_member(m_spill_file->read(it->second), it->first);
+                }
+                m_member_memory -= info.memory;
+                info.memory = 0;
+                std::vector< std::pair<osm_sequence_id_t, SpillFile::offset_t> >().swap(info.spilled);
+            }
+
+            /**
+             * Hand the complete relation at relation_pos to complete_relation()
+             * and remove it. If nested relations are resolved, add it to the
+             * relations it is a member of, completing them in turn if this
+             * was the last member they needed.
+             */
+            void finish_relation(unsigned int relation_pos) {
+                reload_members(relation_pos);
+                static_cast<TAssembler*>(this)->complete_relation(m_relations[relation_pos]);
+
+                if (!m_resolve_nested) {
+                    m_relations[relation_pos] = TRelationInfo();
+                    return;
+                }
 
-                return relations + members;
+                ++m_completed_per_depth[m_depths[relation_pos]];
+                const shared_ptr<Osmium::OSM::Relation const> relation = m_relations[relation_pos].relation();
+                m_relations[relation_pos] = TRelationInfo();
+
+                const member_info_range_t range = std::equal_range(m_nested_members.begin(), m_nested_members.end(), MemberInfo(relation->id()));
+                if (range.first == range.second) {
+                    return;
+                }
+
+                const shared_ptr<Osmium::OSM::Object const> member = static_cast<TAssembler*>(this)->compact_member(relation);
+                const uint64_t member_memory = m_spill_infos.empty() ? 0 : object_memory(*member);
+                BOOST_FOREACH(const MemberInfo& member_info, range) {
+                    if (!m_spill_infos.empty()) {
+                        account_member(member_info.m_relation_pos, member_memory);
+                    }
+                    if (m_relations[member_info.m_relation_pos].add_member(member, member_info.m_member_pos)) {
+                        finish_relation(member_info.m_relation_pos);
+                    }
+                }
+            }
+
+            /**
+             * Give incomplete relations their nested relations that are
+             * still incomplete themselves as members, so that
+             * all_members_available() sees them like it would if they had
+             * been read from the input. The members needed counters are not
+             * changed.
+             */
+            void add_incomplete_nested_relations() {
+                if (m_nested_members.empty()) {
+                    return;
+                }
+
+                std::vector< std::pair<osm_object_id_t, unsigned int> > positions;
+                for (unsigned int pos = 0; pos < m_relations.size(); ++pos) {
+                    if (m_relations[pos].relation()) {
+                        positions.push_back(std::make_pair(m_relations[pos].relation()->id(), pos));
+                    }
+                }
+                std::sort(positions.begin(), positions.end());
+
+                BOOST_FOREACH(const MemberInfo& member_info, m_nested_members) {
+                    TRelationInfo& parent = m_relations[member_info.m_relation_pos];
+                    if (!parent.relation() || parent.members()[member_info.m_member_pos]) {
+                        continue;
+                    }
+                    std::vector< std::pair<osm_object_id_t, unsigned int> >::const_iterator it =
+                        std::lower_bound(positions.begin(), positions.end(), std::make_pair(member_info.m_member_id, 0u));
+                    if (it != positions.end() && it->first == member_info.m_member_id) {
+                        parent.restore_member(m_relations[it->second].relation(), member_info.m_member_pos);
+                    }
+                }
+                member_info_vector_t().swap(m_nested_members);
             }
 
+        public:
+
             /**
              * This is the handler class for the first pass of the Assembler.
              */
@@ -370,24 +879,46 @@ namespace Osmium {
                  */
                 bool find_and_add_object(const shared_ptr<Osmium::OSM::Object const>& object) const {
                     member_info_vector_t& miv = m_assembler.m_member_infos[object->type()];
-                    const member_info_range_t range = std::equal_range(miv.begin(), miv.end(), MemberInfo(object->id()));
+                    const osm_object_id_t id = object->id();
+
+                    // quickly reject objects that are not members of any relation
+                    if (miv.empty() || id < miv.front().m_member_id || id > miv.back().m_member_id) {
+                        return false;
+                    }
+                    if (!m_assembler.m_member_filters[object->type()].contains(id)) {
+                        return false;
+                    }
+
+                    const member_info_range_t range = std::equal_range(miv.begin(), miv.end(), MemberInfo(id));
 
                     if (range.first == range.second) {
                         // nothing found
                         return false;
                     }
 
+                    const shared_ptr<Osmium::OSM::Object const> member = m_assembler.compact_member(object);
+
+                    const bool budget = !m_assembler.m_spill_infos.empty();
+                    const uint64_t member_memory = budget ? object_memory(*member) : 0;
+                    ++m_assembler.m_member_count;
+
                     BOOST_FOREACH(const MemberInfo& member_info, range) {
                         assert(member_info.m_member_id == object->id());
                         assert(member_info.m_relation_pos < m_assembler.m_relations.size());
                         TRelationInfo& relation_info = m_assembler.m_relations[member_info.m_relation_pos];
                         assert(member_info.m_member_pos < relation_info.relation()->members().size());
-                        if (relation_info.add_member(object, member_info.m_member_pos)) {
-                            m_assembler.complete_relation(relation_info);
-                            m_assembler.m_relations[member_info.m_relation_pos] = TRelationInfo();
+                        if (budget) {
+                            m_assembler.account_member(member_info.m_relation_pos, member_memory);
+                        }
+                        if (relation_info.add_member(member, member_info.m_member_pos)) {
+                            m_assembler.finish_relation(member_info.m_relation_pos);
                         }
                     }
 
+                    if (budget) {
+                        m_assembler.check_memory_budget();
+                    }
+
                     return true;
                 }
 
@@ -399,7 +930,14 @@ namespace Osmium {
                 void after(osm_object_type_t type) {
                     // clear all memory used by m_member_info of this type
                     member_info_vector_t().swap(m_assembler.m_member_infos[type]);
+                    m_assembler.m_member_filters[type].clear();
                     if (--m_want_types == 0) {
+                        for (unsigned int pos = 0; pos < m_assembler.m_spill_infos.size(); ++pos) {
+                            m_assembler.reload_members(pos);
+                        }
+                        std::vector<SpillInfo>().swap(m_assembler.m_spill_infos);
+                        m_assembler.m_spill_file.reset();
+                        m_assembler.add_incomplete_nested_relations();
                         m_assembler.all_members_available();
                     }
                 }
@@ -518,6 +1056,46 @@ namespace Osmium {
              */
             member_info_vector_t m_member_infos[3];
 
+            /**
+             * Bloom filters for the ids in m_member_infos, used to quickly
+             * reject objects that are not members of any relation.
+             */
+            BloomFilter m_member_filters[3];
+
+            /// Memory budget for member objects in bytes, 0 if there is none.
+            uint64_t m_memory_budget;
+
+            /// Estimated memory used by member objects held in memory.
+            uint64_t m_member_memory;
+
+            /// Number of member objects found so far in the second pass.
+            uint64_t m_member_count;
+
+            /// Spill book keeping for each relation in m_relations, empty if there is no memory budget.
+            std::vector<SpillInfo> m_spill_infos;
+
+            /// Spill file, created when it is first needed.
+            scoped_ptr<SpillFile> m_spill_file;
+
+            /// Resolve nested relations while assembling?
+            bool m_resolve_nested;
+
+            /**
+             * Mappings from relation ids to the relations they are a member
+             * of for relations we are assembling ourselves. Sorted by member
+             * id like m_member_infos.
+             */
+            member_info_vector_t m_nested_members;
+
+            /// Nesting depth of each relation in m_relations.
+            std::vector<unsigned int> m_depths;
+
+            std::vector<uint64_t> m_relations_per_depth;
+            std::vector<uint64_t> m_completed_per_depth;
+
+            /// Number of members closing a cycle of nested relations.
+            uint64_t m_cyclic_members;
+
         }; // class Assembler
 
     } // namespace Relations
@@ -22,6 +22,7 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 
 */
 
+#include <cassert>
 #include <functional>
 #include <vector>
 
@@ -104,6 +105,26 @@ namespace Osmium {
                 return --m_need_members == 0;
             }
 
+            /**
+             * Drop the member object at position n, for instance after it
+             * was written to a spill file. The member is still counted as
+             * found.
+             */
+            void reset_member(osm_sequence_id_t n) {
+                assert(n < m_members.size());
+                m_members[n].reset();
+            }
+
+            /**
+             * Put back a member object dropped with reset_member(), for
+             * instance after reading it from a spill file. Unlike
+             * add_member() this doesn't change the members needed counter.
+             */
+            void restore_member(const shared_ptr<Osmium::OSM::Object const>& object, osm_sequence_id_t n) {
+                assert(n < m_members.size());
+                m_members[n] = object;
+            }
+
             /**
              * Get a vector reference with shared pointers to all member objects.
              * Note that the pointers can be empty if a member object is of a type
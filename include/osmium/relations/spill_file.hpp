@@ -0,0 +1,332 @@
+#ifndef OSMIUM_RELATIONS_SPILL_FILE_HPP
+#define OSMIUM_RELATIONS_SPILL_FILE_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/types.h>
+#include <boost/foreach.hpp>
+#include <boost/utility.hpp>
+
+#include <osmium/smart_ptr.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/osm/relation.hpp>
+
+namespace Osmium {
+
+    namespace Relations {
+
+        /**
+         * Temporary file used by the Assembler to move relation members
+         * out of memory while their relations are still waiting for other
+         * members.
+         *
+         * Nodes, ways, and relations are written in a simple binary format
+         * in native byte order, the file is only ever read back by the same
+         * process. Each object is written as a 32 bit length followed by
+         * the data and can be read back using the offset returned by
+         * write(). The file is created with tmpfile(3) and removed
+         * automatically when the SpillFile is destroyed.
+         */
+        class SpillFile : boost::noncopyable {
+
+        public:
+
+            typedef uint64_t offset_t;
+
+            SpillFile() :
+                m_file(tmpfile()),
+                m_size(0),
+                m_count(0),
+                m_at_end(true),
+                m_buffer() {
+                if (!m_file) {
+                    throw std::runtime_error(std::string("can't create spill file: ") + strerror(errno));
+                }
+            }
+
+            ~SpillFile() {
+                fclose(m_file);
+            }
+
+            /**
+             * Write object to the end of the file.
+             *
+             * @returns offset of the object in the file
+             */
+            offset_t write(const Osmium::OSM::Object& object) {
+                m_buffer.clear();
+                serialize(object, m_buffer);
+
+                if (!m_at_end) {
+                    if (fseeko(m_file, 0, SEEK_END) != 0) {
+                        throw std::runtime_error(std::string("can't seek in spill file: ") + strerror(errno));
+                    }
+                    m_at_end = true;
+                }
+
+                const uint32_t length = m_buffer.size();
+                if (fwrite(&length, sizeof(length), 1, m_file) != 1 ||
+                    fwrite(m_buffer.data(), m_buffer.size(), 1, m_file) != 1) {
+                    throw std::runtime_error(std::string("can't write to spill file: ") + strerror(errno));
+                }
+
+                const offset_t offset = m_size;
+                m_size += sizeof(length) + length;
+                ++m_count;
+                return offset;
+            }
+
+            /**
+             * Read the object written at the given offset.
+             */
+            shared_ptr<Osmium::OSM::Object const> read(offset_t offset) {
+                if (fflush(m_file) != 0 || fseeko(m_file, offset, SEEK_SET) != 0) {
+                    throw std::runtime_error(std::string("can't seek in spill file: ") + strerror(errno));
+                }
+                m_at_end = false;
+
+                uint32_t length;
+                if (fread(&length, sizeof(length), 1, m_file) != 1) {
+                    throw std::runtime_error("can't read from spill file");
+                }
+                m_buffer.resize(length);
+                if (length > 0 && fread(&m_buffer[0], length, 1, m_file) != 1) {
+                    throw std::runtime_error("can't read from spill file");
+                }
+
+                const char* data = m_buffer.data();
+                return deserialize(data);
+            }
+
+            /// Number of bytes written to the file.
+            uint64_t size() const {
+                return m_size;
+            }
+
+            /// Number of objects written to the file.
+            uint64_t count() const {
+                return m_count;
+            }
+
+        private:
+
+            template <typename T>
+            static void append(std::string& buffer, T value) {
+                buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            static void append_string(std::string& buffer, const char* str) {
+                const uint32_t length = strlen(str);
+                append(buffer, length);
+                buffer.append(str, length);
+            }
+
+            template <typename T>
+            static T extract(const char*& data) {
+                T value;
+                memcpy(&value, data, sizeof(T));
+                data += sizeof(T);
+                return value;
+            }
+
+            static std::string extract_string(const char*& data) {
+                const uint32_t length = extract<uint32_t>(data);
+                std::string str(data, length);
+                data += length;
+                return str;
+            }
+
+            /**
+             * Number of way nodes or relation members of the object. It is
+             * written before everything else so that the list can be
+             * created with the right size when reading.
+             */
+            static uint32_t element_count(const Osmium::OSM::Object& object) {
+                switch (object.type()) {
+                    case WAY:
+                        return static_cast<const Osmium::OSM::Way&>(object).nodes().size();
+                    case RELATION:
+                        return static_cast<const Osmium::OSM::Relation&>(object).members().size();
+                    default:
+                        return 0;
+                }
+            }
+
+        public:
+
+            /**
+             * Append the serialized object to the buffer. This is the
+             * format used for the objects in the file, without the
+             * length in front.
+             *
+             * @throws std::runtime_error if the object is not a node, way, or relation.
+             */
+            static void serialize(const Osmium::OSM::Object& object, std::string& buffer) {
+                append<uint8_t>(buffer, object.type());
+                append<uint32_t>(buffer, element_count(object));
+                append<osm_object_id_t>(buffer, object.id());
+                append<osm_version_t>(buffer, object.version());
+                append<osm_changeset_id_t>(buffer, object.changeset());
+                append<int64_t>(buffer, object.timestamp());
+                append<int64_t>(buffer, object.endtime());
+                append<osm_user_id_t>(buffer, object.uid());
+                append<uint8_t>(buffer, object.visible());
+                append_string(buffer, object.user());
+
+                append<uint32_t>(buffer, object.tags().size());
+                BOOST_FOREACH(const Osmium::OSM::Tag& tag, object.tags()) {
+                    append_string(buffer, tag.key());
+                    append_string(buffer, tag.value());
+                }
+
+                switch (object.type()) {
+                    case NODE: {
+                        const Osmium::OSM::Position position = static_cast<const Osmium::OSM::Node&>(object).position();
+                        append<int32_t>(buffer, position.x());
+                        append<int32_t>(buffer, position.y());
+                        break;
+                    }
+                    case WAY: {
+                        const Osmium::OSM::WayNodeList& nodes = static_cast<const Osmium::OSM::Way&>(object).nodes();
+                        BOOST_FOREACH(const Osmium::OSM::WayNode& way_node, nodes) {
+                            append<osm_object_id_t>(buffer, way_node.ref());
+                            append<int32_t>(buffer, way_node.position().x());
+                            append<int32_t>(buffer, way_node.position().y());
+                        }
+                        break;
+                    }
+                    case RELATION: {
+                        const Osmium::OSM::RelationMemberList& members = static_cast<const Osmium::OSM::Relation&>(object).members();
+                        BOOST_FOREACH(const Osmium::OSM::RelationMember& member, members) {
+                            append<char>(buffer, member.type());
+                            append<osm_object_id_t>(buffer, member.ref());
+                            append_string(buffer, member.role());
+                        }
+                        break;
+                    }
+                    default:
+                        throw std::runtime_error("can't write this object type to spill file");
+                }
+            }
+
+            /**
+             * Create an object from the serialized data and move the
+             * data pointer past it.
+             */
+            static shared_ptr<Osmium::OSM::Object const> deserialize(const char*& data) {
+                shared_ptr<Osmium::OSM::Object> object;
+
+                const uint8_t type = extract<uint8_t>(data);
+                const uint32_t count = extract<uint32_t>(data);
+                switch (type) {
+                    case NODE:
+                        object = make_shared<Osmium::OSM::Node>();
+                        break;
+                    case WAY:
+                        object = make_shared<Osmium::OSM::Way>(count);
+                        break;
+                    case RELATION:
+                        object = make_shared<Osmium::OSM::Relation>();
+                        break;
+                    default:
+                        throw std::runtime_error("unknown object type in spill file");
+                }
+
+                object->id(extract<osm_object_id_t>(data));
+                object->version(extract<osm_version_t>(data));
+                object->changeset(extract<osm_changeset_id_t>(data));
+                object->timestamp(static_cast<time_t>(extract<int64_t>(data)));
+                object->endtime(static_cast<time_t>(extract<int64_t>(data)));
+                object->uid(extract<osm_user_id_t>(data));
+                object->visible(extract<uint8_t>(data) != 0);
+                object->user(extract_string(data).c_str());
+
+                const uint32_t ntags = extract<uint32_t>(data);
+                for (uint32_t i = 0; i < ntags; ++i) {
+                    const std::string key = extract_string(data);
+                    const std::string value = extract_string(data);
+                    object->tags().add(key.c_str(), value.c_str());
+                }
+
+                switch (object->type()) {
+                    case NODE: {
+                        const int32_t x = extract<int32_t>(data);
+                        const int32_t y = extract<int32_t>(data);
+                        static_cast<Osmium::OSM::Node&>(*object).position(Osmium::OSM::Position(x, y));
+                        break;
+                    }
+                    case WAY: {
+                        Osmium::OSM::WayNodeList& nodes = static_cast<Osmium::OSM::Way&>(*object).nodes();
+                        for (uint32_t i = 0; i < count; ++i) {
+                            const osm_object_id_t ref = extract<osm_object_id_t>(data);
+                            const int32_t x = extract<int32_t>(data);
+                            const int32_t y = extract<int32_t>(data);
+                            nodes.add(Osmium::OSM::WayNode(ref, Osmium::OSM::Position(x, y)));
+                        }
+                        break;
+                    }
+                    case RELATION: {
+                        Osmium::OSM::Relation& relation = static_cast<Osmium::OSM::Relation&>(*object);
+                        for (uint32_t i = 0; i < count; ++i) {
+                            const char type = extract<char>(data);
+                            const osm_object_id_t ref = extract<osm_object_id_t>(data);
+                            const std::string role = extract_string(data);
+                            relation.add_member(type, ref, role.c_str());
+                        }
+                        break;
+                    }
+                    default:
+                        break;
+                }
+
+                return object;
+            }
+
+        private:
+
+            FILE* m_file;
+
+            /// Number of bytes written so far, also the offset of the next object.
+            offset_t m_size;
+
+            /// Number of objects written so far.
+            uint64_t m_count;
+
+            /// Is the file position at the end of the file?
+            bool m_at_end;
+
+            /// Buffer used for serializing and deserializing an object.
+            std::string m_buffer;
+
+        }; // class SpillFile
+
+    } // namespace Relations
+
+} // namespace Osmium
+
+#endif // OSMIUM_RELATIONS_SPILL_FILE_HPP
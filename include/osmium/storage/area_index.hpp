@@ -0,0 +1,624 @@
+#ifndef OSMIUM_STORAGE_AREA_INDEX_HPP
+#define OSMIUM_STORAGE_AREA_INDEX_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <geos/geom/CoordinateSequence.h>
+#include <geos/geom/LineString.h>
+#include <geos/geom/MultiPolygon.h>
+#include <geos/geom/Polygon.h>
+
+#include <osmium/smart_ptr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/position.hpp>
+#include <osmium/geometry/multipolygon.hpp>
+
+namespace Osmium {
+
+    namespace Storage {
+
+        /**
+         * Spatial index over areas answering the question which areas
+         * contain a point.
+         *
+         * The bounding boxes of the areas are kept in a packed R-tree
+         * that is bulk loaded with the Sort-Tile-Recursive algorithm:
+         * the areas are sorted into vertical slices by the x coordinate
+         * of their center, each slice is sorted by y and cut into leaf
+         * nodes of node_size entries. The upper levels are built by
+         * grouping node_size consecutive nodes of the level below. The
+         * tree is stored level by level in one array, the children of a
+         * node are found by index calculation.
+         *
+         * Areas found in the tree are checked with the crossing number
+         * (even-odd) test against all their rings, so points in holes
+         * are not inside. Points exactly on the boundary may or may not
+         * be inside. All calculations are done in the integer
+         * coordinates of Position.
+         *
+         * The index is also a handler: Put it after the
+         * MultiPolygon::Assembler to add all areas, it is built in
+         * final(). Or call add() and build() directly. Areas created from
+         * multipolygon relations need their GEOS geometry only while they
+         * are added.
+         *
+         * Once built, the index doesn't change and find() can be called
+         * from several threads at the same time. It can be written to a
+         * file with dump() and used from there without loading it into
+         * memory, the file is mapped with mmap(). The file is in native
+         * byte order.
+         */
+        class AreaIndex : public Osmium::Handler::Base {
+
+            /// Bounding box in Position coordinates.
+            struct Box {
+                int32_t min_x;
+                int32_t min_y;
+                int32_t max_x;
+                int32_t max_y;
+            };
+
+            struct Item {
+                osm_object_id_t id;
+                uint32_t first_ring;
+                uint32_t ring_count;
+            };
+
+            struct Ring {
+                uint64_t first_point;
+                uint64_t point_count;
+            };
+
+            struct Point {
+                int32_t x;
+                int32_t y;
+            };
+
+            struct Header {
+                char magic[8];
+                uint64_t level_count;
+                uint64_t box_count;
+                uint64_t item_count;
+                uint64_t ring_count;
+                uint64_t point_count;
+            };
+
+            /// Sort order of boxes by the x or y coordinate of their center.
+            class CompareCenter {
+
+            public:
+
+                CompareCenter(const std::vector<Box>& boxes, bool by_x) :
+                    m_boxes(boxes),
+                    m_by_x(by_x) {
+                }
+
+                bool operator()(uint32_t a, uint32_t b) const {
+                    return center(m_boxes[a]) < center(m_boxes[b]);
+                }
+
+            private:
+
+                int64_t center(const Box& box) const {
+                    return m_by_x ? static_cast<int64_t>(box.min_x) + box.max_x
+                                  : static_cast<int64_t>(box.min_y) + box.max_y;
+                }
+
+                const std::vector<Box>& m_boxes;
+                const bool m_by_x;
+
+            }; // class CompareCenter
+
+        public:
+
+            /// Number of children of each node in the R-tree.
+            static const uint32_t node_size = 16;
+
+            /// Maximum number of levels of the R-tree.
+            static const uint32_t max_levels = 16;
+
+            /**
+             * Create an empty index. Add areas with add() or area() and
+             * build the index with build() or final().
+             */
+            AreaIndex() :
+                Osmium::Handler::Base(),
+                m_built(false),
+                m_skipped(0),
+                m_level_ends(),
+                m_boxes(),
+                m_items(),
+                m_rings(),
+                m_points(),
+                m_mapping(NULL),
+                m_mapping_size(0) {
+                set_view();
+            }
+
+            /**
+             * Open an index written with dump(). The file is mapped into
+             * memory and the index can be used immediately.
+             *
+             * @throws std::runtime_error if the file can't be read or is no index file.
+             */
+            AreaIndex(const std::string& filename) :
+                Osmium::Handler::Base(),
+                m_built(true),
+                m_skipped(0),
+                m_level_ends(),
+                m_boxes(),
+                m_items(),
+                m_rings(),
+                m_points(),
+                m_mapping(NULL),
+                m_mapping_size(0) {
+                map_file(filename);
+            }
+
+            ~AreaIndex() {
+                if (m_mapping) {
+                    munmap(m_mapping, m_mapping_size);
+                }
+            }
+
+            void area(const shared_ptr<Osmium::OSM::Area>& area) {
+                add(*area);
+            }
+
+            void final() {
+                build();
+            }
+
+            /**
+             * Add an area to the index. Areas without a geometry are
+             * not added and counted in skipped().
+             *
+             * @throws std::logic_error if the index was already built.
+             */
+            void add(const Osmium::OSM::Area& area) {
+                if (m_built) {
+                    throw std::logic_error("can't add to area index after it was built");
+                }
+
+                Item item = { area.id(), static_cast<uint32_t>(m_rings.size()), 0 };
+                if (area.from_way()) {
+                    const Osmium::OSM::WayNodeList& nodes = area.nodes();
+                    if (nodes.size() < 4 || !nodes.has_position() || !nodes.is_closed()) {
+                        ++m_skipped;
+                        return;
+                    }
+                    const uint64_t first_point = m_points.size();
+                    for (Osmium::OSM::WayNodeList::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+                        add_point(it->position().x(), it->position().y());
+                    }
+                    add_ring(first_point);
+                    item.ring_count = 1;
+                } else {
+                    try {
+                        const geos::geom::MultiPolygon* multipolygon = Osmium::Geometry::MultiPolygon(area).borrow_geos_geometry();
+                        for (size_t i = 0; i < multipolygon->getNumGeometries(); ++i) {
+                            const geos::geom::Polygon* polygon = dynamic_cast<const geos::geom::Polygon*>(multipolygon->getGeometryN(i));
+                            add_ring(polygon->getExteriorRing());
+                            for (size_t j = 0; j < polygon->getNumInteriorRing(); ++j) {
+                                add_ring(polygon->getInteriorRingN(j));
+                            }
+                        }
+                    } catch (Osmium::Geometry::NoGeometry&) {
+                        ++m_skipped;
+                        return;
+                    }
+                    item.ring_count = m_rings.size() - item.first_ring;
+                    if (item.ring_count == 0) {
+                        ++m_skipped;
+                        return;
+                    }
+                }
+
+                m_items.push_back(item);
+                m_boxes.push_back(bounding_box(item));
+            }
+
+            /**
+             * Build the R-tree. After this no more areas can be added.
+             * Calling it again does nothing.
+             */
+            void build() {
+                if (m_built) {
+                    return;
+                }
+
+                sort_tile_recursive();
+
+                uint64_t level_begin = 0;
+                uint64_t level_end = m_boxes.size();
+                m_level_ends.push_back(level_end);
+                while (level_end - level_begin > 1) {
+                    for (uint64_t i = level_begin; i < level_end; i += node_size) {
+                        Box box = m_boxes[i];
+                        for (uint64_t j = i + 1; j < std::min(i + node_size, level_end); ++j) {
+                            extend(box, m_boxes[j]);
+                        }
+                        m_boxes.push_back(box);
+                    }
+                    level_begin = level_end;
+                    level_end = m_boxes.size();
+                    m_level_ends.push_back(level_end);
+                }
+
+                if (m_level_ends.size() > max_levels) {
+                    throw std::length_error("too many areas for area index");
+                }
+
+                m_built = true;
+                set_view();
+            }
+
+            /// Has the index been built?
+            bool built() const {
+                return m_built;
+            }
+
+            /// Number of areas in the index.
+            uint64_t size() const {
+                return m_view.item_count;
+            }
+
+            /// Number of areas not added because they have no geometry.
+            uint64_t skipped() const {
+                return m_skipped;
+            }
+
+            /**
+             * Find all areas containing a position.
+             *
+             * @param position The position.
+             * @param ids The ids of the areas found are appended here.
+             * @returns Number of areas found.
+             * @throws std::logic_error if the index was not built.
+             */
+            size_t find(const Osmium::OSM::Position& position, std::vector<osm_object_id_t>& ids) const {
+                if (!m_built) {
+                    throw std::logic_error("area index not built");
+                }
+                if (m_view.item_count == 0 || !position.defined()) {
+                    return 0;
+                }
+
+                const int32_t x = position.x();
+                const int32_t y = position.y();
+                size_t count = 0;
+
+                // stack of (level, node index) to visit, starting with the root
+                uint64_t stack[max_levels * node_size][2];
+                size_t top = 0;
+                stack[top][0] = m_view.level_count - 1;
+                stack[top][1] = m_view.box_count - 1;
+                ++top;
+
+                while (top > 0) {
+                    --top;
+                    const uint64_t level = stack[top][0];
+                    const uint64_t index = stack[top][1];
+                    if (!contains(m_view.boxes[index], x, y)) {
+                        continue;
+                    }
+
+                    if (level == 0) {
+                        if (contains(m_view.items[index], x, y)) {
+                            ids.push_back(m_view.items[index].id);
+                            ++count;
+                        }
+                        continue;
+                    }
+
+                    const uint64_t first_child = level_begin(level - 1) + (index - level_begin(level)) * node_size;
+                    const uint64_t end_child = std::min(first_child + node_size, m_view.level_ends[level - 1]);
+                    for (uint64_t child = first_child; child < end_child; ++child) {
+                        stack[top][0] = level - 1;
+                        stack[top][1] = child;
+                        ++top;
+                    }
+                }
+
+                return count;
+            }
+
+            /**
+             * Write the index to a file that can be opened with the
+             * AreaIndex(filename) constructor.
+             *
+             * @throws std::logic_error if the index was not built.
+             * @throws std::runtime_error if the file can't be written.
+             */
+            void dump(const std::string& filename) const {
+                if (!m_built) {
+                    throw std::logic_error("area index not built");
+                }
+
+                FILE* file = fopen(filename.c_str(), "wb");
+                if (!file) {
+                    throw std::runtime_error(std::string("can't open area index file '") + filename + "': " + strerror(errno));
+                }
+
+                Header header;
+                memcpy(header.magic, file_magic(), sizeof(header.magic));
+                header.level_count = m_view.level_count;
+                header.box_count = m_view.box_count;
+                header.item_count = m_view.item_count;
+                header.ring_count = m_view.ring_count;
+                header.point_count = m_view.point_count;
+
+                const bool ok = write(file, &header, sizeof(Header), 1) &&
+                                write(file, m_view.level_ends, sizeof(uint64_t), m_view.level_count) &&
+                                write(file, m_view.boxes, sizeof(Box), m_view.box_count) &&
+                                write(file, m_view.items, sizeof(Item), m_view.item_count) &&
+                                write(file, m_view.rings, sizeof(Ring), m_view.ring_count) &&
+                                write(file, m_view.points, sizeof(Point), m_view.point_count);
+
+                if (fclose(file) != 0 || !ok) {
+                    throw std::runtime_error(std::string("can't write area index file '") + filename + "': " + strerror(errno));
+                }
+            }
+
+        private:
+
+            // The index owns m_mapping and m_view points into its own
+            // vectors, so it must not be copied. Handler::Base is already
+            // noncopyable, this makes it explicit.
+            AreaIndex(const AreaIndex&);
+            AreaIndex& operator=(const AreaIndex&);
+
+            static const char* file_magic() {
+                return "OSMAIDX1";
+            }
+
+            void add_point(int32_t x, int32_t y) {
+                const Point point = { x, y };
+                m_points.push_back(point);
+            }
+
+            void add_ring(uint64_t first_point) {
+                const Ring ring = { first_point, m_points.size() - first_point };
+                m_rings.push_back(ring);
+            }
+
+            void add_ring(const geos::geom::LineString* line_string) {
+                const geos::geom::CoordinateSequence* coordinates = line_string->getCoordinatesRO();
+                const uint64_t first_point = m_points.size();
+                for (size_t i = 0; i < coordinates->getSize(); ++i) {
+                    const Osmium::OSM::Position position(coordinates->getAt(i).x, coordinates->getAt(i).y);
+                    add_point(position.x(), position.y());
+                }
+                add_ring(first_point);
+            }
+
+            static void extend(Box& box, const Box& other) {
+                box.min_x = std::min(box.min_x, other.min_x);
+                box.min_y = std::min(box.min_y, other.min_y);
+                box.max_x = std::max(box.max_x, other.max_x);
+                box.max_y = std::max(box.max_y, other.max_y);
+            }
+
+            Box bounding_box(const Item& item) const {
+                const Point& first = m_points[m_rings[item.first_ring].first_point];
+                Box box = { first.x, first.y, first.x, first.y };
+                for (uint32_t r = item.first_ring; r < item.first_ring + item.ring_count; ++r) {
+                    const Ring& ring = m_rings[r];
+                    for (uint64_t p = ring.first_point; p < ring.first_point + ring.point_count; ++p) {
+                        const Box point_box = { m_points[p].x, m_points[p].y, m_points[p].x, m_points[p].y };
+                        extend(box, point_box);
+                    }
+                }
+                return box;
+            }
+
+            /**
+             * Reorder the items (and their boxes) in Sort-Tile-Recursive
+             * order.
+             */
+            void sort_tile_recursive() {
+                const uint32_t count = m_items.size();
+                std::vector<uint32_t> order(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    order[i] = i;
+                }
+
+                const uint64_t leaf_nodes = (count + node_size - 1) / node_size;
+                const uint64_t slices = static_cast<uint64_t>(std::ceil(std::sqrt(static_cast<double>(leaf_nodes))));
+                const uint64_t slice_size = std::max(slices, static_cast<uint64_t>(1)) * node_size;
+
+                std::sort(order.begin(), order.end(), CompareCenter(m_boxes, true));
+                for (uint64_t i = 0; i < count; i += slice_size) {
+                    std::sort(order.begin() + i, order.begin() + std::min(i + slice_size, static_cast<uint64_t>(count)), CompareCenter(m_boxes, false));
+                }
+
+                std::vector<Item> items;
+                std::vector<Box> boxes;
+                items.reserve(count);
+                boxes.reserve(count + count / (node_size - 1) + max_levels);
+                for (uint32_t i = 0; i < count; ++i) {
+                    items.push_back(m_items[order[i]]);
+                    boxes.push_back(m_boxes[order[i]]);
+                }
+                m_items.swap(items);
+                m_boxes.swap(boxes);
+            }
+
+            uint64_t level_begin(uint64_t level) const {
+                return level == 0 ? 0 : m_view.level_ends[level - 1];
+            }
+
+            static bool contains(const Box& box, int32_t x, int32_t y) {
+                return x >= box.min_x && x <= box.max_x && y >= box.min_y && y <= box.max_y;
+            }
+
+            /**
+             * Crossing number test: count how many ring segments a ray
+             * from the point to the east crosses.
+             */
+            bool contains(const Item& item, int32_t x, int32_t y) const {
+                bool inside = false;
+                for (uint32_t r = item.first_ring; r < item.first_ring + item.ring_count; ++r) {
+                    const Point* points = m_view.points + m_view.rings[r].first_point;
+                    const uint64_t point_count = m_view.rings[r].point_count;
+                    for (uint64_t i = 1; i < point_count; ++i) {
+                        const Point& a = points[i - 1];
+                        const Point& b = points[i];
+                        if ((a.y > y) != (b.y > y)) {
+                            // is the point left of the segment at height y?
+                            const int64_t lhs = (static_cast<int64_t>(x) - a.x) * (static_cast<int64_t>(b.y) - a.y);
+                            const int64_t rhs = (static_cast<int64_t>(b.x) - a.x) * (static_cast<int64_t>(y) - a.y);
+                            if (b.y > a.y ? lhs < rhs : lhs > rhs) {
+                                inside = !inside;
+                            }
+                        }
+                    }
+                }
+                return inside;
+            }
+
+            static bool write(FILE* file, const void* data, size_t size, uint64_t count) {
+                return count == 0 || fwrite(data, size, count, file) == count;
+            }
+
+            /// Point the view to the in-memory data.
+            void set_view() {
+                m_view.level_count = m_level_ends.size();
+                m_view.box_count = m_boxes.size();
+                m_view.item_count = m_items.size();
+                m_view.ring_count = m_rings.size();
+                m_view.point_count = m_points.size();
+                m_view.level_ends = m_level_ends.empty() ? NULL : &m_level_ends[0];
+                m_view.boxes = m_boxes.empty() ? NULL : &m_boxes[0];
+                m_view.items = m_items.empty() ? NULL : &m_items[0];
+                m_view.rings = m_rings.empty() ? NULL : &m_rings[0];
+                m_view.points = m_points.empty() ? NULL : &m_points[0];
+            }
+
+            /// Map an index file and point the view to it.
+            void map_file(const std::string& filename) {
+                const int fd = open(filename.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    throw std::runtime_error(std::string("can't open area index file '") + filename + "': " + strerror(errno));
+                }
+
+                struct stat s;
+                if (fstat(fd, &s) < 0 || static_cast<uint64_t>(s.st_size) < sizeof(Header)) {
+                    ::close(fd);
+                    throw std::runtime_error(std::string("not an area index file: '") + filename + "'");
+                }
+
+                m_mapping_size = s.st_size;
+                m_mapping = mmap(NULL, m_mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (m_mapping == MAP_FAILED) {
+                    m_mapping = NULL;
+                    throw std::runtime_error(std::string("can't map area index file '") + filename + "': " + strerror(errno));
+                }
+
+                const char* data = static_cast<const char*>(m_mapping);
+                const Header* header = reinterpret_cast<const Header*>(data);
+                const uint64_t size = sizeof(Header) +
+                                      header->level_count * sizeof(uint64_t) +
+                                      header->box_count * sizeof(Box) +
+                                      header->item_count * sizeof(Item) +
+                                      header->ring_count * sizeof(Ring) +
+                                      header->point_count * sizeof(Point);
+                if (memcmp(header->magic, file_magic(), sizeof(header->magic)) != 0 || size != m_mapping_size) {
+                    munmap(m_mapping, m_mapping_size);
+                    m_mapping = NULL;
+                    throw std::runtime_error(std::string("not an area index file: '") + filename + "'");
+                }
+
+                m_view.level_count = header->level_count;
+                m_view.box_count = header->box_count;
+                m_view.item_count = header->item_count;
+                m_view.ring_count = header->ring_count;
+                m_view.point_count = header->point_count;
+
+                data += sizeof(Header);
+                m_view.level_ends = reinterpret_cast<const uint64_t*>(data);
+                data += m_view.level_count * sizeof(uint64_t);
+                m_view.boxes = reinterpret_cast<const Box*>(data);
+                data += m_view.box_count * sizeof(Box);
+                m_view.items = reinterpret_cast<const Item*>(data);
+                data += m_view.item_count * sizeof(Item);
+                m_view.rings = reinterpret_cast<const Ring*>(data);
+                data += m_view.ring_count * sizeof(Ring);
+                m_view.points = reinterpret_cast<const Point*>(data);
+            }
+
+            bool m_built;
+            uint64_t m_skipped;
+
+            /**
+             * Data of the index while it is built in memory. The R-tree
+             * boxes are stored level by level, starting with the boxes
+             * of the areas. m_level_ends contains the index after the
+             * last box of each level.
+             */
+            std::vector<uint64_t> m_level_ends;
+            std::vector<Box> m_boxes;
+            std::vector<Item> m_items;
+            std::vector<Ring> m_rings;
+            std::vector<Point> m_points;
+
+            /// Pointers to the data used for queries, in memory or in the mapped file.
+            struct View {
+                uint64_t level_count;
+                uint64_t box_count;
+                uint64_t item_count;
+                uint64_t ring_count;
+                uint64_t point_count;
+                const uint64_t* level_ends;
+                const Box* boxes;
+                const Item* items;
+                const Ring* rings;
+                const Point* points;
+            } m_view;
+
+            void* m_mapping;
+            size_t m_mapping_size;
+
+        }; // class AreaIndex
+
+    } // namespace Storage
+
+} // namespace Osmium
+
+#endif // OSMIUM_STORAGE_AREA_INDEX_HPP
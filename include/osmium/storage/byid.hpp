@@ -70,6 +70,25 @@ namespace Osmium {
                 /// Retrieve value by key. Does not check for overflow or empty fields.
                 virtual const TValue operator[](const uint64_t id) const = 0;
 
+                /**
+                * Hint that the value with the given id will be read soon.
+                * Storage classes keeping their data in one flat array use
+                * this to prefetch the memory holding the value. The default
+                * implementation does nothing.
+                */
+                virtual void prefetch(const uint64_t /*id*/) const {
+                }
+
+                /**
+                * Called after all values have been set and before the first
+                * value is read. Storage classes that need to prepare their
+                * data for lookups or that have to synchronize writes from
+                * several threads do that here. The default implementation
+                * does nothing.
+                */
+                virtual void writes_complete() {
+                }
+
                 /**
                 * Get the approximate number of items in the storage. The storage
                 * might allocate memory in blocks, so this size might not be
@@ -0,0 +1,339 @@
+#ifndef OSMIUM_STORAGE_BYID_CACHED_FILE_HPP
+#define OSMIUM_STORAGE_BYID_CACHED_FILE_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <cstdio>
+#include <fcntl.h>
+#include <new>
+#include <string>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <vector>
+
+#include <osmium/storage/byid.hpp>
+
+namespace Osmium {
+
+    namespace Storage {
+
+        namespace ById {
+
+            /**
+            * CachedFile stores data in a file and keeps a fixed number of
+            * pages of it in memory. Unlike MmapFile, which leaves paging to
+            * the kernel, the memory used is capped by the budget given in
+            * the constructor. Lookups that miss the cache read the page with
+            * pread(). Modified pages are written back with pwrite() when they
+            * are evicted, or when writes_complete() or flush() is called.
+            *
+            * Pages to evict are chosen with the CLOCK (second chance)
+            * algorithm, an approximation of LRU that only needs one
+            * "referenced" flag per page.
+            *
+            * This works best with lookups that have some locality, for
+            * instance when used with the BatchedCoordinatesForWays handler,
+            * which looks up node locations sorted by ID.
+            *
+            * Fields beyond the end of the file read as TValue(), fields in
+            * holes of the file read as zero bytes.
+            *
+            * This class is not thread safe, not even for lookups.
+            *
+            * @tparam TValue Type of the stored values.
+            * @tparam page_bits Each page holds 2^page_bits values.
+            */
+            template <typename TValue, int page_bits = 12>
+            class CachedFile : public Osmium::Storage::ById::Base<TValue> {
+
+                static const uint32_t no_frame = static_cast<uint32_t>(-1);
+
+                struct frame_t {
+                    uint64_t page;
+                    bool referenced;
+                    bool dirty;
+                };
+
+            public:
+
+                static const uint64_t page_size = 1ULL << page_bits;
+
+                /**
+                * Create storage backed by a file. If filename is empty, a
+                * temporary file will be created.
+                *
+                * @param memory_budget Number of bytes to use for cached pages. At least one page is always cached.
+                * @param filename The filename (including the path) for the storage.
+                * @param remove Should the file be removed after use?
+                * @exception std::bad_alloc Thrown when there is not enough memory or some other problem.
+                */
+                CachedFile(const uint64_t memory_budget, const std::string& filename="", bool remove=true) :
+                    Base<TValue>(),
+                    m_fd(-1),
+                    m_file_pages(0),
+                    m_num_frames(memory_budget / (page_size * sizeof(TValue))),
+                    m_frames(),
+                    m_data(),
+                    m_page_table(),
+                    m_clock_hand(0),
+                    m_hits(0),
+                    m_misses(0),
+                    m_writebacks(0) {
+                    if (m_num_frames == 0) {
+                        m_num_frames = 1;
+                    }
+
+                    if (filename == "") {
+                        FILE* file = tmpfile();
+                        if (!file) {
+                            throw std::bad_alloc();
+                        }
+                        m_fd = dup(fileno(file));
+                        fclose(file);
+                    } else {
+                        m_fd = open(filename.c_str(), O_RDWR | O_CREAT, 0600);
+                    }
+
+                    if (m_fd < 0) {
+                        throw std::bad_alloc();
+                    }
+
+                    if (remove && filename != "") {
+                        if (unlink(filename.c_str()) < 0) {
+                            // XXX what to do here?
+                        }
+                    }
+
+                    struct stat s;
+                    if (fstat(m_fd, &s) < 0) {
+                        throw std::bad_alloc();
+                    }
+                    m_file_pages = (s.st_size + page_size * sizeof(TValue) - 1) / (page_size * sizeof(TValue));
+
+                    m_frames.reserve(m_num_frames);
+                    m_data.resize(m_num_frames * page_size);
+                }
+
+                ~CachedFile() {
+                    try {
+                        clear();
+                    } catch (...) {
+                        // ignore errors writing back pages on destruction
+                    }
+                }
+
+                void set(const uint64_t id, const TValue value) {
+                    const uint32_t frame = get_frame(id >> page_bits);
+                    m_frames[frame].dirty = true;
+                    m_data[frame * page_size + (id & (page_size - 1))] = value;
+                }
+
+                const TValue operator[](const uint64_t id) const {
+                    const uint32_t frame = get_frame(id >> page_bits);
+                    return m_data[frame * page_size + (id & (page_size - 1))];
+                }
+
+                /**
+                * Write back all modified pages. The pages stay in the cache.
+                */
+                void writes_complete() {
+                    flush();
+                }
+
+                /**
+                * Write back all modified pages. The pages stay in the cache.
+                * @exception std::bad_alloc Thrown when writing fails.
+                */
+                void flush() {
+                    for (uint32_t frame = 0; frame < m_frames.size(); ++frame) {
+                        if (m_frames[frame].dirty) {
+                            write_page(frame);
+                        }
+                    }
+                }
+
+                uint64_t size() const {
+                    uint64_t pages = m_file_pages;
+                    for (uint32_t frame = 0; frame < m_frames.size(); ++frame) {
+                        if (m_frames[frame].page >= pages) {
+                            pages = m_frames[frame].page + 1;
+                        }
+                    }
+                    return pages * page_size;
+                }
+
+                uint64_t used_memory() const {
+                    return m_data.size() * sizeof(TValue) + m_frames.capacity() * sizeof(frame_t) + m_page_table.capacity() * sizeof(uint32_t);
+                }
+
+                void clear() {
+                    if (m_fd >= 0) {
+                        flush();
+                        close(m_fd);
+                        m_fd = -1;
+                    }
+                    std::vector<frame_t>().swap(m_frames);
+                    std::vector<TValue>().swap(m_data);
+                    std::vector<uint32_t>().swap(m_page_table);
+                }
+
+                /// Number of lookups and sets that found their page in the cache.
+                uint64_t hits() const {
+                    return m_hits;
+                }
+
+                /// Number of lookups and sets that had to load a page.
+                uint64_t misses() const {
+                    return m_misses;
+                }
+
+                /// Number of pages written back to the file.
+                uint64_t writebacks() const {
+                    return m_writebacks;
+                }
+
+            private:
+
+                int m_fd;
+
+                /// Number of pages in the file.
+                mutable uint64_t m_file_pages;
+
+                /// Maximum number of pages in the cache.
+                uint64_t m_num_frames;
+
+                mutable std::vector<frame_t> m_frames;
+
+                /// Contents of all cached pages, one after the other.
+                mutable std::vector<TValue> m_data;
+
+                /// Maps page numbers to frames.
+                mutable std::vector<uint32_t> m_page_table;
+
+                mutable uint32_t m_clock_hand;
+
+                mutable uint64_t m_hits;
+                mutable uint64_t m_misses;
+                mutable uint64_t m_writebacks;
+
+                /**
+                * Return the frame holding the given page, loading it if
+                * necessary.
+                */
+                uint32_t get_frame(const uint64_t page) const {
+                    if (page < m_page_table.size() && m_page_table[page] != no_frame) {
+                        ++m_hits;
+                        const uint32_t frame = m_page_table[page];
+                        m_frames[frame].referenced = true;
+                        return frame;
+                    }
+
+                    ++m_misses;
+                    if (page >= m_page_table.size()) {
+                        m_page_table.resize(page + 1, no_frame);
+                    }
+
+                    uint32_t frame;
+                    if (m_frames.size() < m_num_frames) {
+                        frame = m_frames.size();
+                        m_frames.push_back(frame_t());
+                    } else {
+                        frame = find_victim();
+                        if (m_frames[frame].dirty) {
+                            write_page(frame);
+                        }
+                        m_page_table[m_frames[frame].page] = no_frame;
+                    }
+
+                    m_frames[frame].page = page;
+                    m_frames[frame].referenced = true;
+                    m_frames[frame].dirty = false;
+                    read_page(frame);
+                    m_page_table[page] = frame;
+                    return frame;
+                }
+
+                /**
+                * Move the clock hand to the next frame that was not
+                * referenced since the hand last passed it, clearing the
+                * referenced flags on the way.
+                */
+                uint32_t find_victim() const {
+                    while (true) {
+                        const uint32_t frame = m_clock_hand;
+                        m_clock_hand = (m_clock_hand + 1) % m_frames.size();
+                        if (!m_frames[frame].referenced) {
+                            return frame;
+                        }
+                        m_frames[frame].referenced = false;
+                    }
+                }
+
+                void read_page(const uint32_t frame) const {
+                    TValue* data = &m_data[frame * page_size];
+                    const uint64_t page = m_frames[frame].page;
+                    if (page < m_file_pages) {
+                        const size_t bytes = page_size * sizeof(TValue);
+                        const ssize_t length = pread(m_fd, data, bytes, page * bytes);
+                        if (length < 0) {
+                            throw std::bad_alloc();
+                        }
+                        // the last page in the file might be short
+                        for (uint64_t i = length / sizeof(TValue); i < page_size; ++i) {
+                            data[i] = TValue();
+                        }
+                    } else {
+                        for (uint64_t i = 0; i < page_size; ++i) {
+                            data[i] = TValue();
+                        }
+                    }
+                }
+
+                void write_page(const uint32_t frame) const {
+                    const size_t bytes = page_size * sizeof(TValue);
+                    const uint64_t page = m_frames[frame].page;
+                    if (pwrite(m_fd, &m_data[frame * page_size], bytes, page * bytes) != static_cast<ssize_t>(bytes)) {
+                        throw std::bad_alloc();
+                    }
+                    if (page >= m_file_pages) {
+                        m_file_pages = page + 1;
+                    }
+                    m_frames[frame].dirty = false;
+                    ++m_writebacks;
+                }
+
+            }; // class CachedFile
+
+            template <typename TValue, int page_bits>
+            const uint32_t CachedFile<TValue, page_bits>::no_frame;
+
+            template <typename TValue, int page_bits>
+            const uint64_t CachedFile<TValue, page_bits>::page_size;
+
+        } // namespace ById
+
+    } // namespace Storage
+
+} // namespace Osmium
+
+#endif // OSMIUM_STORAGE_BYID_CACHED_FILE_HPP
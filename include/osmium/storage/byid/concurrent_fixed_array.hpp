@@ -0,0 +1,151 @@
+#ifndef OSMIUM_STORAGE_BYID_CONCURRENT_FIXED_ARRAY_HPP
+#define OSMIUM_STORAGE_BYID_CONCURRENT_FIXED_ARRAY_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#ifdef __linux__
+
+#include <cassert>
+#include <new>
+#include <sys/mman.h>
+#include <boost/atomic.hpp>
+
+#include <osmium/storage/byid.hpp>
+
+namespace Osmium {
+
+    namespace Storage {
+
+        namespace ById {
+
+            /**
+            * ConcurrentFixedArray stores data in one large array like
+            * FixedArray, but it can be filled from several threads at once.
+            *
+            * The array is an anonymous mapping reserved for the maximum ID
+            * given in the constructor. The kernel only allocates pages that
+            * are actually written to, so reserving space for the whole
+            * planet is cheap as long as the IDs are not spread out evenly.
+            *
+            * Use in two phases:
+            *
+            * 1. Any number of threads call set() concurrently. Each ID must
+            *    be set by only one thread. No locks are taken, each set()
+            *    is a plain store into its own slot.
+            * 2. After all writing threads are done (joined), call
+            *    writes_complete() once. Afterwards any number of threads
+            *    can call operator[] without any synchronization.
+            *
+            * Fields that were never set read as zero bytes, not as TValue().
+            *
+            * There is no range checking on accessing the store.
+            */
+            template <typename TValue>
+            class ConcurrentFixedArray : public Osmium::Storage::ById::Base<TValue> {
+
+            public:
+
+                /**
+                * Constructor.
+                *
+                * @param max_id One larger than the largest ID you will ever have.
+                * @exception std::bad_alloc Thrown when the address space can not be reserved.
+                */
+                ConcurrentFixedArray(const uint64_t max_id) :
+                    Base<TValue>(),
+                    m_size(max_id),
+                    m_read_only(false) {
+                    m_items = static_cast<TValue*>(mmap(NULL, sizeof(TValue) * m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+                    if (m_items == MAP_FAILED) {
+                        throw std::bad_alloc();
+                    }
+                }
+
+                ~ConcurrentFixedArray() {
+                    clear();
+                }
+
+                /**
+                * Set the field with id to value. Can be called from several
+                * threads at the same time as long as they use different IDs.
+                */
+                void set(const uint64_t id, const TValue value) {
+                    assert(!m_read_only);
+                    m_items[id] = value;
+                }
+
+                const TValue operator[](const uint64_t id) const {
+                    return m_items[id];
+                }
+
+                void prefetch(const uint64_t id) const {
+#ifdef __GNUC__
+                    __builtin_prefetch(m_items + id);
+#endif
+                }
+
+                /**
+                * Phase barrier between the concurrent writes and the
+                * lookups. Call after all writing threads have finished.
+                */
+                void writes_complete() {
+                    boost::atomic_thread_fence(boost::memory_order_seq_cst);
+                    m_read_only = true;
+                }
+
+                uint64_t size() const {
+                    return m_size;
+                }
+
+                /// Returns the reserved size, only touched pages use physical memory.
+                uint64_t used_memory() const {
+                    return m_size * sizeof(TValue);
+                }
+
+                void clear() {
+                    if (m_items) {
+                        munmap(m_items, sizeof(TValue) * m_size);
+                        m_items = NULL;
+                    }
+                }
+
+            private:
+
+                uint64_t m_size;
+
+                TValue* m_items;
+
+                bool m_read_only;
+
+            }; // class ConcurrentFixedArray
+
+        } // namespace ById
+
+    } // namespace Storage
+
+} // namespace Osmium
+
+#else
+#  warning "Osmium::Storage::ById::ConcurrentFixedArray only works on Linux!"
+#endif // __linux__
+
+#endif // OSMIUM_STORAGE_BYID_CONCURRENT_FIXED_ARRAY_HPP
@@ -0,0 +1,189 @@
+#ifndef OSMIUM_STORAGE_BYID_CONCURRENT_PAGED_HPP
+#define OSMIUM_STORAGE_BYID_CONCURRENT_PAGED_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <boost/atomic.hpp>
+
+#include <osmium/storage/byid.hpp>
+
+namespace Osmium {
+
+    namespace Storage {
+
+        namespace ById {
+
+            /**
+            * ConcurrentPaged stores data in pages of 2^page_bits items,
+            * which are allocated when the first item in them is set. The
+            * page directory has a fixed size given by the maximum ID. This
+            * makes it a good fit for extracts where only some ID ranges
+            * are used.
+            *
+            * It can be filled from several threads at once:
+            *
+            * 1. Any number of threads call set() concurrently. Each ID must
+            *    be set by only one thread. A missing page is allocated by
+            *    the thread that needs it and installed with a single
+            *    compare-and-swap; if another thread was faster, its page is
+            *    used instead. No locks are taken.
+            * 2. After all writing threads are done (joined), call
+            *    writes_complete() once. Afterwards any number of threads
+            *    can call operator[] without any synchronization.
+            *
+            * Fields that were never set read as TValue().
+            *
+            * There is no range checking on accessing the store.
+            */
+            template <typename TValue, int page_bits = 16>
+            class ConcurrentPaged : public Osmium::Storage::ById::Base<TValue> {
+
+            public:
+
+                static const uint64_t page_size = 1ULL << page_bits;
+
+                /**
+                * Constructor.
+                *
+                * @param max_id One larger than the largest ID you will ever have.
+                * @exception std::bad_alloc Thrown when there is not enough memory.
+                */
+                ConcurrentPaged(const uint64_t max_id) :
+                    Base<TValue>(),
+                    m_num_pages((max_id + page_size - 1) >> page_bits),
+                    m_pages(new boost::atomic<TValue*>[m_num_pages]),
+                    m_allocated_pages(0),
+                    m_read_only(false) {
+                    for (uint64_t i = 0; i < m_num_pages; ++i) {
+                        m_pages[i].store(NULL, boost::memory_order_relaxed);
+                    }
+                }
+
+                ~ConcurrentPaged() {
+                    clear();
+                    delete[] m_pages;
+                }
+
+                /**
+                * Set the field with id to value. Can be called from several
+                * threads at the same time as long as they use different IDs.
+                *
+                * @exception std::bad_alloc Thrown when a new page can not be allocated.
+                */
+                void set(const uint64_t id, const TValue value) {
+                    assert(!m_read_only);
+                    boost::atomic<TValue*>& slot = m_pages[id >> page_bits];
+                    TValue* page = slot.load(boost::memory_order_acquire);
+                    if (!page) {
+                        page = install_page(slot);
+                    }
+                    page[id & (page_size - 1)] = value;
+                }
+
+                const TValue operator[](const uint64_t id) const {
+                    const TValue* page = m_pages[id >> page_bits].load(boost::memory_order_relaxed);
+                    if (!page) {
+                        return TValue();
+                    }
+                    return page[id & (page_size - 1)];
+                }
+
+                void prefetch(const uint64_t id) const {
+#ifdef __GNUC__
+                    const TValue* page = m_pages[id >> page_bits].load(boost::memory_order_relaxed);
+                    if (page) {
+                        __builtin_prefetch(page + (id & (page_size - 1)));
+                    }
+#endif
+                }
+
+                /**
+                * Phase barrier between the concurrent writes and the
+                * lookups. Call after all writing threads have finished.
+                */
+                void writes_complete() {
+                    boost::atomic_thread_fence(boost::memory_order_seq_cst);
+                    m_read_only = true;
+                }
+
+                uint64_t size() const {
+                    return m_num_pages * page_size;
+                }
+
+                uint64_t used_memory() const {
+                    return m_allocated_pages.load(boost::memory_order_relaxed) * page_size * sizeof(TValue) + m_num_pages * sizeof(TValue*);
+                }
+
+                void clear() {
+                    for (uint64_t i = 0; i < m_num_pages; ++i) {
+                        free(m_pages[i].exchange(NULL, boost::memory_order_relaxed));
+                    }
+                    m_allocated_pages.store(0, boost::memory_order_relaxed);
+                    m_read_only = false;
+                }
+
+            private:
+
+                /**
+                * Allocate a new page and try to install it in the given slot.
+                * Returns the page that ended up in the slot.
+                */
+                TValue* install_page(boost::atomic<TValue*>& slot) {
+                    TValue* new_page = static_cast<TValue*>(malloc(sizeof(TValue) * page_size));
+                    if (!new_page) {
+                        throw std::bad_alloc();
+                    }
+                    for (uint64_t i = 0; i < page_size; ++i) {
+                        new (new_page + i) TValue();
+                    }
+
+                    TValue* expected = NULL;
+                    if (slot.compare_exchange_strong(expected, new_page, boost::memory_order_acq_rel, boost::memory_order_acquire)) {
+                        m_allocated_pages.fetch_add(1, boost::memory_order_relaxed);
+                        return new_page;
+                    }
+
+                    // another thread installed a page first
+                    free(new_page);
+                    return expected;
+                }
+
+                const uint64_t m_num_pages;
+
+                boost::atomic<TValue*>* m_pages;
+
+                boost::atomic<uint64_t> m_allocated_pages;
+
+                bool m_read_only;
+
+            }; // class ConcurrentPaged
+
+        } // namespace ById
+
+    } // namespace Storage
+
+} // namespace Osmium
+
+#endif // OSMIUM_STORAGE_BYID_CONCURRENT_PAGED_HPP
@@ -83,6 +83,12 @@ namespace Osmium {
                     return m_items[id];
                 }
 
+                void prefetch(const uint64_t id) const {
+#ifdef __GNUC__
+                    __builtin_prefetch(m_items + id);
+#endif
+                }
+
                 uint64_t size() const {
                     return m_size;
                 }
@@ -0,0 +1,176 @@
+#ifndef OSMIUM_STORAGE_BYID_SIGNED_IDS_HPP
+#define OSMIUM_STORAGE_BYID_SIGNED_IDS_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <boost/utility.hpp>
+
+#include <osmium/osm/types.hpp>
+
+namespace Osmium {
+
+    namespace Storage {
+
+        namespace ById {
+
+            /**
+            * Adapter that makes a storage for positive IDs usable for the
+            * full range of signed IDs.
+            *
+            * Positive IDs (and zero) are stored in the wrapped storage.
+            * Negative IDs are usually rare (they are used in files created
+            * by editors for objects not yet uploaded), so they are kept in
+            * a small vector of ID/value pairs that is sorted once when
+            * writes_complete() is called and searched with a binary search
+            * afterwards. This saves the second storage for negative IDs
+            * that would otherwise be needed.
+            *
+            * Use this with the single storage version of the
+            * CoordinatesForWays handler.
+            *
+            * @tparam TStoragePosIDs Storage class for the positive IDs.
+            */
+            template <class TStoragePosIDs>
+            class SignedIds : boost::noncopyable {
+
+            public:
+
+                typedef typename TStoragePosIDs::value_type value_type;
+
+                SignedIds(TStoragePosIDs& storage_pos) :
+                    m_storage_pos(storage_pos),
+                    m_negative(),
+                    m_sorted(true) {
+                }
+
+                void set(const osm_object_id_t id, const value_type value) {
+                    if (id >= 0) {
+                        m_storage_pos.set(id, value);
+                    } else {
+                        m_negative.push_back(std::make_pair(id, value));
+                        m_sorted = false;
+                    }
+                }
+
+                /**
+                * Retrieve value by key. For negative IDs that were never
+                * set, value_type() is returned.
+                */
+                const value_type operator[](const osm_object_id_t id) const {
+                    if (id >= 0) {
+                        return m_storage_pos[id];
+                    }
+                    return get_negative(id);
+                }
+
+                void prefetch(const osm_object_id_t id) const {
+                    if (id >= 0) {
+                        m_storage_pos.prefetch(id);
+                    }
+                }
+
+                /**
+                * Sort the negative IDs and prepare the wrapped storage for
+                * lookups.
+                */
+                void writes_complete() {
+                    sort_negative();
+                    m_storage_pos.writes_complete();
+                }
+
+                /// Number of negative IDs stored.
+                uint64_t negative_size() const {
+                    return m_negative.size();
+                }
+
+                uint64_t size() const {
+                    return m_storage_pos.size() + m_negative.size();
+                }
+
+                uint64_t used_memory() const {
+                    return m_storage_pos.used_memory() + m_negative.capacity() * sizeof(item_t);
+                }
+
+                void clear() {
+                    m_storage_pos.clear();
+                    std::vector<item_t>().swap(m_negative);
+                    m_sorted = true;
+                }
+
+            private:
+
+                typedef std::pair<osm_object_id_t, value_type> item_t;
+
+                static bool compare_ids(const item_t& a, const item_t& b) {
+                    return a.first < b.first;
+                }
+
+                /**
+                * Sort negative IDs. If an ID was set more than once, the
+                * last value wins.
+                */
+                void sort_negative() const {
+                    if (m_sorted) {
+                        return;
+                    }
+                    std::stable_sort(m_negative.begin(), m_negative.end(), compare_ids);
+
+                    typename std::vector<item_t>::iterator out = m_negative.begin();
+                    for (typename std::vector<item_t>::const_iterator it = m_negative.begin(); it != m_negative.end(); ++it) {
+                        if (it + 1 == m_negative.end() || (it + 1)->first != it->first) {
+                            *out++ = *it;
+                        }
+                    }
+                    m_negative.erase(out, m_negative.end());
+                    m_sorted = true;
+                }
+
+                const value_type get_negative(const osm_object_id_t id) const {
+                    // in case writes_complete() was not called
+                    sort_negative();
+
+                    typename std::vector<item_t>::const_iterator it = std::lower_bound(m_negative.begin(), m_negative.end(), item_t(id, value_type()), compare_ids);
+                    if (it == m_negative.end() || it->first != id) {
+                        return value_type();
+                    }
+                    return it->second;
+                }
+
+                TStoragePosIDs& m_storage_pos;
+
+                /// Negative IDs with their values, sorted by ID once m_sorted is set.
+                mutable std::vector<item_t> m_negative;
+
+                mutable bool m_sorted;
+
+            }; // class SignedIds
+
+        } // namespace ById
+
+    } // namespace Storage
+
+} // namespace Osmium
+
+#endif // OSMIUM_STORAGE_BYID_SIGNED_IDS_HPP
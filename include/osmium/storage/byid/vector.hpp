@@ -28,6 +28,7 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 
 #include <osmium/osm/types.hpp>
 #include <osmium/storage/byid.hpp>
+#include <osmium/utils/radix_sort.hpp>
 
 namespace Osmium {
 
@@ -37,11 +38,20 @@ namespace Osmium {
 
             /**
             * This class uses a vector of ID/Value pairs to store the
-            * data. The vector must be filled ordered by ID (OSM files
-            * are generally ordered that way, so thats usually not a
-            * problem). Lookup uses a binary search.
+            * data. Items are appended in any order. If they did not come
+            * in ordered by ID (OSM files generally are ordered that way),
+            * the vector is sorted with a (parallel) radix sort when
+            * writes_complete() is called. If the same ID was set more than
+            * once, the last value is kept.
             *
-            * This has very low memory overhead for small OSM datasets.
+            * Lookup uses an interpolation search, which needs only a few
+            * steps for the fairly evenly distributed IDs in OSM data. It
+            * falls back to a binary search if the interpolation does not
+            * narrow down the range quickly enough.
+            *
+            * This has very low memory overhead for small OSM datasets,
+            * each item needs 16 bytes when storing node coordinates.
+            * Sorting needs a temporary copy of the data.
             */
             template <typename TValue>
             class Vector : public Osmium::Storage::ById::Base<TValue> {
@@ -68,30 +78,61 @@ namespace Osmium {
                     }
                 };
 
+                struct item_key {
+                    uint64_t operator()(const item_t& item) const {
+                        return item.id;
+                    }
+                };
+
                 typedef std::vector<item_t> item_vector_t;
                 typedef typename item_vector_t::const_iterator item_vector_it_t;
 
+                /// Number of interpolation steps before falling back to binary search.
+                static const int max_interpolation_steps = 6;
+
+                /// Ranges smaller than this are searched linearly.
+                static const size_t linear_search_size = 8;
+
             public:
 
-                Vector() :
+                /**
+                * Constructor.
+                *
+                * @param sort_threads Number of threads used for sorting.
+                */
+                Vector(unsigned int sort_threads = 1) :
                     Base<TValue>(),
-                    m_items() {
+                    m_items(),
+                    m_sorted(true),
+                    m_sort_threads(sort_threads) {
                 }
 
                 void set(const uint64_t id, const TValue value) {
+                    if (m_sorted && !m_items.empty() && m_items.back().id >= static_cast<osm_object_id_t>(id)) {
+                        m_sorted = false;
+                    }
                     m_items.push_back(item_t(id, value));
                 }
 
                 const TValue operator[](const uint64_t id) const {
-                    const item_t item(id);
-                    const item_vector_it_t result = std::lower_bound(m_items.begin(), m_items.end(), item);
-                    if (result == m_items.end() || *result != item) {
+                    // in case writes_complete() was not called
+                    sort();
+
+                    const item_vector_it_t result = find(id);
+                    if (result == m_items.end()) {
                         return TValue(); // nothing found
                     } else {
                         return result->value;
                     }
                 }
 
+                /**
+                * Sort the items by ID if they were not set in order.
+                */
+                void writes_complete() {
+                    sort();
+                }
+
                 uint64_t size() const {
                     return m_items.size();
                 }
@@ -106,7 +147,64 @@ namespace Osmium {
 
             private:
 
-                item_vector_t m_items;
+                mutable item_vector_t m_items;
+
+                mutable bool m_sorted;
+
+                const unsigned int m_sort_threads;
+
+                void sort() const {
+                    if (m_sorted) {
+                        return;
+                    }
+                    Osmium::radix_sort(m_items, item_key(), m_sort_threads);
+
+                    // remove duplicates, the sort is stable so the last one set wins
+                    typename item_vector_t::iterator out = m_items.begin();
+                    for (item_vector_it_t it = m_items.begin(); it != m_items.end(); ++it) {
+                        if (it + 1 == m_items.end() || *(it + 1) != *it) {
+                            *out++ = *it;
+                        }
+                    }
+                    m_items.erase(out, m_items.end());
+                    m_sorted = true;
+                }
+
+                /**
+                * Find item with the given ID using interpolation search.
+                * Returns m_items.end() if there is no such item.
+                */
+                item_vector_it_t find(const uint64_t id) const {
+                    const osm_object_id_t search_id = id;
+                    item_vector_it_t first = m_items.begin();
+                    item_vector_it_t last = m_items.end();
+
+                    for (int step = 0; step < max_interpolation_steps && static_cast<size_t>(last - first) > linear_search_size; ++step) {
+                        const osm_object_id_t first_id = first->id;
+                        const osm_object_id_t last_id = (last - 1)->id;
+                        if (search_id < first_id || search_id > last_id) {
+                            return m_items.end();
+                        }
+                        if (first_id == last_id) {
+                            break;
+                        }
+                        const double fraction = static_cast<double>(search_id - first_id) / static_cast<double>(last_id - first_id);
+                        item_vector_it_t guess = first + static_cast<size_t>(fraction * (last - first - 1));
+                        if (guess->id < search_id) {
+                            first = guess + 1;
+                        } else if (guess->id > search_id) {
+                            last = guess;
+                        } else {
+                            return guess;
+                        }
+                    }
+
+                    const item_vector_it_t result = std::lower_bound(first, last, item_t(search_id));
+                    if (result == last || result->id != search_id) {
+                        return m_items.end();
+                    }
+                    return result;
+                }
 
             }; // class Vector
 
@@ -0,0 +1,127 @@
+#ifndef OSMIUM_UTILS_BLOOM_FILTER_HPP
+#define OSMIUM_UTILS_BLOOM_FILTER_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace Osmium {
+
+    /**
+     * A blocked Bloom filter for 64 bit keys.
+     *
+     * The filter is split into blocks of 512 bits, one cache line each.
+     * All bits for a key are set in the same block, so a lookup touches
+     * only one cache line. This costs a slightly higher false positive
+     * rate than a classic Bloom filter of the same size. With the default
+     * of 12 bits per key it is about 1%.
+     *
+     * There are no false negatives: if contains() returns false the key
+     * was never added.
+     */
+    class BloomFilter {
+
+        static const unsigned int words_per_block = 8;
+        static const unsigned int bits_per_lookup = 6;
+
+    public:
+
+        /**
+         * Create a filter.
+         *
+         * @param expected_keys Number of keys that will be added.
+         * @param bits_per_key Number of bits to use per key.
+         */
+        BloomFilter(size_t expected_keys=0, unsigned int bits_per_key=12) :
+            m_num_blocks(expected_keys * bits_per_key / 512 + 1),
+            m_bits(m_num_blocks * words_per_block, 0) {
+        }
+
+        void add(const uint64_t key) {
+            const uint64_t hash = mix(key);
+            uint64_t* block = &m_bits[block_index(hash) * words_per_block];
+            uint64_t bits = mix(hash);
+            for (unsigned int i = 0; i < bits_per_lookup; ++i) {
+                block[(bits >> 6) & 7] |= 1ULL << (bits & 63);
+                bits >>= 9;
+            }
+        }
+
+        /**
+         * Check whether the key might have been added.
+         *
+         * @returns false if the key was definitely not added, true otherwise.
+         */
+        bool contains(const uint64_t key) const {
+            const uint64_t hash = mix(key);
+            const uint64_t* block = &m_bits[block_index(hash) * words_per_block];
+            uint64_t bits = mix(hash);
+            for (unsigned int i = 0; i < bits_per_lookup; ++i) {
+                if (!(block[(bits >> 6) & 7] & (1ULL << (bits & 63)))) {
+                    return false;
+                }
+                bits >>= 9;
+            }
+            return true;
+        }
+
+        uint64_t used_memory() const {
+            return m_bits.size() * sizeof(uint64_t);
+        }
+
+        /**
+         * Release the memory used by the filter. Afterwards the filter
+         * has one empty block and does not contain anything.
+         */
+        void clear() {
+            m_num_blocks = 1;
+            std::vector<uint64_t>(words_per_block, 0).swap(m_bits);
+        }
+
+    private:
+
+        /// Hash function mixing all key bits (finalizer from MurmurHash3).
+        static uint64_t mix(uint64_t key) {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            key *= 0xc4ceb9fe1a85ec53ULL;
+            key ^= key >> 33;
+            return key;
+        }
+
+        /// Map hash to block without a division.
+        size_t block_index(const uint64_t hash) const {
+            return static_cast<size_t>(((hash >> 32) * m_num_blocks) >> 32);
+        }
+
+        size_t m_num_blocks;
+
+        std::vector<uint64_t> m_bits;
+
+    }; // class BloomFilter
+
+} // namespace Osmium
+
+#endif // OSMIUM_UTILS_BLOOM_FILTER_HPP
@@ -0,0 +1,108 @@
+#ifndef OSMIUM_UTILS_JSON_HPP
+#define OSMIUM_UTILS_JSON_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+
+namespace Osmium {
+
+    /**
+     * Helper functions for writing JSON.
+     */
+    namespace JSON {
+
+        /**
+         * Append a character that needs escaping in a JSON string.
+         * Control characters without a short escape are written as
+         * \u00XX.
+         */
+        inline void append_escaped(std::string& out, unsigned char c) {
+            static const char* lookup_hex = "0123456789abcdef";
+            switch (c) {
+                case '"':  out.append("\\\"", 2); break;
+                case '\\': out.append("\\\\", 2); break;
+                case '\n': out.append("\\n", 2); break;
+                case '\r': out.append("\\r", 2); break;
+                case '\t': out.append("\\t", 2); break;
+                default:
+                    out.append("\\u00", 4);
+                    out.append(1, lookup_hex[c >> 4]);
+                    out.append(1, lookup_hex[c & 0xf]);
+                    break;
+            }
+        }
+
+        /**
+         * Append a quoted and escaped JSON string. The string is checked
+         * for characters that need escaping eight bytes at a time, using
+         * bit tricks on a 64 bit word, only blocks with such characters
+         * are looked at byte by byte.
+         */
+        inline void append_string(std::string& out, const char* str) {
+            static const uint64_t ones = 0x0101010101010101ULL;
+            static const uint64_t highs = 0x8080808080808080ULL;
+
+            const size_t length = strlen(str);
+            out.append(1, '"');
+
+            size_t start = 0;
+            size_t i = 0;
+            while (i < length) {
+                if (i + 8 <= length) {
+                    uint64_t word;
+                    memcpy(&word, str + i, sizeof(word));
+                    const uint64_t quote = word ^ (ones * '"');
+                    const uint64_t backslash = word ^ (ones * '\\');
+                    const uint64_t special = ((word - ones * 0x20) & ~word) |
+                                             ((quote - ones) & ~quote) |
+                                             ((backslash - ones) & ~backslash);
+                    if ((special & highs) == 0) {
+                        i += 8;
+                        continue;
+                    }
+                }
+
+                const size_t block_end = std::min(i + 8, length);
+                for (; i < block_end; ++i) {
+                    const unsigned char c = str[i];
+                    if (c == '"' || c == '\\' || c < 0x20) {
+                        out.append(str + start, i - start);
+                        append_escaped(out, c);
+                        start = i + 1;
+                    }
+                }
+            }
+
+            out.append(str + start, length - start);
+            out.append(1, '"');
+        }
+
+    } // namespace JSON
+
+} // namespace Osmium
+
+#endif // OSMIUM_UTILS_JSON_HPP
@@ -0,0 +1,202 @@
+#ifndef OSMIUM_UTILS_RADIX_SORT_HPP
+#define OSMIUM_UTILS_RADIX_SORT_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#define OSMIUM_LINK_WITH_LIBS_BOOST_THREAD -lboost_thread
+
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+namespace Osmium {
+
+    /**
+     * Helper class for radix_sort(). Holds the state of one sorting
+     * pass that is shared between the threads. Each thread works on
+     * its own chunk of the input.
+     */
+    template <typename T, typename TKey>
+    class RadixSortPass {
+
+    public:
+
+        RadixSortPass(const T* src, T* dst, size_t size, TKey key, unsigned int num_chunks) :
+            m_src(src),
+            m_dst(dst),
+            m_size(size),
+            m_key(key),
+            m_num_chunks(num_chunks),
+            m_shift(0),
+            m_counts(num_chunks * 256) {
+        }
+
+        void set_pass(const T* src, T* dst, unsigned int shift) {
+            m_src = src;
+            m_dst = dst;
+            m_shift = shift;
+            std::fill(m_counts.begin(), m_counts.end(), 0);
+        }
+
+        /// Count how often each digit occurs in a chunk.
+        void count(unsigned int chunk) {
+            size_t* counts = &m_counts[chunk * 256];
+            const size_t end = chunk_end(chunk);
+            for (size_t i = chunk_begin(chunk); i < end; ++i) {
+                ++counts[(m_key(m_src[i]) >> m_shift) & 0xff];
+            }
+        }
+
+        /**
+         * Turn counts into start offsets for each digit and chunk.
+         * Returns false if all items have the same digit, in which case
+         * the pass can be skipped.
+         */
+        bool make_offsets() {
+            size_t offset = 0;
+            for (unsigned int digit = 0; digit < 256; ++digit) {
+                size_t digit_count = 0;
+                for (unsigned int chunk = 0; chunk < m_num_chunks; ++chunk) {
+                    const size_t count = m_counts[chunk * 256 + digit];
+                    m_counts[chunk * 256 + digit] = offset;
+                    offset += count;
+                    digit_count += count;
+                }
+                if (digit_count == m_size) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// Move the items in a chunk to their place in the output.
+        void scatter(unsigned int chunk) {
+            size_t* offsets = &m_counts[chunk * 256];
+            const size_t end = chunk_end(chunk);
+            for (size_t i = chunk_begin(chunk); i < end; ++i) {
+                m_dst[offsets[(m_key(m_src[i]) >> m_shift) & 0xff]++] = m_src[i];
+            }
+        }
+
+    private:
+
+        size_t chunk_begin(unsigned int chunk) const {
+            return m_size * chunk / m_num_chunks;
+        }
+
+        size_t chunk_end(unsigned int chunk) const {
+            return m_size * (chunk + 1) / m_num_chunks;
+        }
+
+        const T* m_src;
+        T* m_dst;
+        const size_t m_size;
+        TKey m_key;
+        const unsigned int m_num_chunks;
+        unsigned int m_shift;
+
+        /// Counts (later offsets) for each digit, one block of 256 per chunk.
+        std::vector<size_t> m_counts;
+
+    }; // class RadixSortPass
+
+    /**
+     * Sort a vector with an LSD radix sort on 64 bit unsigned keys, one
+     * byte per pass. The sort is stable. Passes over bytes that are the
+     * same for all keys are skipped, so sorting small keys only costs
+     * as many passes as the keys have significant bytes.
+     *
+     * With num_threads > 1 the counting and scattering in each pass is
+     * done by several threads working on separate chunks of the input.
+     *
+     * A temporary buffer the size of the input is needed while sorting.
+     *
+     * @param items Vector to sort.
+     * @param key Functor returning the uint64_t key for an item.
+     * @param num_threads Number of threads to use.
+     */
+    template <typename T, typename TKey>
+    void radix_sort(std::vector<T>& items, TKey key, unsigned int num_threads = 1) {
+        const size_t size = items.size();
+        if (size < 2) {
+            return;
+        }
+        if (num_threads == 0) {
+            num_threads = 1;
+        }
+        if (num_threads > size) {
+            num_threads = size;
+        }
+
+        uint64_t all_keys = 0;
+        for (typename std::vector<T>::const_iterator it = items.begin(); it != items.end(); ++it) {
+            all_keys |= key(*it);
+        }
+
+        std::vector<T> buffer(size, items.front());
+        T* src = &items[0];
+        T* dst = &buffer[0];
+        bool result_in_buffer = false;
+
+        RadixSortPass<T, TKey> pass(src, dst, size, key, num_threads);
+        for (unsigned int shift = 0; shift < 64 && (all_keys >> shift) != 0; shift += 8) {
+            pass.set_pass(src, dst, shift);
+
+            if (num_threads == 1) {
+                pass.count(0);
+            } else {
+                boost::thread_group threads;
+                for (unsigned int chunk = 0; chunk < num_threads; ++chunk) {
+                    threads.create_thread(boost::bind(&RadixSortPass<T, TKey>::count, &pass, chunk));
+                }
+                threads.join_all();
+            }
+
+            if (!pass.make_offsets()) {
+                continue;
+            }
+
+            if (num_threads == 1) {
+                pass.scatter(0);
+            } else {
+                boost::thread_group threads;
+                for (unsigned int chunk = 0; chunk < num_threads; ++chunk) {
+                    threads.create_thread(boost::bind(&RadixSortPass<T, TKey>::scatter, &pass, chunk));
+                }
+                threads.join_all();
+            }
+
+            std::swap(src, dst);
+            result_in_buffer = !result_in_buffer;
+        }
+
+        if (result_in_buffer) {
+            items.swap(buffer);
+        }
+    }
+
+} // namespace Osmium
+
+#endif // OSMIUM_UTILS_RADIX_SORT_HPP
@@ -0,0 +1,253 @@
+#ifndef OSMIUM_UTILS_WORKER_POOL_HPP
+#define OSMIUM_UTILS_WORKER_POOL_HPP
+
+/*
+
+Copyright 2012 Jochen Topf <jochen@topf.org> and others (see README).
+
+This file is part of Osmium (https://github.com/joto/osmium).
+
+Osmium is free software: you can redistribute it and/or modify it under the
+terms of the GNU Lesser General Public License or (at your option) the GNU
+General Public License as published by the Free Software Foundation, either
+version 3 of the Licenses, or (at your option) any later version.
+
+Osmium is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU Lesser General Public License and the GNU
+General Public License for more details.
+
+You should have received a copy of the Licenses along with Osmium. If not, see
+<http://www.gnu.org/licenses/>.
+
+*/
+
+#define OSMIUM_LINK_WITH_LIBS_BOOST_THREAD -lboost_thread
+
+#include <cstddef>
+#include <deque>
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+
+#include <osmium/smart_ptr.hpp>
+
+namespace Osmium {
+
+    /**
+     * A pool of worker threads running jobs in the background.
+     *
+     * Jobs are objects of class TJob which must have a run() method.
+     * The results are stored in the job object itself. Jobs are added
+     * with submit() and finished jobs are retrieved with
+     * next_finished(). If the pool is ordered, jobs are returned in
+     * the order they were submitted, otherwise in the order they
+     * finished.
+     *
+     * The number of jobs submitted but not yet finished is bounded.
+     * If the limit is reached, submit() blocks until a job finishes.
+     * Finished jobs are kept until they are retrieved, so call
+     * next_finished() regularly from the thread submitting the jobs.
+     *
+     * With zero threads, submit() runs the job immediately in the
+     * calling thread. This makes it easy to switch off threading.
+     *
+     * An exception thrown from run() is kept and rethrown from
+     * next_finished() when the job is retrieved.
+     *
+     * @tparam TJob Job class.
+     */
+    template <class TJob>
+    class WorkerPool : boost::noncopyable {
+
+        struct slot_t {
+            shared_ptr<TJob> job;
+            bool done;
+            boost::exception_ptr error;
+
+            slot_t(const shared_ptr<TJob>& j) :
+                job(j),
+                done(false),
+                error() {
+            }
+        };
+
+        typedef std::deque< shared_ptr<slot_t> > slot_queue_t;
+
+    public:
+
+        /**
+         * Create a pool and start the worker threads.
+         *
+         * @param num_threads Number of worker threads. 0 means that jobs are run in submit().
+         * @param ordered Return finished jobs in the order they were submitted.
+         * @param max_unfinished Maximum number of jobs submitted but not yet finished.
+         */
+        WorkerPool(unsigned int num_threads, bool ordered=true, size_t max_unfinished=1000) :
+            m_ordered(ordered),
+            m_max_unfinished(max_unfinished > 0 ? max_unfinished : 1),
+            m_num_threads(num_threads),
+            m_mutex(),
+            m_work_available(),
+            m_job_done(),
+            m_todo(),
+            m_pending(),
+            m_unfinished(0),
+            m_shutdown(false),
+            m_threads() {
+            for (unsigned int i = 0; i < num_threads; ++i) {
+                m_threads.create_thread(boost::bind(&WorkerPool::worker, this));
+            }
+        }
+
+        /**
+         * Stop all worker threads. Jobs not yet started are not run.
+         */
+        ~WorkerPool() {
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_shutdown = true;
+            }
+            m_work_available.notify_all();
+            m_threads.join_all();
+        }
+
+        unsigned int num_threads() const {
+            return m_num_threads;
+        }
+
+        /**
+         * Add a job. Blocks if the maximum number of unfinished jobs is reached.
+         */
+        void submit(const shared_ptr<TJob>& job) {
+            shared_ptr<slot_t> slot = make_shared<slot_t>(job);
+
+            if (m_num_threads == 0) {
+                run_job(*slot);
+                slot->done = true;
+                m_pending.push_back(slot);
+                return;
+            }
+
+            boost::mutex::scoped_lock lock(m_mutex);
+            while (m_unfinished >= m_max_unfinished) {
+                m_job_done.wait(lock);
+            }
+            ++m_unfinished;
+            m_pending.push_back(slot);
+            m_todo.push_back(slot);
+            m_work_available.notify_one();
+        }
+
+        /**
+         * Return a finished job and remove it from the pool.
+         *
+         * @param wait If true, wait until a job is finished. Otherwise
+         *             return immediately if there is none.
+         * @returns The job or an empty pointer if there are no (finished) jobs.
+         * @throws Whatever the run() method of the job threw.
+         */
+        shared_ptr<TJob> next_finished(bool wait=false) {
+            boost::mutex::scoped_lock lock(m_mutex);
+            while (!m_pending.empty()) {
+                typename slot_queue_t::iterator it = find_finished();
+                if (it != m_pending.end()) {
+                    shared_ptr<slot_t> slot = *it;
+                    m_pending.erase(it);
+                    if (slot->error) {
+                        boost::rethrow_exception(slot->error);
+                    }
+                    return slot->job;
+                }
+                if (!wait) {
+                    break;
+                }
+                m_job_done.wait(lock);
+            }
+            return shared_ptr<TJob>();
+        }
+
+        /// Number of jobs submitted but not yet retrieved.
+        size_t pending() const {
+            boost::mutex::scoped_lock lock(m_mutex);
+            return m_pending.size();
+        }
+
+    private:
+
+        /**
+         * Find the next job to return. Must be called with the mutex held.
+         */
+        typename slot_queue_t::iterator find_finished() {
+            if (m_ordered) {
+                return m_pending.front()->done ? m_pending.begin() : m_pending.end();
+            }
+            for (typename slot_queue_t::iterator it = m_pending.begin(); it != m_pending.end(); ++it) {
+                if ((*it)->done) {
+                    return it;
+                }
+            }
+            return m_pending.end();
+        }
+
+        static void run_job(slot_t& slot) {
+            try {
+                slot.job->run();
+            } catch (...) {
+                slot.error = boost::current_exception();
+            }
+        }
+
+        void worker() {
+            while (true) {
+                shared_ptr<slot_t> slot;
+                {
+                    boost::mutex::scoped_lock lock(m_mutex);
+                    while (m_todo.empty() && !m_shutdown) {
+                        m_work_available.wait(lock);
+                    }
+                    if (m_shutdown) {
+                        return;
+                    }
+                    slot = m_todo.front();
+                    m_todo.pop_front();
+                }
+
+                run_job(*slot);
+
+                {
+                    boost::mutex::scoped_lock lock(m_mutex);
+                    slot->done = true;
+                    --m_unfinished;
+                }
+                m_job_done.notify_all();
+            }
+        }
+
+        const bool m_ordered;
+        const size_t m_max_unfinished;
+        const unsigned int m_num_threads;
+
+        mutable boost::mutex m_mutex;
+        boost::condition_variable m_work_available;
+        boost::condition_variable m_job_done;
+
+        /// Jobs not yet started.
+        slot_queue_t m_todo;
+
+        /// Jobs submitted but not yet retrieved, in submission order.
+        slot_queue_t m_pending;
+
+        /// Number of jobs submitted but not yet finished.
+        size_t m_unfinished;
+
+        bool m_shutdown;
+
+        boost::thread_group m_threads;
+
+    }; // class WorkerPool
+
+} // namespace Osmium
+
+#endif // OSMIUM_UTILS_WORKER_POOL_HPP
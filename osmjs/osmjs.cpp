@@ -32,6 +32,7 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 #include <osmium/storage/byid/sparse_table.hpp>
 #include <osmium/storage/byid/mmap_file.hpp>
 #include <osmium/storage/byid/vector.hpp>
+#include <osmium/storage/byid/signed_ids.hpp>
 #ifdef __linux__
 #  include <osmium/storage/byid/mmap_anon.hpp>
 #endif
@@ -39,8 +40,8 @@ You should have received a copy of the Licenses along with Osmium. If not, see
 #include <osmium/multipolygon/assembler.hpp>
 
 typedef Osmium::Storage::ById::Base<Osmium::OSM::Position> storage_byid_t;
-typedef Osmium::Storage::ById::MmapFile<Osmium::OSM::Position> storage_mmap_t;
-typedef Osmium::Handler::CoordinatesForWays<storage_byid_t, storage_mmap_t> cfw_handler_t;
+typedef Osmium::Storage::ById::SignedIds<storage_byid_t> storage_signed_t;
+typedef Osmium::Handler::CoordinatesForWays<storage_signed_t> cfw_handler_t;
 
 v8::Persistent<v8::Context> global_context;
 
@@ -236,9 +237,8 @@ int main(int argc, char* argv[]) {
     } else if (location_store == SPARSETABLE) {
         store_pos = new Osmium::Storage::ById::SparseTable<Osmium::OSM::Position>();
     } else if (location_store == VECTOR) {
-        store_pos = new Osmium::Storage::ById::Vector<Osmium::OSM::Position>();
+        store_pos = new Osmium::Storage::ById::Vector<Osmium::OSM::Position>(boost::thread::hardware_concurrency());
     }
-    Osmium::Storage::ById::MmapFile<Osmium::OSM::Position> store_neg;
     Osmium::Javascript::Handler handler_javascript(include_files, javascript_filename.c_str());
     handler_javascript.set_debug_level(debug ? 1 : 0);
 
@@ -246,15 +246,16 @@ int main(int argc, char* argv[]) {
         typedef Osmium::MultiPolygon::Assembler<Osmium::Javascript::Handler> assembler_t;
         assembler_t assembler(handler_javascript, attempt_repair);
 
-        cfw_handler_t handler_cfw(*store_pos, store_neg);
+        storage_signed_t store_signed(*store_pos);
+        cfw_handler_t handler_cfw(store_signed);
 
         typedef Osmium::Handler::Sequence<cfw_handler_t, assembler_t::HandlerPass2> sequence_handler_t;
         sequence_handler_t sequence_handler(handler_cfw, assembler.handler_pass2());
 
-        Osmium::Input::read(infile, assembler.handler_pass1());
-        Osmium::Input::read(infile, sequence_handler);
+        Osmium::Input::read_relations_first(infile, assembler.handler_pass1(), sequence_handler, true);
     } else if (store_pos) {
-        cfw_handler_t handler_cfw(*store_pos, store_neg);
+        storage_signed_t store_signed(*store_pos);
+        cfw_handler_t handler_cfw(store_signed);
 
         typedef Osmium::Handler::Sequence<cfw_handler_t, Osmium::Javascript::Handler> sequence_handler_t;
         sequence_handler_t sequence_handler(handler_cfw, handler_javascript);
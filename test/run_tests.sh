@@ -42,7 +42,7 @@ TESTS_FAILED=0
 TESTS_OK=0
 
 OPTS_CFLAGS="$(geos-config --cflags) $(gdal-config --cflags)"
-OPTS_LIBS="$(geos-config --libs) $(gdal-config --libs) -lboost_regex -lboost_iostreams -lboost_filesystem -lboost_system"
+OPTS_LIBS="$(geos-config --libs) $(gdal-config --libs) -lboost_regex -lboost_iostreams -lboost_filesystem -lboost_system -lboost_thread -lpthread"
 
 test_file () {
     FILES="test_main.o test_utils.o $1"
@@ -0,0 +1,192 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+#include <osmium/export/buffered_shapefile.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::WayNode;
+
+BOOST_AUTO_TEST_SUITE(BufferedShapefile)
+
+static const int num_features = 100;
+
+std::string read_file(const std::string& filename) {
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+void remove_files(const std::string& base) {
+    const char* suffixes[] = { ".shp", ".shx", ".dbf", ".prj", ".cpg" };
+    for (int i = 0; i < 5; ++i) {
+        unlink((base + suffixes[i]).c_str());
+    }
+}
+
+uint32_t read_be32(const std::string& data, size_t offset) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(data[offset])) << 24) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(data[offset + 1])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(data[offset + 2])) << 8) |
+            static_cast<uint32_t>(static_cast<unsigned char>(data[offset + 3]));
+}
+
+/**
+ * Write points, lines and polygons to three shapefiles sharing one
+ * writer. An extra way with only one node after the line with id 50
+ * can't be written and is skipped. All lines are written from the same
+ * way object, which must not be kept by the jobs.
+ */
+void write_shapefiles(unsigned int num_threads) {
+    Osmium::Export::ShapefileWriter writer(num_threads, 10);
+    Osmium::Export::BufferedShapefile points(writer, "test_bsf_points", SHPT_POINT);
+    Osmium::Export::BufferedShapefile lines(writer, "test_bsf_lines", SHPT_ARC);
+    Osmium::Export::BufferedShapefile polygons(writer, "test_bsf_polygons", SHPT_POLYGON);
+    points.add_field("id", "integer", 10);
+    lines.add_field("id", "integer", 10);
+    polygons.add_field("id", "integer", 10);
+
+    // the same way object is changed for every line after it was added
+    shared_ptr<Osmium::OSM::Way> way = make_shared<Osmium::OSM::Way>();
+
+    for (int i = 1; i <= num_features; ++i) {
+        const double x = i * 0.1;
+
+        shared_ptr<Osmium::OSM::Node> node = make_shared<Osmium::OSM::Node>();
+        node->id(i);
+        node->position(Position(x, 1.0));
+        Osmium::Export::BufferedShapefile::Record point_record(points);
+        point_record.add_attribute(0, i);
+        points.add(node, point_record);
+
+        way->id(i);
+        way->nodes().clear();
+        for (int j = 0; j < 2 + i % 5; ++j) {
+            way->nodes().add(WayNode(j + 1, Position(x + j * 0.01, j * 0.01)));
+        }
+        Osmium::Export::BufferedShapefile::Record line_record(lines);
+        line_record.add_attribute(0, i);
+        lines.add(way, line_record);
+
+        if (i == num_features / 2) {
+            shared_ptr<Osmium::OSM::Way> broken_way = make_shared<Osmium::OSM::Way>();
+            broken_way->id(i);
+            broken_way->nodes().add(WayNode(1, Position(x, 0.0)));
+            Osmium::Export::BufferedShapefile::Record broken_record(lines);
+            broken_record.add_attribute(0, -1);
+            lines.add(broken_way, broken_record);
+        }
+
+        Osmium::OSM::Way square;
+        square.id(i);
+        square.nodes().add(WayNode(1, Position(x, 0.0)));
+        square.nodes().add(WayNode(2, Position(x + 0.01, 0.0)));
+        square.nodes().add(WayNode(3, Position(x + 0.01, 0.01)));
+        square.nodes().add(WayNode(4, Position(x, 0.01)));
+        square.nodes().add(WayNode(1, Position(x, 0.0)));
+        Osmium::Export::BufferedShapefile::Record polygon_record(polygons);
+        polygon_record.add_attribute(0, i);
+        polygons.add(make_shared<Osmium::OSM::Area>(square), polygon_record);
+    }
+
+    points.close();
+    lines.close();
+    polygons.close();
+
+    BOOST_CHECK_EQUAL(points.features(), static_cast<uint64_t>(num_features));
+    BOOST_CHECK_EQUAL(lines.features(), static_cast<uint64_t>(num_features));
+    BOOST_CHECK_EQUAL(lines.skipped(), 1u);
+    BOOST_CHECK_EQUAL(polygons.features(), static_cast<uint64_t>(num_features));
+}
+
+/**
+ * Check that the .shx index points to the records in the .shp file one
+ * after the other. Offsets and lengths are counted in 16 bit words.
+ */
+void check_index(const std::string& base) {
+    const std::string shp = read_file(base + ".shp");
+    const std::string shx = read_file(base + ".shx");
+    BOOST_REQUIRE_EQUAL(shx.size(), 100u + 8 * num_features);
+    BOOST_CHECK_EQUAL(read_be32(shx, 24), shx.size() / 2);
+
+    uint32_t offset = 50;
+    for (int i = 0; i < num_features; ++i) {
+        BOOST_CHECK_EQUAL(read_be32(shx, 100 + 8 * i), offset);
+        const uint32_t length = read_be32(shx, 104 + 8 * i);
+        BOOST_REQUIRE_LE(2 * (offset + 4 + length), shp.size());
+        BOOST_CHECK_EQUAL(read_be32(shp, 2 * offset), static_cast<uint32_t>(i + 1));
+        BOOST_CHECK_EQUAL(read_be32(shp, 2 * offset + 4), length);
+        offset += 4 + length;
+    }
+    BOOST_CHECK_EQUAL(2 * offset, shp.size());
+    BOOST_CHECK_EQUAL(read_be32(shp, 24), offset);
+}
+
+/**
+ * Read shapefile with shapelib and check that the features are in the
+ * order they were added.
+ */
+void check_shapefile(const std::string& base, int shape_type) {
+    SHPHandle shp = SHPOpen((base + ".shp").c_str(), "rb");
+    BOOST_REQUIRE(shp);
+    int entities = 0;
+    int type = 0;
+    double min_bound[4];
+    double max_bound[4];
+    SHPGetInfo(shp, &entities, &type, min_bound, max_bound);
+    BOOST_CHECK_EQUAL(entities, num_features);
+    BOOST_CHECK_EQUAL(type, shape_type);
+    BOOST_CHECK_CLOSE(min_bound[0], 0.1, 0.0001);
+    BOOST_CHECK_CLOSE(max_bound[0], num_features * 0.1 + (shape_type == SHPT_POINT ? 0.0 : 0.01), 0.0001);
+
+    DBFHandle dbf = DBFOpen((base + ".dbf").c_str(), "rb");
+    BOOST_REQUIRE(dbf);
+    BOOST_CHECK_EQUAL(DBFGetRecordCount(dbf), num_features);
+
+    for (int i = 0; i < num_features; ++i) {
+        BOOST_CHECK_EQUAL(DBFReadIntegerAttribute(dbf, i, 0), i + 1);
+
+        SHPObject* object = SHPReadObject(shp, i);
+        BOOST_REQUIRE(object);
+        BOOST_CHECK_EQUAL(object->nSHPType, shape_type);
+        BOOST_CHECK_CLOSE(object->padfX[0], (i + 1) * 0.1, 0.0001);
+        if (shape_type == SHPT_POINT) {
+            BOOST_CHECK_EQUAL(object->nVertices, 1);
+        } else if (shape_type == SHPT_ARC) {
+            BOOST_CHECK_EQUAL(object->nVertices, 2 + (i + 1) % 5);
+        } else {
+            BOOST_CHECK_EQUAL(object->nParts, 1);
+            BOOST_CHECK_EQUAL(object->nVertices, 5);
+        }
+        SHPDestroyObject(object);
+    }
+
+    DBFClose(dbf);
+    SHPClose(shp);
+
+    check_index(base);
+    remove_files(base);
+}
+
+void check_shapefiles() {
+    check_shapefile("test_bsf_points", SHPT_POINT);
+    check_shapefile("test_bsf_lines", SHPT_ARC);
+    check_shapefile("test_bsf_polygons", SHPT_POLYGON);
+}
+
+BOOST_AUTO_TEST_CASE(without_threads) {
+    write_shapefiles(0);
+    check_shapefiles();
+}
+
+BOOST_AUTO_TEST_CASE(with_threads) {
+    write_shapefiles(2);
+    check_shapefiles();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
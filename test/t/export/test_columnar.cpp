@@ -0,0 +1,247 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+#include <osmium/export/columnar.hpp>
+
+BOOST_AUTO_TEST_SUITE(ColumnarExport)
+
+static const char* filename = "test_columnar.tmp";
+
+std::string read_file() {
+    std::ifstream in(filename, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    unlink(filename);
+    return data;
+}
+
+/// Read little endian integer at the offset and move the offset after it.
+template <typename T>
+T get(const std::string& data, size_t& offset) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(data[offset + i])) << (8 * i);
+    }
+    offset += sizeof(T);
+    return static_cast<T>(value);
+}
+
+shared_ptr<Osmium::OSM::Node> node(osm_object_id_t id, int32_t x, int32_t y) {
+    shared_ptr<Osmium::OSM::Node> node = make_shared<Osmium::OSM::Node>();
+    node->id(id);
+    node->version(id + 1);
+    node->timestamp(1000 + id);
+    node->position(Osmium::OSM::Position(x, y));
+    return node;
+}
+
+BOOST_AUTO_TEST_CASE(empty) {
+    {
+        Osmium::Export::Columnar columnar(filename);
+    }
+    const std::string data = read_file();
+    BOOST_CHECK_EQUAL(data, std::string("OSMCOL01\0\0\0\0\4\0\0\0\0\0\0\0OSMCOL01", 28));
+}
+
+BOOST_AUTO_TEST_CASE(nodes_and_ways) {
+    {
+        Osmium::Export::Columnar columnar(filename, 2, 2);
+        for (int i = 1; i <= 5; ++i) {
+            shared_ptr<Osmium::OSM::Node> n = node(i, i * 10, -i);
+            n->tags().add("amenity", i % 2 ? "bench" : "cafe");
+            columnar.node(n);
+        }
+
+        shared_ptr<Osmium::OSM::Way> way = make_shared<Osmium::OSM::Way>();
+        way->id(-7);
+        way->nodes().add(Osmium::OSM::WayNode(1));
+        way->nodes().add(Osmium::OSM::WayNode(2));
+        way->tags().add("highway", "path");
+        columnar.way(way);
+
+        columnar.close();
+        BOOST_CHECK_EQUAL(columnar.rows(), 6u);
+        BOOST_CHECK_EQUAL(columnar.row_groups().size(), 4u);
+    }
+
+    const std::string data = read_file();
+    BOOST_REQUIRE(data.size() > 24);
+    BOOST_CHECK_EQUAL(data.substr(0, 8), "OSMCOL01");
+    BOOST_CHECK_EQUAL(data.substr(data.size() - 8), "OSMCOL01");
+
+    size_t offset = data.size() - 16;
+    const uint64_t footer_size = get<uint64_t>(data, offset);
+    offset = data.size() - 16 - footer_size;
+    BOOST_REQUIRE_EQUAL(get<uint32_t>(data, offset), 4u);
+
+    // first row group: nodes 1 and 2
+    const uint64_t group_offset = get<uint64_t>(data, offset);
+    BOOST_CHECK_EQUAL(group_offset, 8u);
+    get<uint64_t>(data, offset);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 1u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 2u);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 1);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 2);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 1001);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 1002);
+    BOOST_CHECK_EQUAL(get<int32_t>(data, offset), 10);
+    BOOST_CHECK_EQUAL(get<int32_t>(data, offset), -2);
+    BOOST_CHECK_EQUAL(get<int32_t>(data, offset), 20);
+    BOOST_CHECK_EQUAL(get<int32_t>(data, offset), -1);
+
+    // the way is in the last row group, after the nodes 3, 4 and 5
+    offset += 2 * (8 + 8 + 4 + 4 + 4 * 8 + 4 * 4);
+    const uint64_t way_offset = get<uint64_t>(data, offset);
+    get<uint64_t>(data, offset);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 2u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 1u);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), -7);
+
+    // columns of the first row group
+    offset = group_offset;
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 16u);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 1);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 2);
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 8u);
+    BOOST_CHECK_EQUAL(get<int32_t>(data, offset), 2);
+    BOOST_CHECK_EQUAL(get<int32_t>(data, offset), 3);
+    offset += get<uint64_t>(data, offset); // timestamp
+    offset += get<uint64_t>(data, offset); // x
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 8u);
+    BOOST_CHECK_EQUAL(get<int32_t>(data, offset), -1);
+    BOOST_CHECK_EQUAL(get<int32_t>(data, offset), -2);
+    offset += get<uint64_t>(data, offset); // tag offsets
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 8u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 0u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 0u);
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 8u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 0u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 1u);
+
+    // key dictionary
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 4u + 8u + 7u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 1u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 0u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 7u);
+    BOOST_CHECK_EQUAL(data.substr(offset, 7), "amenity");
+    offset += 7;
+
+    // value dictionary
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 4u + 12u + 9u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 2u);
+    offset += 12;
+    BOOST_CHECK_EQUAL(data.substr(offset, 9), "benchcafe");
+
+    // node refs of the way
+    offset = way_offset;
+    for (int i = 0; i < 3; ++i) {
+        offset += get<uint64_t>(data, offset);
+    }
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 8u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 0u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 2u);
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 16u);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 1);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 2);
+}
+
+BOOST_AUTO_TEST_CASE(way_row_groups) {
+    {
+        Osmium::Export::Columnar columnar(filename, 2, 2);
+
+        // the same way object is changed and added again, the writer
+        // must have copied the values of the earlier rows
+        shared_ptr<Osmium::OSM::Way> way = make_shared<Osmium::OSM::Way>();
+        for (int i = 1; i <= 5; ++i) {
+            way->id(i);
+            way->version(i + 1);
+            way->timestamp(1000 + i);
+            way->nodes().clear();
+            for (int j = 0; j < i; ++j) {
+                way->nodes().add(Osmium::OSM::WayNode(10 * i + j));
+            }
+            way->tags().clear();
+            way->tags().add("highway", i % 2 ? "path" : "track");
+            columnar.way(way);
+        }
+
+        columnar.close();
+        BOOST_CHECK_EQUAL(columnar.rows(), 5u);
+        BOOST_REQUIRE_EQUAL(columnar.row_groups().size(), 3u);
+        for (int i = 0; i < 3; ++i) {
+            const Osmium::Export::Columnar::RowGroupInfo& info = columnar.row_groups()[i];
+            BOOST_CHECK_EQUAL(info.type, 2u);
+            BOOST_CHECK_EQUAL(info.rows, i < 2 ? 2u : 1u);
+            BOOST_CHECK_EQUAL(info.min_id, 2 * i + 1);
+            BOOST_CHECK_EQUAL(info.max_id, i < 2 ? 2 * i + 2 : 5);
+            BOOST_CHECK_EQUAL(info.min_timestamp, 1001 + 2 * i);
+            BOOST_CHECK(info.min_x > info.max_x);
+        }
+    }
+
+    const std::string data = read_file();
+    size_t offset = data.size() - 16;
+    const uint64_t footer_size = get<uint64_t>(data, offset);
+    offset = data.size() - 16 - footer_size;
+    BOOST_REQUIRE_EQUAL(get<uint32_t>(data, offset), 3u);
+
+    // second row group: ways 3 and 4
+    offset += 8 + 8 + 4 + 4 + 4 * 8 + 4 * 4;
+    offset = get<uint64_t>(data, offset);
+
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 16u);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 3);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 4);
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 8u);
+    BOOST_CHECK_EQUAL(get<int32_t>(data, offset), 4);
+    BOOST_CHECK_EQUAL(get<int32_t>(data, offset), 5);
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 16u);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 1003);
+    BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 1004);
+
+    // node offsets and refs
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 12u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 0u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 3u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 7u);
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 7u * 8u);
+    for (int j = 0; j < 3; ++j) {
+        BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 30 + j);
+    }
+    for (int j = 0; j < 4; ++j) {
+        BOOST_CHECK_EQUAL(get<int64_t>(data, offset), 40 + j);
+    }
+
+    // tag offsets, keys and values
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 12u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 0u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 1u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 2u);
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 8u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 0u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 0u);
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 8u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 0u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 1u);
+
+    // key dictionary
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 4u + 8u + 7u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 1u);
+    offset += 8;
+    BOOST_CHECK_EQUAL(data.substr(offset, 7), "highway");
+    offset += 7;
+
+    // value dictionary
+    BOOST_CHECK_EQUAL(get<uint64_t>(data, offset), 4u + 12u + 9u);
+    BOOST_CHECK_EQUAL(get<uint32_t>(data, offset), 2u);
+    offset += 12;
+    BOOST_CHECK_EQUAL(data.substr(offset, 9), "pathtrack");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
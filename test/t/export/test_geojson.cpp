@@ -0,0 +1,141 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include <osmium/export/geojson.hpp>
+
+using Osmium::Export::GeoJSON;
+using Osmium::Export::GeoJSONFormatter;
+
+BOOST_AUTO_TEST_SUITE(GeoJSONExport)
+
+static const char* filename = "test_geojson.tmp";
+
+std::string read_file() {
+    std::ifstream in(filename, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    unlink(filename);
+    return data;
+}
+
+shared_ptr<Osmium::OSM::Node> node(osm_object_id_t id, double lon, double lat) {
+    shared_ptr<Osmium::OSM::Node> node = make_shared<Osmium::OSM::Node>();
+    node->id(id);
+    node->position(Osmium::OSM::Position(lon, lat));
+    return node;
+}
+
+BOOST_AUTO_TEST_CASE(features) {
+    GeoJSONFormatter formatter;
+    std::string out;
+
+    shared_ptr<Osmium::OSM::Node> n = node(7, 1.5, -2.25);
+    n->tags().add("name", "x");
+    n->tags().add("note", "a \"b\"");
+    BOOST_CHECK(formatter.add(*n));
+    formatter.format(0, out);
+    BOOST_CHECK_EQUAL(out, "{\"type\":\"Feature\",\"id\":\"n7\",\"properties\":{\"name\":\"x\",\"note\":\"a \\\"b\\\"\"},\"geometry\":{\"type\":\"Point\",\"coordinates\":[1.5,-2.25]}}");
+
+    Osmium::OSM::Way way;
+    way.id(3);
+    way.nodes().add(Osmium::OSM::WayNode(1, Osmium::OSM::Position(0.0, 0.0)));
+    BOOST_CHECK(!formatter.add(way));
+    BOOST_CHECK_EQUAL(formatter.size(), 1u);
+
+    way.nodes().add(Osmium::OSM::WayNode(2, Osmium::OSM::Position(0.0, 1.0)));
+    BOOST_CHECK(formatter.add(way));
+    out.clear();
+    formatter.format(1, out);
+    BOOST_CHECK_EQUAL(out, "{\"type\":\"Feature\",\"id\":\"w3\",\"properties\":{},\"geometry\":{\"type\":\"LineString\",\"coordinates\":[[0,0],[0,1]]}}");
+
+    // clockwise ring is written counterclockwise
+    way.nodes().add(Osmium::OSM::WayNode(3, Osmium::OSM::Position(1.0, 1.0)));
+    way.nodes().add(Osmium::OSM::WayNode(1, Osmium::OSM::Position(0.0, 0.0)));
+    BOOST_CHECK(formatter.add(Osmium::OSM::Area(way)));
+    out.clear();
+    formatter.format(2, out);
+    BOOST_CHECK_EQUAL(out, "{\"type\":\"Feature\",\"id\":\"w3\",\"properties\":{},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[[0,0],[1,1],[0,1],[0,0]]]}}");
+
+    // features are formatted from the copy made in add()
+    n->tags().clear();
+    n->position(Osmium::OSM::Position(9.0, 9.0));
+    out.clear();
+    formatter.format(0, out);
+    BOOST_CHECK_EQUAL(out, "{\"type\":\"Feature\",\"id\":\"n7\",\"properties\":{\"name\":\"x\",\"note\":\"a \\\"b\\\"\"},\"geometry\":{\"type\":\"Point\",\"coordinates\":[1.5,-2.25]}}");
+
+    formatter.clear();
+    BOOST_CHECK(formatter.empty());
+}
+
+BOOST_AUTO_TEST_CASE(objects_not_kept) {
+    // the same way object is changed after each call, blocks are
+    // formatted in a worker thread
+    {
+        GeoJSON writer(filename, GeoJSON::newline_delimited, 1, 2);
+        shared_ptr<Osmium::OSM::Way> way = make_shared<Osmium::OSM::Way>();
+        for (int i = 1; i <= 5; ++i) {
+            way->id(i);
+            way->nodes().clear();
+            way->nodes().add(Osmium::OSM::WayNode(1, Osmium::OSM::Position(0.0, 0.0)));
+            way->nodes().add(Osmium::OSM::WayNode(2, Osmium::OSM::Position(static_cast<double>(i), 0.0)));
+            writer.way(way);
+        }
+        writer.close();
+        BOOST_CHECK_EQUAL(writer.features(), 5u);
+    }
+    std::ostringstream expected;
+    for (int i = 1; i <= 5; ++i) {
+        expected << "{\"type\":\"Feature\",\"id\":\"w" << i
+                 << "\",\"properties\":{},\"geometry\":{\"type\":\"LineString\",\"coordinates\":[[0,0],[" << i << ",0]]}}\n";
+    }
+    BOOST_CHECK_EQUAL(read_file(), expected.str());
+}
+
+BOOST_AUTO_TEST_CASE(newline_delimited) {
+    {
+        GeoJSON writer(filename);
+        writer.node(node(1, 1.0, 2.0));
+        writer.node(make_shared<Osmium::OSM::Node>());
+        writer.node(node(2, 3.0, 4.0));
+        writer.close();
+        BOOST_CHECK_EQUAL(writer.features(), 2u);
+        BOOST_CHECK_EQUAL(writer.skipped(), 1u);
+    }
+    BOOST_CHECK_EQUAL(read_file(),
+        "{\"type\":\"Feature\",\"id\":\"n1\",\"properties\":{},\"geometry\":{\"type\":\"Point\",\"coordinates\":[1,2]}}\n"
+        "{\"type\":\"Feature\",\"id\":\"n2\",\"properties\":{},\"geometry\":{\"type\":\"Point\",\"coordinates\":[3,4]}}\n");
+}
+
+BOOST_AUTO_TEST_CASE(feature_collection) {
+    {
+        GeoJSON writer(filename, GeoJSON::feature_collection, 2, 3);
+        for (int i = 1; i <= 10; ++i) {
+            writer.node(node(i, i, 0.0));
+        }
+    }
+    std::ostringstream expected;
+    expected << "{\"type\":\"FeatureCollection\",\"features\":[";
+    for (int i = 1; i <= 10; ++i) {
+        expected << (i == 1 ? "\n" : ",\n")
+                 << "{\"type\":\"Feature\",\"id\":\"n" << i
+                 << "\",\"properties\":{},\"geometry\":{\"type\":\"Point\",\"coordinates\":[" << i << ",0]}}";
+    }
+    expected << "\n]}\n";
+    BOOST_CHECK_EQUAL(read_file(), expected.str());
+}
+
+BOOST_AUTO_TEST_CASE(empty_feature_collection) {
+    {
+        GeoJSON writer(filename, GeoJSON::feature_collection);
+    }
+    BOOST_CHECK_EQUAL(read_file(), "{\"type\":\"FeatureCollection\",\"features\":[\n]}\n");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,58 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+#include <osmium/export/output_file.hpp>
+
+BOOST_AUTO_TEST_SUITE(OutputFile)
+
+static const char* filename = "test_output_file.tmp";
+
+std::string read_file() {
+    std::ifstream in(filename, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    unlink(filename);
+    return data;
+}
+
+BOOST_AUTO_TEST_CASE(buffered_writes) {
+    {
+        Osmium::Export::OutputFile output(filename, 4);
+        output.buffer().append("abc");
+        output.flush_if_full();
+        BOOST_CHECK_EQUAL(output.buffer(), "abc");
+        output.buffer().append("de");
+        output.flush_if_full();
+        BOOST_CHECK(output.buffer().empty());
+        output.buffer().append("f");
+        output.write("ghi");
+        BOOST_CHECK_EQUAL(output.offset(), 9u);
+        output.buffer().append("jk");
+        BOOST_CHECK_EQUAL(output.offset(), 11u);
+        output.close();
+        BOOST_CHECK(!output.is_open());
+    }
+    BOOST_CHECK_EQUAL(read_file(), "abcdefghijk");
+}
+
+BOOST_AUTO_TEST_CASE(write_at) {
+    {
+        Osmium::Export::OutputFile output(filename);
+        output.buffer().append("xx0123");
+        output.write_at("ab", 0);
+        BOOST_CHECK_EQUAL(output.offset(), 2u);
+    }
+    BOOST_CHECK_EQUAL(read_file(), "ab0123");
+}
+
+BOOST_AUTO_TEST_CASE(open_failure) {
+    BOOST_CHECK_THROW(Osmium::Export::OutputFile("does-not-exist/test_output_file.tmp"), Osmium::OSMFile::IOError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,81 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+#include <osmium/export/pg_copy.hpp>
+
+BOOST_AUTO_TEST_SUITE(PgCopy)
+
+static const char* filename = "test_pg_copy.tmp";
+
+std::string read_file() {
+    std::ifstream in(filename, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    unlink(filename);
+    return data;
+}
+
+const std::string header("PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0", 19);
+const std::string trailer("\377\377", 2);
+
+BOOST_AUTO_TEST_CASE(empty) {
+    {
+        Osmium::Export::PgCopy copy(filename);
+    }
+    BOOST_CHECK(read_file() == header + trailer);
+}
+
+BOOST_AUTO_TEST_CASE(hstore) {
+    Osmium::OSM::TagList tags;
+    tags.add("a", "b");
+    tags.add("cd", "");
+
+    Osmium::Export::PgCopy copy(filename);
+    copy.row(-2, tags, Osmium::Geometry::Point(Osmium::OSM::Position(1.0, 2.0)));
+    copy.begin_row(2);
+    copy.add_null();
+    copy.add_text("xy");
+    copy.end_row();
+    BOOST_CHECK_EQUAL(copy.rows(), 2u);
+    copy.close();
+
+    std::string expected = header;
+    expected += std::string("\0\3", 2);
+    expected += std::string("\0\0\0\x08\xff\xff\xff\xff\xff\xff\xff\xfe", 12);
+    expected += std::string("\0\0\0\x18" "\0\0\0\2" "\0\0\0\1a" "\0\0\0\1b" "\0\0\0\2cd" "\0\0\0\0", 28);
+    std::string ewkb;
+    Osmium::Geometry::WKBEncoder(ewkb, false, true).point(Osmium::OSM::Position(1.0, 2.0));
+    BOOST_REQUIRE_EQUAL(ewkb.size(), 25u);
+    expected += std::string("\0\0\0\x19", 4) + ewkb;
+    expected += std::string("\0\2" "\xff\xff\xff\xff" "\0\0\0\2xy", 12);
+    expected += trailer;
+
+    BOOST_CHECK(read_file() == expected);
+}
+
+BOOST_AUTO_TEST_CASE(jsonb) {
+    Osmium::OSM::TagList tags;
+    tags.add("name", "\"A\\B\"\n");
+    tags.add("x", "y");
+
+    Osmium::Export::PgCopy copy(filename, Osmium::Export::PgCopy::tags_as_jsonb);
+    copy.begin_row(1);
+    copy.add_tags(tags);
+    copy.end_row();
+    copy.close();
+
+    const std::string json = "\1{\"name\":\"\\\"A\\\\B\\\"\\n\",\"x\":\"y\"}";
+    std::string expected = header;
+    expected += std::string("\0\1\0\0\0", 5) + static_cast<char>(json.size()) + json;
+    expected += trailer;
+
+    BOOST_CHECK(read_file() == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,58 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include <osmium/export/pg_copy.hpp>
+#include <osmium/geometry/encoder_multipolygon.hpp>
+
+BOOST_AUTO_TEST_SUITE(PgCopyMultiPolygon)
+
+static const char* filename = "test_pg_copy_multipolygon.tmp";
+
+std::string read_file() {
+    std::ifstream in(filename, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    unlink(filename);
+    return data;
+}
+
+const std::string header("PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0", 19);
+const std::string trailer("\377\377", 2);
+
+BOOST_AUTO_TEST_CASE(area) {
+    Osmium::OSM::Way way;
+    way.id(3);
+    way.tags().add("building", "yes");
+    way.nodes().add(Osmium::OSM::WayNode(1, Osmium::OSM::Position(0.0, 0.0)));
+    way.nodes().add(Osmium::OSM::WayNode(2, Osmium::OSM::Position(1.0, 0.0)));
+    way.nodes().add(Osmium::OSM::WayNode(3, Osmium::OSM::Position(1.0, 1.0)));
+    way.nodes().add(Osmium::OSM::WayNode(1, Osmium::OSM::Position(0.0, 0.0)));
+    Osmium::OSM::Area area(way);
+    Osmium::Geometry::MultiPolygon multipolygon(area);
+
+    Osmium::Export::PgCopy copy(filename);
+    copy.row(area.id(), area.tags(), multipolygon);
+    copy.close();
+
+    std::ostringstream ewkb;
+    ewkb << multipolygon.as_WKB(true);
+    BOOST_REQUIRE_EQUAL(ewkb.str().size(), 9u + 4 + 5 + 4 + 4 + 4 * 16);
+
+    std::string expected = header;
+    expected += std::string("\0\3", 2);
+    expected += std::string("\0\0\0\x08\0\0\0\0\0\0\0\x06", 12);
+    expected += std::string("\0\0\0\x17" "\0\0\0\1" "\0\0\0\x08" "building" "\0\0\0\3" "yes", 27);
+    expected += std::string("\0\0\0\x5a", 4) + ewkb.str();
+    expected += trailer;
+
+    BOOST_CHECK(read_file() == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
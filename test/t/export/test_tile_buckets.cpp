@@ -0,0 +1,205 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <geos/geom/Coordinate.h>
+#include <geos/geom/LinearRing.h>
+#include <geos/geom/MultiPolygon.h>
+#include <geos/geom/Polygon.h>
+
+#include <osmium/handler.hpp>
+#include <osmium/export/tile_buckets.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::WayNode;
+using Osmium::Geometry::Tile;
+
+BOOST_AUTO_TEST_SUITE(TileBucketFiles)
+
+class CollectObjects : public Osmium::Handler::Base {
+
+public:
+
+    CollectObjects() :
+        Base(),
+        nodes(),
+        ways(),
+        relations(),
+        areas() {
+    }
+
+    void node(const shared_ptr<Osmium::OSM::Node>& node) {
+        nodes.push_back(node);
+    }
+
+    void way(const shared_ptr<Osmium::OSM::Way>& way) {
+        ways.push_back(way);
+    }
+
+    void relation(const shared_ptr<Osmium::OSM::Relation>& relation) {
+        relations.push_back(relation);
+    }
+
+    void area(const shared_ptr<Osmium::OSM::Area>& area) {
+        areas.push_back(area);
+    }
+
+    std::vector< shared_ptr<Osmium::OSM::Node> > nodes;
+    std::vector< shared_ptr<Osmium::OSM::Way> > ways;
+    std::vector< shared_ptr<Osmium::OSM::Relation> > relations;
+    std::vector< shared_ptr<Osmium::OSM::Area> > areas;
+
+};
+
+static const char* directory = "test_tile_buckets.tmp";
+
+void remove_directory() {
+    boost::filesystem::remove_all(directory);
+}
+
+Osmium::OSM::Node make_node(osm_object_id_t id, double lon, double lat) {
+    Osmium::OSM::Node node;
+    node.id(id);
+    node.position(Position(lon, lat));
+    return node;
+}
+
+std::string bucket(const char* name) {
+    return std::string(directory) + "/" + name + ".osmb";
+}
+
+std::vector<Tile> tiles(const Tile& tile) {
+    return std::vector<Tile>(1, tile);
+}
+
+BOOST_AUTO_TEST_CASE(reopen_files) {
+    remove_directory();
+    const Tile t1(2, 1, 1);
+    const Tile t2(2, 2, 1);
+
+    {
+        Osmium::Export::TileBucketFiles files(directory, 1);
+        files.write(tiles(t1), make_node(1, 1.0, 1.0));
+        files.write(tiles(t2), make_node(2, 2.0, 2.0));
+        files.write(tiles(t1), make_node(3, 3.0, 3.0));
+
+        Osmium::OSM::Way way;
+        way.id(10);
+        way.tags().add("highway", "primary");
+        way.nodes().add(WayNode(1, Position(1.0, 1.0)));
+        way.nodes().add(WayNode(2, Position(2.0, 2.0)));
+        std::vector<Tile> both;
+        both.push_back(t1);
+        both.push_back(t2);
+        files.write(both, way);
+
+        // each change of the tile closes the only open file, only
+        // the way goes into the tile that is still open
+        BOOST_CHECK_EQUAL(4u, files.opens());
+        BOOST_CHECK_EQUAL(4u, files.objects());
+        BOOST_CHECK_EQUAL(5u, files.records());
+        BOOST_CHECK_EQUAL(bucket("2/1/1"), files.filename(t1));
+    }
+
+    CollectObjects collect1;
+    BOOST_CHECK_EQUAL(3u, Osmium::Export::TileBucketFiles::read(bucket("2/1/1"), collect1));
+    BOOST_REQUIRE_EQUAL(2u, collect1.nodes.size());
+    BOOST_CHECK_EQUAL(1, collect1.nodes[0]->id());
+    BOOST_CHECK(collect1.nodes[0]->position() == Position(1.0, 1.0));
+    BOOST_CHECK_EQUAL(3, collect1.nodes[1]->id());
+    BOOST_CHECK(collect1.nodes[1]->position() == Position(3.0, 3.0));
+    BOOST_REQUIRE_EQUAL(1u, collect1.ways.size());
+    BOOST_CHECK_EQUAL(10, collect1.ways[0]->id());
+    BOOST_CHECK_EQUAL(std::string("primary"), collect1.ways[0]->tags().get_value_by_key("highway"));
+    BOOST_REQUIRE_EQUAL(2u, collect1.ways[0]->nodes().size());
+    BOOST_CHECK_EQUAL(2, collect1.ways[0]->nodes()[1].ref());
+
+    CollectObjects collect2;
+    BOOST_CHECK_EQUAL(2u, Osmium::Export::TileBucketFiles::read(bucket("2/2/1"), collect2));
+    BOOST_REQUIRE_EQUAL(1u, collect2.nodes.size());
+    BOOST_CHECK_EQUAL(2, collect2.nodes[0]->id());
+    BOOST_REQUIRE_EQUAL(1u, collect2.ways.size());
+    BOOST_CHECK_EQUAL(10, collect2.ways[0]->id());
+
+    remove_directory();
+}
+
+BOOST_AUTO_TEST_CASE(way_area) {
+    remove_directory();
+
+    Osmium::OSM::Way way;
+    way.id(20);
+    way.version(3);
+    way.tags().add("building", "yes");
+    way.nodes().add(WayNode(1, Position(1.0, 1.0)));
+    way.nodes().add(WayNode(2, Position(2.0, 1.0)));
+    way.nodes().add(WayNode(3, Position(2.0, 2.0)));
+    way.nodes().add(WayNode(1, Position(1.0, 1.0)));
+
+    {
+        Osmium::Export::TileBucketFiles files(directory);
+        files.write(tiles(Tile(0, 0, 0)), Osmium::OSM::Area(way));
+    }
+
+    CollectObjects collect;
+    BOOST_CHECK_EQUAL(1u, Osmium::Export::TileBucketFiles::read(bucket("0/0/0"), collect));
+    BOOST_REQUIRE_EQUAL(1u, collect.areas.size());
+    const Osmium::OSM::Area& area = *collect.areas[0];
+    BOOST_CHECK(area.from_way());
+    BOOST_CHECK_EQUAL(20, area.orig_id());
+    BOOST_CHECK_EQUAL(3, area.version());
+    BOOST_CHECK_EQUAL(std::string("yes"), area.tags().get_value_by_key("building"));
+    BOOST_REQUIRE_EQUAL(4u, area.nodes().size());
+    BOOST_CHECK_EQUAL(2, area.nodes()[1].ref());
+    BOOST_CHECK(area.nodes()[2].position() == Position(2.0, 2.0));
+
+    remove_directory();
+}
+
+BOOST_AUTO_TEST_CASE(relation_area) {
+    remove_directory();
+
+    std::vector<geos::geom::Coordinate>* coordinates = new std::vector<geos::geom::Coordinate>();
+    coordinates->push_back(geos::geom::Coordinate(1, 1));
+    coordinates->push_back(geos::geom::Coordinate(4, 1));
+    coordinates->push_back(geos::geom::Coordinate(4, 3));
+    coordinates->push_back(geos::geom::Coordinate(1, 1));
+    geos::geom::GeometryFactory* factory = Osmium::Geometry::geos_geometry_factory();
+    geos::geom::LinearRing* shell = factory->createLinearRing(factory->getCoordinateSequenceFactory()->create(coordinates));
+    std::vector<geos::geom::Geometry*>* polygons = new std::vector<geos::geom::Geometry*>();
+    polygons->push_back(factory->createPolygon(shell, NULL));
+
+    Osmium::OSM::Relation relation;
+    relation.id(30);
+    relation.tags().add("natural", "water");
+    Osmium::OSM::Area area(relation);
+    area.geos_geometry(factory->createMultiPolygon(polygons));
+
+    {
+        Osmium::Export::TileBucketFiles files(directory);
+        files.write(tiles(Tile(0, 0, 0)), area);
+    }
+
+    CollectObjects collect;
+    BOOST_CHECK_EQUAL(1u, Osmium::Export::TileBucketFiles::read(bucket("0/0/0"), collect));
+    BOOST_REQUIRE_EQUAL(1u, collect.areas.size());
+    const Osmium::OSM::Area& read_area = *collect.areas[0];
+    BOOST_CHECK(!read_area.from_way());
+    BOOST_CHECK_EQUAL(30, read_area.orig_id());
+    BOOST_CHECK_EQUAL(std::string("water"), read_area.tags().get_value_by_key("natural"));
+
+    const geos::geom::MultiPolygon* geometry = Osmium::Geometry::MultiPolygon(read_area).borrow_geos_geometry();
+    BOOST_CHECK(geometry->equalsExact(Osmium::Geometry::MultiPolygon(area).borrow_geos_geometry()));
+    BOOST_CHECK_CLOSE(3.0, geometry->getArea(), 0.0001);
+
+    remove_directory();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
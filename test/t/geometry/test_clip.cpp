@@ -0,0 +1,131 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include <osmium/osm/position.hpp>
+#include <osmium/osm/way_node_list.hpp>
+#include <osmium/geometry/clip.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::WayNode;
+using Osmium::OSM::WayNodeList;
+using Osmium::Geometry::Clip::ConvexRegion;
+
+BOOST_AUTO_TEST_SUITE(Clip)
+
+ConvexRegion box() {
+    Osmium::OSM::Bounds bounds;
+    bounds.extend(Position(0, 0)).extend(Position(10, 10));
+    return ConvexRegion(bounds);
+}
+
+BOOST_AUTO_TEST_CASE(contains) {
+    const ConvexRegion region = box();
+    BOOST_CHECK(region.contains(Position(5, 5)));
+    BOOST_CHECK(region.contains(Position(0, 10)));
+    BOOST_CHECK(!region.contains(Position(11, 5)));
+
+    std::vector<Position> triangle;
+    triangle.push_back(Position(0, 0));
+    triangle.push_back(Position(0, 10));
+    triangle.push_back(Position(10, 0));
+    const ConvexRegion region2(triangle.begin(), triangle.end());
+    BOOST_CHECK(region2.contains(Position(2, 2)));
+    BOOST_CHECK(!region2.contains(Position(6, 6)));
+}
+
+BOOST_AUTO_TEST_CASE(not_convex) {
+    std::vector<Position> polygon;
+    polygon.push_back(Position(0, 0));
+    polygon.push_back(Position(10, 0));
+    polygon.push_back(Position(5, 2));
+    polygon.push_back(Position(10, 10));
+    polygon.push_back(Position(0, 10));
+    BOOST_CHECK_THROW(ConvexRegion(polygon.begin(), polygon.end()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(clip_line) {
+    // goes in, out, and in again
+    WayNodeList nodes;
+    nodes.add(WayNode(1, Position(-10, 5)));
+    nodes.add(WayNode(2, Position(5, 5)));
+    nodes.add(WayNode(3, Position(5, 20)));
+    nodes.add(WayNode(4, Position(8, 20)));
+    nodes.add(WayNode(5, Position(8, 8)));
+
+    std::vector<WayNodeList> pieces;
+    BOOST_CHECK_EQUAL(box().clip_line(nodes.begin(), nodes.end(), pieces), 2);
+
+    BOOST_CHECK_EQUAL(pieces[0].size(), 3);
+    BOOST_CHECK_EQUAL(pieces[0][0].ref(), 0);
+    BOOST_CHECK_EQUAL(pieces[0][0].position(), Position(0, 5));
+    BOOST_CHECK_EQUAL(pieces[0][1].ref(), 2);
+    BOOST_CHECK_EQUAL(pieces[0][2].position(), Position(5, 10));
+
+    BOOST_CHECK_EQUAL(pieces[1].size(), 2);
+    BOOST_CHECK_EQUAL(pieces[1][0].position(), Position(8, 10));
+    BOOST_CHECK_EQUAL(pieces[1][1].ref(), 5);
+
+    std::vector< std::vector<Position> > outside;
+    std::vector<Position> line;
+    line.push_back(Position(20, 20));
+    line.push_back(Position(30, 20));
+    BOOST_CHECK_EQUAL(box().clip_line(line.begin(), line.end(), outside), 0);
+
+    // touching the corner only
+    line[0] = Position(-5, 15);
+    line[1] = Position(5, 5);
+    line.push_back(Position(15, 15));
+    BOOST_CHECK_EQUAL(box().clip_line(line.begin(), line.end(), outside), 1);
+    line[1] = Position(0, 10);
+    line[2] = Position(5, 15);
+    outside.clear();
+    BOOST_CHECK_EQUAL(box().clip_line(line.begin(), line.end(), outside), 0);
+}
+
+BOOST_AUTO_TEST_CASE(clip_ring) {
+    WayNodeList ring;
+    ring.add(WayNode(1, Position(5, 5)));
+    ring.add(WayNode(2, Position(15, 5)));
+    ring.add(WayNode(3, Position(15, 15)));
+    ring.add(WayNode(4, Position(5, 15)));
+    ring.add(WayNode(1, Position(5, 5)));
+
+    WayNodeList out;
+    BOOST_CHECK(box().clip_ring(ring.begin(), ring.end(), out));
+    BOOST_CHECK_EQUAL(out.size(), 5);
+    BOOST_CHECK(out.is_closed());
+    int original_nodes = 0;
+    for (WayNodeList::const_iterator it = out.begin(); it != out.end(); ++it) {
+        if (it->ref() == 1) {
+            ++original_nodes;
+        }
+    }
+    BOOST_CHECK_EQUAL(original_nodes, 1);
+    BOOST_CHECK_CLOSE(Osmium::Geometry::Ring::signed_area(out.begin(), out.end()), 50.0, 0.0001);
+
+    // ring containing the whole region
+    std::vector<Position> big;
+    big.push_back(Position(-5, -5));
+    big.push_back(Position(15, -5));
+    big.push_back(Position(15, 15));
+    big.push_back(Position(-5, 15));
+    big.push_back(Position(-5, -5));
+    std::vector<Position> clipped;
+    BOOST_CHECK(box().clip_ring(big.begin(), big.end(), clipped));
+    BOOST_CHECK_EQUAL(clipped.size(), 5);
+    BOOST_CHECK_CLOSE(Osmium::Geometry::Ring::signed_area(clipped.begin(), clipped.end()), 200.0, 0.0001);
+
+    // ring outside
+    for (std::vector<Position>::iterator it = big.begin(); it != big.end(); ++it) {
+        *it = Position(it->x() + 100, it->y());
+    }
+    BOOST_CHECK(!box().clip_ring(big.begin(), big.end(), clipped));
+    BOOST_CHECK(clipped.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
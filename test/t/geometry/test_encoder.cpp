@@ -0,0 +1,88 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+
+#include <osmium/geometry/encoder.hpp>
+
+using Osmium::OSM::Position;
+
+BOOST_AUTO_TEST_SUITE(Encoder)
+
+std::string format(int32_t value) {
+    char buffer[20];
+    return std::string(buffer, Osmium::Geometry::WKTEncoder::format_coordinate(buffer, value));
+}
+
+BOOST_AUTO_TEST_CASE(format_coordinate) {
+    BOOST_CHECK_EQUAL(format(0), "0");
+    BOOST_CHECK_EQUAL(format(10000000), "1");
+    BOOST_CHECK_EQUAL(format(-10000000), "-1");
+    BOOST_CHECK_EQUAL(format(12345678), "1.2345678");
+    BOOST_CHECK_EQUAL(format(15000000), "1.5");
+    BOOST_CHECK_EQUAL(format(-1799999999), "-179.9999999");
+    BOOST_CHECK_EQUAL(format(1800000000), "180");
+    BOOST_CHECK_EQUAL(format(-1800000000), "-180");
+    BOOST_CHECK_EQUAL(format(1), "0.0000001");
+    BOOST_CHECK_EQUAL(format(-100), "-0.00001");
+    BOOST_CHECK_EQUAL(format(-2147483647 - 1), "-214.7483648");
+}
+
+Osmium::OSM::WayNodeList make_nodes() {
+    Osmium::OSM::WayNodeList nodes;
+    nodes.add(Osmium::OSM::WayNode(1, Position(3.2, 4.2)));
+    nodes.add(Osmium::OSM::WayNode(2, Position(3.5, 4.7)));
+    nodes.add(Osmium::OSM::WayNode(3, Position(-3.6, 4.9)));
+    nodes.add(Osmium::OSM::WayNode(1, Position(3.2, 4.2)));
+    return nodes;
+}
+
+template <class TGeometry>
+void check_same_as_stream(const TGeometry& geometry) {
+    for (int with_srid = 0; with_srid < 2; ++with_srid) {
+        std::ostringstream wkb;
+        wkb << geometry.as_WKB(with_srid);
+        std::string buffer = "x";
+        Osmium::Geometry::WKBEncoder(buffer, false, with_srid).encode(geometry);
+        BOOST_CHECK(buffer == "x" + wkb.str());
+
+        std::ostringstream hex;
+        hex << geometry.as_HexWKB(with_srid);
+        buffer.clear();
+        Osmium::Geometry::WKBEncoder(buffer, true, with_srid).encode(geometry);
+        BOOST_CHECK_EQUAL(buffer, hex.str());
+
+        std::ostringstream wkt;
+        wkt << geometry.as_WKT(with_srid);
+        buffer.clear();
+        Osmium::Geometry::WKTEncoder(buffer, with_srid).encode(geometry);
+        BOOST_CHECK_EQUAL(buffer, wkt.str());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(same_as_stream) {
+    check_same_as_stream(Osmium::Geometry::Point(Position(1.2, -3.4567891)));
+
+    Osmium::OSM::WayNodeList nodes = make_nodes();
+    check_same_as_stream(Osmium::Geometry::LineString(nodes));
+    check_same_as_stream(Osmium::Geometry::LineString(nodes, true));
+    check_same_as_stream(Osmium::Geometry::Polygon(nodes));
+}
+
+BOOST_AUTO_TEST_CASE(append) {
+    Osmium::OSM::WayNodeList nodes = make_nodes();
+    std::string buffer;
+    Osmium::Geometry::WKTEncoder encoder(buffer);
+    encoder.point(Position(1.0, 2.0));
+    encoder.multipolygon(nodes.begin(), nodes.end());
+    BOOST_CHECK_EQUAL(buffer, "POINT(1 2)MULTIPOLYGON(((3.2 4.2,3.5 4.7,-3.6 4.9,3.2 4.2)))");
+
+    std::string hex;
+    Osmium::Geometry::WKBEncoder(hex, true).linestring(nodes.begin(), nodes.begin());
+    BOOST_CHECK_EQUAL(hex, "010200000000000000");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
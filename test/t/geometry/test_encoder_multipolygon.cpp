@@ -0,0 +1,90 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+
+#include <osmium/geometry/encoder_multipolygon.hpp>
+
+using Osmium::OSM::Position;
+
+BOOST_AUTO_TEST_SUITE(EncoderMultiPolygon)
+
+Osmium::OSM::WayNodeList make_nodes() {
+    Osmium::OSM::WayNodeList nodes;
+    nodes.add(Osmium::OSM::WayNode(1, Position(3.2, 4.2)));
+    nodes.add(Osmium::OSM::WayNode(2, Position(3.5, 4.7)));
+    nodes.add(Osmium::OSM::WayNode(3, Position(-3.6, 4.9)));
+    nodes.add(Osmium::OSM::WayNode(1, Position(3.2, 4.2)));
+    return nodes;
+}
+
+template <class TGeometry>
+void check_same_as_stream(const TGeometry& geometry) {
+    for (int with_srid = 0; with_srid < 2; ++with_srid) {
+        std::ostringstream wkb;
+        wkb << geometry.as_WKB(with_srid);
+        std::string buffer = "x";
+        Osmium::Geometry::WKBEncoder wkb_encoder(buffer, false, with_srid);
+        Osmium::Geometry::encode(wkb_encoder, geometry);
+        BOOST_CHECK(buffer == "x" + wkb.str());
+
+        std::ostringstream hex;
+        hex << geometry.as_HexWKB(with_srid);
+        buffer.clear();
+        Osmium::Geometry::WKBEncoder hex_encoder(buffer, true, with_srid);
+        Osmium::Geometry::encode(hex_encoder, geometry);
+        BOOST_CHECK_EQUAL(buffer, hex.str());
+
+        std::ostringstream wkt;
+        wkt << geometry.as_WKT(with_srid);
+        buffer.clear();
+        Osmium::Geometry::WKTEncoder wkt_encoder(buffer, with_srid);
+        Osmium::Geometry::encode(wkt_encoder, geometry);
+        BOOST_CHECK_EQUAL(buffer, wkt.str());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(way_and_relation_areas) {
+    Osmium::OSM::Way way;
+    way.id(7);
+    way.nodes() = make_nodes();
+    const std::string wkt = "MULTIPOLYGON(((3.2 4.2,3.5 4.7,-3.6 4.9,3.2 4.2)))";
+
+    // area from way, written from the node list
+    Osmium::OSM::Area way_area(way);
+    Osmium::Geometry::MultiPolygon way_multipolygon(way_area);
+    BOOST_CHECK(way_multipolygon.from_nodes());
+    check_same_as_stream(way_multipolygon);
+
+    // area from relation, written from the GEOS geometry
+    Osmium::OSM::Relation relation;
+    relation.id(8);
+    Osmium::OSM::Area relation_area(relation);
+    relation_area.geos_geometry(dynamic_cast<geos::geom::MultiPolygon*>(way_multipolygon.borrow_geos_geometry()->clone()));
+    Osmium::Geometry::MultiPolygon relation_multipolygon(relation_area);
+    BOOST_CHECK(!relation_multipolygon.from_nodes());
+
+    std::string way_wkb;
+    Osmium::Geometry::WKBEncoder way_encoder(way_wkb, false, true);
+    Osmium::Geometry::encode(way_encoder, way_multipolygon);
+    std::ostringstream relation_wkb;
+    relation_wkb << relation_multipolygon.as_WKB(true);
+    std::string buffer;
+    Osmium::Geometry::WKBEncoder encoder(buffer, false, true);
+    Osmium::Geometry::encode(encoder, relation_multipolygon);
+    BOOST_CHECK(buffer == relation_wkb.str());
+    BOOST_CHECK(buffer == way_wkb);
+
+    buffer.clear();
+    Osmium::Geometry::WKTEncoder wkt_encoder(buffer);
+    Osmium::Geometry::encode(wkt_encoder, way_multipolygon);
+    BOOST_CHECK_EQUAL(buffer, wkt);
+    buffer.clear();
+    Osmium::Geometry::encode(wkt_encoder, relation_multipolygon);
+    BOOST_CHECK_EQUAL(buffer, wkt);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,71 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include <osmium/osm/way_node_list.hpp>
+#include <osmium/geometry/projection.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::WayNode;
+
+BOOST_AUTO_TEST_SUITE(Projection)
+
+BOOST_AUTO_TEST_CASE(scalar) {
+    BOOST_CHECK_EQUAL(Osmium::Geometry::Mercator::lon_to_x(0), 0.0);
+    BOOST_CHECK_CLOSE(Osmium::Geometry::Mercator::lon_to_x(180), Osmium::Geometry::Mercator::MAX_COORDINATE, 0.0000001);
+    BOOST_CHECK_SMALL(Osmium::Geometry::Mercator::lat_to_y(0), 0.000001);
+    BOOST_CHECK_CLOSE(Osmium::Geometry::Mercator::lat_to_y(Osmium::Geometry::Mercator::MAX_LATITUDE), Osmium::Geometry::Mercator::MAX_COORDINATE, 0.0000001);
+    BOOST_CHECK_CLOSE(Osmium::Geometry::Mercator::lat_to_y(89), Osmium::Geometry::Mercator::MAX_COORDINATE, 0.0000001);
+    BOOST_CHECK_CLOSE(Osmium::Geometry::Mercator::lat_to_y(45), 5621521.486192066, 0.0000001);
+    BOOST_CHECK_CLOSE(Osmium::Geometry::Mercator::y_to_lat(5621521.486192066), 45.0, 0.0000001);
+}
+
+BOOST_AUTO_TEST_CASE(batch_accuracy) {
+    std::vector<double> lon;
+    std::vector<double> lat;
+    for (int i = -1000; i <= 1000; ++i) {
+        lon.push_back(i * 0.18);
+        lat.push_back(i * 0.0851);
+    }
+    const size_t count = lon.size();
+
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    Osmium::Geometry::Mercator::project(count, &lon[0], &lat[0], &x[0], &y[0]);
+
+    std::vector<double> lon2(count);
+    std::vector<double> lat2(count);
+    Osmium::Geometry::Mercator::unproject(count, &x[0], &y[0], &lon2[0], &lat2[0]);
+
+    for (size_t i = 0; i < count; ++i) {
+        BOOST_CHECK_SMALL(x[i] - Osmium::Geometry::Mercator::lon_to_x(lon[i]), 0.000001);
+        BOOST_CHECK_SMALL(y[i] - Osmium::Geometry::Mercator::lat_to_y(lat[i]), 0.000001);
+        BOOST_CHECK_SMALL(lon2[i] - lon[i], 0.000000000001);
+        BOOST_CHECK_SMALL(lat2[i] - Osmium::Geometry::Mercator::y_to_lat(y[i]), 0.000000000001);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(way_node_list) {
+    Osmium::OSM::WayNodeList nodes;
+    for (int i = 0; i < 600; ++i) {
+        nodes.add(WayNode(i, Position(i * 0.1, i * 0.1 - 30)));
+    }
+
+    std::vector<double> x(1, 0.0);
+    std::vector<double> y(1, 0.0);
+    Osmium::Geometry::Mercator::project(nodes.begin(), nodes.end(), x, y);
+    BOOST_REQUIRE_EQUAL(x.size(), 601);
+    BOOST_REQUIRE_EQUAL(y.size(), 601);
+    x.erase(x.begin());
+    y.erase(y.begin());
+    for (int i = 0; i < 600; ++i) {
+        BOOST_CHECK_SMALL(x[i] - Osmium::Geometry::Mercator::lon_to_x(nodes[i].position().lon()), 0.000001);
+        BOOST_CHECK_SMALL(y[i] - Osmium::Geometry::Mercator::lat_to_y(nodes[i].position().lat()), 0.000001);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,78 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include <osmium/osm/position.hpp>
+#include <osmium/osm/way_node_list.hpp>
+#include <osmium/geometry/ring.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::WayNode;
+
+BOOST_AUTO_TEST_SUITE(Ring)
+
+BOOST_AUTO_TEST_CASE(signed_area) {
+    std::vector<Position> ring;
+    ring.push_back(Position(0, 0));
+    ring.push_back(Position(1, 0));
+    ring.push_back(Position(1, 1));
+    ring.push_back(Position(0, 1));
+    ring.push_back(Position(0, 0));
+
+    // twice the area in coordinate units
+    BOOST_CHECK_CLOSE(Osmium::Geometry::Ring::signed_area(ring.begin(), ring.end()), 2.0, 0.0001);
+    BOOST_CHECK(Osmium::Geometry::Ring::is_ccw(ring.begin(), ring.end()));
+
+    BOOST_CHECK_CLOSE(Osmium::Geometry::Ring::signed_area(ring.rbegin(), ring.rend()), -2.0, 0.0001);
+    BOOST_CHECK(!Osmium::Geometry::Ring::is_ccw(ring.rbegin(), ring.rend()));
+
+    std::vector<Position> empty;
+    BOOST_CHECK_EQUAL(Osmium::Geometry::Ring::signed_area(empty.begin(), empty.end()), 0);
+}
+
+BOOST_AUTO_TEST_CASE(way_nodes) {
+    Osmium::OSM::WayNodeList nodes;
+    nodes.add(WayNode(1, Position(0, 0)));
+    nodes.add(WayNode(2, Position(0, 1)));
+    nodes.add(WayNode(3, Position(1, 1)));
+    nodes.add(WayNode(4, Position(1, 0)));
+    nodes.add(WayNode(1, Position(0, 0)));
+
+    BOOST_CHECK(!Osmium::Geometry::Ring::is_ccw(nodes.begin(), nodes.end()));
+    BOOST_CHECK(Osmium::Geometry::Ring::is_simple(nodes.begin(), nodes.end()));
+}
+
+BOOST_AUTO_TEST_CASE(is_simple) {
+    std::vector<Position> ring;
+    ring.push_back(Position(0, 0));
+    ring.push_back(Position(2, 0));
+    ring.push_back(Position(2, 2));
+    ring.push_back(Position(0, 2));
+    ring.push_back(Position(0, 0));
+    BOOST_CHECK(Osmium::Geometry::Ring::is_simple(ring.begin(), ring.end()));
+
+    // bow tie
+    std::vector<Position> bowtie;
+    bowtie.push_back(Position(0, 0));
+    bowtie.push_back(Position(2, 2));
+    bowtie.push_back(Position(2, 0));
+    bowtie.push_back(Position(0, 2));
+    bowtie.push_back(Position(0, 0));
+    BOOST_CHECK(!Osmium::Geometry::Ring::is_simple(bowtie.begin(), bowtie.end()));
+
+    // ring going through the same position twice
+    std::vector<Position> touching;
+    touching.push_back(Position(0, 0));
+    touching.push_back(Position(2, 0));
+    touching.push_back(Position(1, 1));
+    touching.push_back(Position(2, 2));
+    touching.push_back(Position(0, 2));
+    touching.push_back(Position(1, 1));
+    touching.push_back(Position(0, 0));
+    BOOST_CHECK(!Osmium::Geometry::Ring::is_simple(touching.begin(), touching.end()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,94 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include <osmium/osm/position.hpp>
+#include <osmium/geometry/segment_intersections.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::UndirectedSegment;
+
+BOOST_AUTO_TEST_SUITE(SegmentIntersections)
+
+BOOST_AUTO_TEST_CASE(orientation) {
+    BOOST_CHECK_EQUAL(Osmium::Geometry::orientation(Position(0, 0), Position(1, 0), Position(1, 1)), 1);
+    BOOST_CHECK_EQUAL(Osmium::Geometry::orientation(Position(0, 0), Position(1, 0), Position(1, -1)), -1);
+    BOOST_CHECK_EQUAL(Osmium::Geometry::orientation(Position(0, 0), Position(1, 0), Position(2, 0)), 0);
+
+    // extreme coordinates must not overflow
+    BOOST_CHECK_EQUAL(Osmium::Geometry::orientation(Position(-180, -90), Position(180, 90), Position(-180, 90)), 1);
+    BOOST_CHECK_EQUAL(Osmium::Geometry::orientation(Position(-180, -90), Position(180, 90), Position(180, -90)), -1);
+}
+
+BOOST_AUTO_TEST_CASE(segments_intersect) {
+    // crossing
+    BOOST_CHECK(Osmium::Geometry::segments_intersect(UndirectedSegment(Position(0, 0), Position(2, 2)), UndirectedSegment(Position(0, 2), Position(2, 0))));
+
+    // disjoint
+    BOOST_CHECK(!Osmium::Geometry::segments_intersect(UndirectedSegment(Position(0, 0), Position(1, 1)), UndirectedSegment(Position(0, 2), Position(1, 3))));
+
+    // common end point
+    BOOST_CHECK(!Osmium::Geometry::segments_intersect(UndirectedSegment(Position(0, 0), Position(1, 1)), UndirectedSegment(Position(1, 1), Position(2, 0))));
+    BOOST_CHECK(!Osmium::Geometry::segments_intersect(UndirectedSegment(Position(0, 0), Position(1, 1)), UndirectedSegment(Position(1, 1), Position(2, 2))));
+
+    // end point of one segment in the middle of the other
+    BOOST_CHECK(Osmium::Geometry::segments_intersect(UndirectedSegment(Position(0, 0), Position(2, 0)), UndirectedSegment(Position(1, 0), Position(1, 1))));
+
+    // collinear overlapping
+    BOOST_CHECK(Osmium::Geometry::segments_intersect(UndirectedSegment(Position(0, 0), Position(2, 0)), UndirectedSegment(Position(1, 0), Position(3, 0))));
+    BOOST_CHECK(Osmium::Geometry::segments_intersect(UndirectedSegment(Position(0, 0), Position(2, 0)), UndirectedSegment(Position(0, 0), Position(1, 0))));
+    BOOST_CHECK(Osmium::Geometry::segments_intersect(UndirectedSegment(Position(0, 0), Position(2, 0)), UndirectedSegment(Position(2, 0), Position(0, 0))));
+
+    // collinear disjoint
+    BOOST_CHECK(!Osmium::Geometry::segments_intersect(UndirectedSegment(Position(0, 0), Position(1, 0)), UndirectedSegment(Position(2, 0), Position(3, 0))));
+}
+
+BOOST_AUTO_TEST_CASE(simple_ring) {
+    std::vector<Position> ring;
+    ring.push_back(Position(0, 0));
+    ring.push_back(Position(1, 0));
+    ring.push_back(Position(1, 1));
+    ring.push_back(Position(0, 1));
+    ring.push_back(Position(0, 0));
+
+    Osmium::Geometry::SegmentIntersections si;
+    si.add(ring.begin(), ring.end());
+    BOOST_CHECK_EQUAL(si.size(), 4u);
+    BOOST_CHECK(!si.any());
+    BOOST_CHECK_EQUAL(si.find(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(bowtie) {
+    std::vector<Position> ring;
+    ring.push_back(Position(0, 0));
+    ring.push_back(Position(1, 1));
+    ring.push_back(Position(1, 0));
+    ring.push_back(Position(0, 1));
+    ring.push_back(Position(0, 0));
+
+    Osmium::Geometry::SegmentIntersections si;
+    si.add(ring.begin(), ring.end());
+    BOOST_CHECK(si.any());
+    BOOST_REQUIRE_EQUAL(si.find(), 1u);
+    BOOST_CHECK(si.intersections()[0].first == UndirectedSegment(Position(0, 0), Position(1, 1)));
+    BOOST_CHECK(si.intersections()[0].second == UndirectedSegment(Position(0, 1), Position(1, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(spike) {
+    std::vector<Position> ring;
+    ring.push_back(Position(0, 0));
+    ring.push_back(Position(2, 0));
+    ring.push_back(Position(3, 0));
+    ring.push_back(Position(2, 0));
+    ring.push_back(Position(1, 1));
+    ring.push_back(Position(0, 0));
+
+    Osmium::Geometry::SegmentIntersections si;
+    si.add(ring.begin(), ring.end());
+    BOOST_CHECK(si.any());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
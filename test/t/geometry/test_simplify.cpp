@@ -0,0 +1,121 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <osmium/osm/position.hpp>
+#include <osmium/osm/way_node_list.hpp>
+#include <osmium/geometry/simplify.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::WayNode;
+using Osmium::OSM::WayNodeList;
+
+BOOST_AUTO_TEST_SUITE(Simplify)
+
+WayNodeList make_nodes(const int* coordinates, int count) {
+    WayNodeList nodes;
+    for (int i = 0; i < count; ++i) {
+        nodes.add(WayNode(i + 1, Position(coordinates[2*i], coordinates[2*i+1])));
+    }
+    return nodes;
+}
+
+std::vector<osm_object_id_t> refs(const WayNodeList& nodes) {
+    std::vector<osm_object_id_t> result;
+    for (WayNodeList::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        result.push_back(it->ref());
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(distance_squared) {
+    BOOST_CHECK_EQUAL(Osmium::Geometry::Simplify::distance_squared(Position(5, 3), Position(0, 0), Position(10, 0)), 9.0);
+    BOOST_CHECK_EQUAL(Osmium::Geometry::Simplify::distance_squared(Position(-3, 4), Position(0, 0), Position(10, 0)), 25.0);
+    BOOST_CHECK_EQUAL(Osmium::Geometry::Simplify::distance_squared(Position(13, 4), Position(0, 0), Position(10, 0)), 25.0);
+    BOOST_CHECK_EQUAL(Osmium::Geometry::Simplify::distance_squared(Position(3, 4), Position(0, 0), Position(0, 0)), 25.0);
+}
+
+BOOST_AUTO_TEST_CASE(douglas_peucker) {
+    const int coordinates[] = { 0,0, 10,1, 20,0, 30,50, 40,0, 50,-1, 60,0 };
+    WayNodeList nodes = make_nodes(coordinates, 7);
+    WayNodeList out;
+
+    Osmium::Geometry::Simplify::simplify(nodes, Osmium::Geometry::Simplify::DOUGLAS_PEUCKER, 2, out);
+    const osm_object_id_t expected[] = { 1, 3, 4, 5, 7 };
+    const std::vector<osm_object_id_t> result = refs(out);
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), expected, expected + 5);
+
+    Osmium::Geometry::Simplify::simplify(nodes, Osmium::Geometry::Simplify::DOUGLAS_PEUCKER, 0.5, out);
+    BOOST_CHECK_EQUAL(out.size(), 7);
+
+    Osmium::Geometry::Simplify::simplify(nodes, Osmium::Geometry::Simplify::DOUGLAS_PEUCKER, 100, out);
+    BOOST_CHECK_EQUAL(out.size(), 2);
+    BOOST_CHECK_EQUAL(out[0].ref(), 1);
+    BOOST_CHECK_EQUAL(out[1].ref(), 7);
+}
+
+BOOST_AUTO_TEST_CASE(visvalingam_whyatt) {
+    const int coordinates[] = { 0,0, 10,1, 20,0, 30,50, 40,0, 50,-1, 60,0 };
+    WayNodeList nodes = make_nodes(coordinates, 7);
+    WayNodeList out;
+
+    // triangles at nodes 2 and 6 have area 10
+    Osmium::Geometry::Simplify::simplify(nodes, Osmium::Geometry::Simplify::VISVALINGAM_WHYATT, 4, out);
+    const osm_object_id_t expected[] = { 1, 3, 4, 5, 7 };
+    const std::vector<osm_object_id_t> result = refs(out);
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), expected, expected + 5);
+
+    Osmium::Geometry::Simplify::simplify(nodes, Osmium::Geometry::Simplify::VISVALINGAM_WHYATT, 3, out);
+    BOOST_CHECK_EQUAL(out.size(), 7);
+
+    Osmium::Geometry::Simplify::simplify(nodes, Osmium::Geometry::Simplify::VISVALINGAM_WHYATT, 1000, out);
+    BOOST_CHECK_EQUAL(out.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(direction_independent) {
+    std::vector<Position> line;
+    for (int i = 0; i < 200; ++i) {
+        line.push_back(Position(i * 10, ((i * 7919) % 61) - 30));
+    }
+    line.push_back(Position(1990, 30)); // tie with the first position
+
+    for (int algorithm = Osmium::Geometry::Simplify::DOUGLAS_PEUCKER; algorithm <= Osmium::Geometry::Simplify::VISVALINGAM_WHYATT; ++algorithm) {
+        std::vector<bool> forward;
+        std::vector<bool> backward;
+        if (algorithm == Osmium::Geometry::Simplify::DOUGLAS_PEUCKER) {
+            Osmium::Geometry::Simplify::douglas_peucker(line.begin(), line.end(), 20, forward);
+            Osmium::Geometry::Simplify::douglas_peucker(line.rbegin(), line.rend(), 20, backward);
+        } else {
+            Osmium::Geometry::Simplify::visvalingam_whyatt(line.begin(), line.end(), 20, forward);
+            Osmium::Geometry::Simplify::visvalingam_whyatt(line.rbegin(), line.rend(), 20, backward);
+        }
+        std::reverse(backward.begin(), backward.end());
+        BOOST_CHECK(forward == backward);
+        BOOST_CHECK(std::count(forward.begin(), forward.end(), true) < 200);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(simplify_ring) {
+    // a thin ring that collapses when simplified too much
+    const int coordinates[] = { 0,0, 50,1, 100,0, 100,3, 50,2, 0,3, 0,0 };
+    WayNodeList nodes = make_nodes(coordinates, 7);
+    nodes.back() = nodes.front();
+    WayNodeList out;
+
+    Osmium::Geometry::Simplify::simplify(nodes, Osmium::Geometry::Simplify::DOUGLAS_PEUCKER, 10, out);
+    BOOST_CHECK(out.size() < 4);
+
+    BOOST_CHECK(Osmium::Geometry::Simplify::simplify_ring(nodes, Osmium::Geometry::Simplify::DOUGLAS_PEUCKER, 10, out));
+    BOOST_CHECK(out.size() >= 4);
+    BOOST_CHECK(out.is_closed());
+    BOOST_CHECK(Osmium::Geometry::Ring::is_simple(out.begin(), out.end()));
+
+    BOOST_CHECK(!Osmium::Geometry::Simplify::simplify_ring(nodes, Osmium::Geometry::Simplify::DOUGLAS_PEUCKER, 1000, out, 1));
+    BOOST_CHECK_EQUAL(out.size(), 7);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
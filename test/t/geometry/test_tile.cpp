@@ -0,0 +1,122 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <osmium/osm/bounds.hpp>
+#include <osmium/osm/position.hpp>
+#include <osmium/osm/way_node_list.hpp>
+#include <osmium/geometry/tile.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::WayNode;
+using Osmium::OSM::WayNodeList;
+using Osmium::Geometry::Tile;
+using Osmium::Geometry::TileCover;
+
+BOOST_AUTO_TEST_SUITE(TileCoverage)
+
+bool has_tile(const std::vector<Tile>& tiles, uint32_t x, uint32_t y) {
+    return std::find(tiles.begin(), tiles.end(), Tile(tiles.front().z(), x, y)) != tiles.end();
+}
+
+WayNodeList square() {
+    WayNodeList nodes;
+    nodes.add(WayNode(1, Position(-170.0, -80.0)));
+    nodes.add(WayNode(2, Position(170.0, -80.0)));
+    nodes.add(WayNode(3, Position(170.0, 80.0)));
+    nodes.add(WayNode(4, Position(-170.0, 80.0)));
+    nodes.add(WayNode(1, Position(-170.0, -80.0)));
+    return nodes;
+}
+
+BOOST_AUTO_TEST_CASE(tile) {
+    TileCover zoom0(0);
+    BOOST_CHECK(zoom0.tile(Position(100.0, -40.0)) == Tile(0, 0, 0));
+
+    TileCover zoom1(1);
+    BOOST_CHECK(zoom1.tile(Position(-10.0, 10.0)) == Tile(1, 0, 0));
+    BOOST_CHECK(zoom1.tile(Position(10.0, -10.0)) == Tile(1, 1, 1));
+    BOOST_CHECK(zoom1.tile(Position(180.0, 89.0)) == Tile(1, 1, 0));
+    BOOST_CHECK(zoom1.tile(Position(-180.0, -89.0)) == Tile(1, 0, 1));
+
+    BOOST_CHECK_THROW(TileCover(31), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(line_in_one_tile) {
+    TileCover cover(2);
+    WayNodeList nodes;
+    nodes.add(WayNode(1, Position(1.0, 1.0)));
+    nodes.add(WayNode(2, Position(2.0, 2.0)));
+
+    std::vector<Tile> tiles;
+    BOOST_CHECK_EQUAL(cover.line(nodes.begin(), nodes.end(), tiles), 1u);
+    BOOST_CHECK(tiles[0] == Tile(2, 2, 1));
+}
+
+BOOST_AUTO_TEST_CASE(line) {
+    TileCover cover(2);
+    WayNodeList nodes;
+    nodes.add(WayNode(1, Position(-170.0, 60.0)));
+    nodes.add(WayNode(2, Position(170.0, 60.0)));
+    nodes.add(WayNode(3, Position(170.0, -60.0)));
+
+    std::vector<Tile> tiles;
+    BOOST_CHECK_EQUAL(cover.line(nodes.begin(), nodes.end(), tiles), 5u);
+    BOOST_CHECK(tiles[0] == Tile(2, 0, 1));
+    BOOST_CHECK(tiles[1] == Tile(2, 1, 1));
+    BOOST_CHECK(tiles[2] == Tile(2, 2, 1));
+    BOOST_CHECK(tiles[3] == Tile(2, 3, 1));
+    BOOST_CHECK(tiles[4] == Tile(2, 3, 2));
+}
+
+BOOST_AUTO_TEST_CASE(diagonal_line) {
+    TileCover cover(4);
+    WayNodeList nodes;
+    nodes.add(WayNode(1, Position(-170.0, 70.0)));
+    nodes.add(WayNode(2, Position(150.0, -50.0)));
+
+    std::vector<Tile> tiles;
+    cover.line(nodes.begin(), nodes.end(), tiles);
+
+    // every tile after the first is a neighbour of an earlier one
+    BOOST_CHECK(has_tile(tiles, 0, 3));
+    BOOST_CHECK(has_tile(tiles, 14, 10));
+    for (std::vector<Tile>::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+        BOOST_CHECK(it == tiles.begin() ||
+                    has_tile(tiles, it->x() - 1, it->y()) || has_tile(tiles, it->x() + 1, it->y()) ||
+                    has_tile(tiles, it->x(), it->y() - 1) || has_tile(tiles, it->x(), it->y() + 1));
+    }
+    BOOST_CHECK(tiles.size() < 15 + 8);
+}
+
+BOOST_AUTO_TEST_CASE(ring) {
+    TileCover cover(3);
+    const WayNodeList nodes = square();
+
+    std::vector<Tile> tiles;
+    BOOST_CHECK_EQUAL(cover.line(nodes.begin(), nodes.end(), tiles), 28u);
+    BOOST_CHECK(!has_tile(tiles, 3, 3));
+
+    BOOST_CHECK_EQUAL(cover.ring(nodes.begin(), nodes.end(), tiles), 64u);
+    BOOST_CHECK(has_tile(tiles, 3, 3));
+}
+
+BOOST_AUTO_TEST_CASE(box) {
+    TileCover cover(2);
+    Osmium::OSM::Bounds bounds;
+    bounds.extend(Position(-10.0, -10.0)).extend(Position(10.0, 10.0));
+
+    std::vector<Tile> tiles;
+    BOOST_CHECK_EQUAL(cover.box(bounds, tiles), 4u);
+    BOOST_CHECK(tiles[0] == Tile(2, 1, 1));
+    BOOST_CHECK(tiles[3] == Tile(2, 2, 2));
+
+    BOOST_CHECK_EQUAL(cover.box(Osmium::OSM::Bounds(), tiles), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
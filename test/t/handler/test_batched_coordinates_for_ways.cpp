@@ -0,0 +1,101 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/storage/byid/fixed_array.hpp>
+#include <osmium/handler/coordinates_for_ways.hpp>
+#include <osmium/handler/batched_coordinates_for_ways.hpp>
+
+typedef Osmium::Storage::ById::FixedArray<Osmium::OSM::Position> storage_t;
+typedef Osmium::Handler::CoordinatesForWays<storage_t, storage_t> cfw_t;
+
+class CollectWays : public Osmium::Handler::Base {
+
+public:
+
+    CollectWays() :
+        Base(),
+        ways(),
+        nodes(0),
+        after_ways_called(false) {
+    }
+
+    void node(const shared_ptr<Osmium::OSM::Node>&) {
+        ++nodes;
+    }
+
+    void way(const shared_ptr<Osmium::OSM::Way>& way) {
+        BOOST_CHECK(!after_ways_called);
+        ways.push_back(way);
+    }
+
+    void after_ways() {
+        after_ways_called = true;
+    }
+
+    std::vector< shared_ptr<Osmium::OSM::Way> > ways;
+    int nodes;
+    bool after_ways_called;
+
+};
+
+shared_ptr<Osmium::OSM::Node> make_node(osm_object_id_t id, double lon, double lat) {
+    shared_ptr<Osmium::OSM::Node> node = make_shared<Osmium::OSM::Node>();
+    node->id(id);
+    node->position(Osmium::OSM::Position(lon, lat));
+    return node;
+}
+
+shared_ptr<Osmium::OSM::Way> make_way(osm_object_id_t id, osm_object_id_t n1, osm_object_id_t n2, osm_object_id_t n3) {
+    shared_ptr<Osmium::OSM::Way> way = make_shared<Osmium::OSM::Way>();
+    way->id(id);
+    way->add_node(n1);
+    way->add_node(n2);
+    way->add_node(n3);
+    return way;
+}
+
+BOOST_AUTO_TEST_SUITE(BatchedCoordinatesForWays)
+
+BOOST_AUTO_TEST_CASE(locations_set_and_order_kept) {
+    storage_t storage_pos(100);
+    storage_t storage_neg(100);
+    cfw_t cfw(storage_pos, storage_neg);
+    CollectWays collect;
+    Osmium::Handler::BatchedCoordinatesForWays<cfw_t, CollectWays> handler(cfw, collect, 2);
+
+    handler.node(make_node(1, 1.0, 10.0));
+    handler.node(make_node(2, 2.0, 20.0));
+    handler.node(make_node(3, 3.0, 30.0));
+    handler.node(make_node(-4, 4.0, 40.0));
+    handler.after_nodes();
+    BOOST_CHECK_EQUAL(4, collect.nodes);
+
+    handler.way(make_way(10, 3, 1, 2));
+    BOOST_CHECK_EQUAL(0u, collect.ways.size());
+    handler.way(make_way(11, 2, -4, 3));
+    BOOST_CHECK_EQUAL(2u, collect.ways.size());
+    handler.way(make_way(12, 1, 1, -4));
+    BOOST_CHECK_EQUAL(2u, collect.ways.size());
+    handler.after_ways();
+    BOOST_REQUIRE_EQUAL(3u, collect.ways.size());
+
+    BOOST_CHECK_EQUAL(10, collect.ways[0]->id());
+    BOOST_CHECK_EQUAL(11, collect.ways[1]->id());
+    BOOST_CHECK_EQUAL(12, collect.ways[2]->id());
+
+    for (std::vector< shared_ptr<Osmium::OSM::Way> >::const_iterator it = collect.ways.begin(); it != collect.ways.end(); ++it) {
+        const Osmium::OSM::WayNodeList& nodes = (*it)->nodes();
+        for (Osmium::OSM::WayNodeList::const_iterator wn = nodes.begin(); wn != nodes.end(); ++wn) {
+            osm_object_id_t ref = wn->ref() < 0 ? -wn->ref() : wn->ref();
+            BOOST_CHECK_EQUAL(wn->position(), Osmium::OSM::Position(ref * 1.0, ref * 10.0));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
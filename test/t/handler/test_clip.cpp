@@ -0,0 +1,253 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include <geos/geom/Coordinate.h>
+#include <geos/geom/LinearRing.h>
+#include <geos/geom/MultiPolygon.h>
+#include <geos/geom/Polygon.h>
+
+#include <osmium/handler/clip.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::WayNode;
+using Osmium::OSM::WayNodeList;
+using Osmium::Geometry::Clip::ConvexRegion;
+
+BOOST_AUTO_TEST_SUITE(ClipHandler)
+
+class CollectObjects : public Osmium::Handler::Base {
+
+public:
+
+    CollectObjects() :
+        Base(),
+        nodes(),
+        ways(),
+        areas() {
+    }
+
+    void node(const shared_ptr<Osmium::OSM::Node>& node) {
+        nodes.push_back(node);
+    }
+
+    void way(const shared_ptr<Osmium::OSM::Way>& way) {
+        ways.push_back(way);
+    }
+
+    void area(const shared_ptr<Osmium::OSM::Area>& area) {
+        areas.push_back(area);
+    }
+
+    std::vector< shared_ptr<Osmium::OSM::Node> > nodes;
+    std::vector< shared_ptr<Osmium::OSM::Way> > ways;
+    std::vector< shared_ptr<Osmium::OSM::Area> > areas;
+
+};
+
+typedef Osmium::Handler::Clip<CollectObjects> clip_t;
+
+ConvexRegion box() {
+    Osmium::OSM::Bounds bounds;
+    bounds.extend(Position(0.0, 0.0)).extend(Position(10.0, 10.0));
+    return ConvexRegion(bounds);
+}
+
+shared_ptr<Osmium::OSM::Node> make_node(osm_object_id_t id, double lon, double lat) {
+    shared_ptr<Osmium::OSM::Node> node = make_shared<Osmium::OSM::Node>();
+    node->id(id);
+    node->position(Position(lon, lat));
+    return node;
+}
+
+shared_ptr<Osmium::OSM::Way> make_way(osm_object_id_t id, const double* coordinates, size_t count) {
+    shared_ptr<Osmium::OSM::Way> way = make_shared<Osmium::OSM::Way>();
+    way->id(id);
+    way->tags().add("highway", "residential");
+    for (size_t i = 0; i < count; ++i) {
+        way->nodes().add(WayNode(id * 100 + static_cast<osm_object_id_t>(i), Position(coordinates[2*i], coordinates[2*i+1])));
+    }
+    return way;
+}
+
+/// Square with the given corners as a closed way.
+shared_ptr<Osmium::OSM::Way> make_square(osm_object_id_t id, double x1, double y1, double x2, double y2) {
+    const double coordinates[] = { x1, y1, x2, y1, x2, y2, x1, y2, x1, y1 };
+    shared_ptr<Osmium::OSM::Way> way = make_way(id, coordinates, 5);
+    way->nodes()[4] = way->nodes()[0];
+    return way;
+}
+
+geos::geom::LinearRing* make_geos_ring(double x1, double y1, double x2, double y2) {
+    std::vector<geos::geom::Coordinate>* coordinates = new std::vector<geos::geom::Coordinate>();
+    coordinates->push_back(geos::geom::Coordinate(x1, y1));
+    coordinates->push_back(geos::geom::Coordinate(x2, y1));
+    coordinates->push_back(geos::geom::Coordinate(x2, y2));
+    coordinates->push_back(geos::geom::Coordinate(x1, y2));
+    coordinates->push_back(geos::geom::Coordinate(x1, y1));
+    geos::geom::GeometryFactory* factory = Osmium::Geometry::geos_geometry_factory();
+    return factory->createLinearRing(factory->getCoordinateSequenceFactory()->create(coordinates));
+}
+
+bool all_inside(const ConvexRegion& region, const WayNodeList& nodes) {
+    return region.contains(nodes.begin(), nodes.end());
+}
+
+BOOST_AUTO_TEST_CASE(nodes) {
+    CollectObjects collect;
+    clip_t clip(collect, box());
+
+    clip.node(make_node(1, 5, 5));
+    clip.node(make_node(2, 11, 5));
+    clip.node(make_node(3, 10, 0));
+
+    BOOST_REQUIRE_EQUAL(2u, collect.nodes.size());
+    BOOST_CHECK_EQUAL(1, collect.nodes[0]->id());
+    BOOST_CHECK_EQUAL(3, collect.nodes[1]->id());
+}
+
+BOOST_AUTO_TEST_CASE(ways_inside_and_outside) {
+    CollectObjects collect;
+    clip_t clip(collect, box());
+
+    const double inside[] = { 1, 1, 5, 5, 9, 2 };
+    shared_ptr<Osmium::OSM::Way> way = make_way(10, inside, 3);
+    clip.way(way);
+    const double outside[] = { 11, 1, 15, 5, 19, 2 };
+    clip.way(make_way(11, outside, 3));
+
+    BOOST_REQUIRE_EQUAL(1u, collect.ways.size());
+    BOOST_CHECK(collect.ways[0] == way);
+    BOOST_CHECK_EQUAL(3u, way->nodes().size());
+}
+
+BOOST_AUTO_TEST_CASE(way_pieces) {
+    CollectObjects collect;
+    clip_t clip(collect, box());
+
+    // goes in, out, and in again
+    const double coordinates[] = { -5, 2, 5, 2, 5, 15, 8, 15, 8, 5, 15, 5 };
+    clip.way(make_way(20, coordinates, 6));
+
+    BOOST_REQUIRE_EQUAL(2u, collect.ways.size());
+    BOOST_CHECK(collect.ways[0] != collect.ways[1]);
+    for (size_t i = 0; i < collect.ways.size(); ++i) {
+        BOOST_CHECK_EQUAL(20, collect.ways[i]->id());
+        BOOST_CHECK_EQUAL(std::string("residential"), collect.ways[i]->tags().get_value_by_key("highway"));
+        BOOST_CHECK(all_inside(box(), collect.ways[i]->nodes()));
+    }
+
+    const WayNodeList& first = collect.ways[0]->nodes();
+    BOOST_REQUIRE_EQUAL(3u, first.size());
+    BOOST_CHECK_EQUAL(0, first[0].ref());
+    BOOST_CHECK(first[0].position() == Position(0.0, 2.0));
+    BOOST_CHECK_EQUAL(2001, first[1].ref());
+    BOOST_CHECK(first[2].position() == Position(5.0, 10.0));
+
+    const WayNodeList& second = collect.ways[1]->nodes();
+    BOOST_REQUIRE_EQUAL(3u, second.size());
+    BOOST_CHECK(second[0].position() == Position(8.0, 10.0));
+    BOOST_CHECK_EQUAL(2004, second[1].ref());
+    BOOST_CHECK(second[2].position() == Position(10.0, 5.0));
+}
+
+BOOST_AUTO_TEST_CASE(closed_ways) {
+    CollectObjects collect;
+    clip_t clip(collect, box());
+
+    clip.way(make_square(30, -5, -5, 5, 5));
+
+    BOOST_REQUIRE_EQUAL(1u, collect.ways.size());
+    const WayNodeList& nodes = collect.ways[0]->nodes();
+    BOOST_CHECK(nodes.is_closed());
+    BOOST_CHECK_EQUAL(5u, nodes.size());
+    BOOST_CHECK(all_inside(box(), nodes));
+
+    CollectObjects collect_lines;
+    clip_t clip_lines(collect_lines, box(), false);
+
+    clip_lines.way(make_square(31, -5, -5, 5, 5));
+
+    BOOST_REQUIRE_EQUAL(1u, collect_lines.ways.size());
+    const WayNodeList& line = collect_lines.ways[0]->nodes();
+    BOOST_REQUIRE_EQUAL(3u, line.size());
+    BOOST_CHECK(line.front().position() == Position(5.0, 0.0));
+    BOOST_CHECK(line.back().position() == Position(0.0, 5.0));
+}
+
+BOOST_AUTO_TEST_CASE(way_areas) {
+    CollectObjects collect;
+    clip_t clip(collect, box());
+
+    shared_ptr<Osmium::OSM::Area> inside = make_shared<Osmium::OSM::Area>(*make_square(40, 2, 2, 4, 4));
+    clip.area(inside);
+    clip.area(make_shared<Osmium::OSM::Area>(*make_square(41, 12, 2, 14, 4)));
+    clip.area(make_shared<Osmium::OSM::Area>(*make_square(42, 5, 5, 15, 15)));
+
+    BOOST_REQUIRE_EQUAL(2u, collect.areas.size());
+    BOOST_CHECK(collect.areas[0] == inside);
+
+    const Osmium::OSM::Area& clipped = *collect.areas[1];
+    BOOST_CHECK(clipped.from_way());
+    BOOST_CHECK_EQUAL(42, clipped.orig_id());
+    BOOST_CHECK_EQUAL(std::string("residential"), clipped.tags().get_value_by_key("highway"));
+    BOOST_CHECK(clipped.nodes().is_closed());
+    BOOST_CHECK_EQUAL(5u, clipped.nodes().size());
+    BOOST_CHECK(all_inside(box(), clipped.nodes()));
+}
+
+BOOST_AUTO_TEST_CASE(relation_area_without_geometry) {
+    CollectObjects collect;
+    clip_t clip(collect, box());
+
+    Osmium::OSM::Relation relation;
+    relation.id(50);
+    shared_ptr<Osmium::OSM::Area> area = make_shared<Osmium::OSM::Area>(relation);
+    clip.area(area);
+
+    BOOST_REQUIRE_EQUAL(1u, collect.areas.size());
+    BOOST_CHECK(collect.areas[0] == area);
+    BOOST_CHECK_EQUAL(1u, clip.unclipped_areas());
+}
+
+BOOST_AUTO_TEST_CASE(relation_area_with_hole_on_border) {
+    CollectObjects collect;
+    clip_t clip(collect, box());
+
+    // the hole crosses the right border of the region
+    geos::geom::GeometryFactory* factory = Osmium::Geometry::geos_geometry_factory();
+    std::vector<geos::geom::Geometry*>* holes = new std::vector<geos::geom::Geometry*>();
+    holes->push_back(make_geos_ring(8, 4, 12, 6));
+    std::vector<geos::geom::Geometry*>* polygons = new std::vector<geos::geom::Geometry*>();
+    polygons->push_back(factory->createPolygon(make_geos_ring(2, 2, 20, 8), holes));
+
+    Osmium::OSM::Relation relation;
+    relation.id(51);
+    relation.tags().add("landuse", "forest");
+    shared_ptr<Osmium::OSM::Area> area = make_shared<Osmium::OSM::Area>(relation);
+    area->geos_geometry(factory->createMultiPolygon(polygons));
+    clip.area(area);
+
+    BOOST_REQUIRE_EQUAL(1u, collect.areas.size());
+    const Osmium::OSM::Area& clipped = *collect.areas[0];
+    BOOST_CHECK(!clipped.from_way());
+    BOOST_CHECK_EQUAL(51, clipped.orig_id());
+    BOOST_CHECK_EQUAL(std::string("forest"), clipped.tags().get_value_by_key("landuse"));
+    BOOST_CHECK_EQUAL(0u, clip.unclipped_areas());
+
+    // the hole is cut out of the outer ring: 8x6 minus 2x2
+    const geos::geom::MultiPolygon* geometry = Osmium::Geometry::MultiPolygon(clipped).borrow_geos_geometry();
+    BOOST_REQUIRE(geometry);
+    BOOST_CHECK(geometry->isValid());
+    BOOST_CHECK_EQUAL(1u, geometry->getNumGeometries());
+    BOOST_CHECK_CLOSE(44.0, geometry->getArea(), 0.0001);
+    const geos::geom::Envelope* envelope = geometry->getEnvelopeInternal();
+    BOOST_CHECK_EQUAL(2, envelope->getMinX());
+    BOOST_CHECK_EQUAL(10, envelope->getMaxX());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
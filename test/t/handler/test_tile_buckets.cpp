@@ -0,0 +1,175 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <geos/geom/Coordinate.h>
+#include <geos/geom/LinearRing.h>
+#include <geos/geom/MultiPolygon.h>
+#include <geos/geom/Polygon.h>
+
+#include <osmium/handler/tile_buckets.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::WayNode;
+
+BOOST_AUTO_TEST_SUITE(TileBucketsHandler)
+
+class CountObjects : public Osmium::Handler::Base {
+
+public:
+
+    CountObjects() :
+        Base(),
+        nodes(0),
+        ways(0),
+        areas(0) {
+    }
+
+    void node(const shared_ptr<Osmium::OSM::Node>&) {
+        ++nodes;
+    }
+
+    void way(const shared_ptr<Osmium::OSM::Way>&) {
+        ++ways;
+    }
+
+    void area(const shared_ptr<Osmium::OSM::Area>&) {
+        ++areas;
+    }
+
+    int nodes;
+    int ways;
+    int areas;
+
+};
+
+typedef Osmium::Handler::TileBuckets<CountObjects> tile_buckets_t;
+
+static const char* directory = "test_tile_buckets_handler.tmp";
+
+void remove_directory() {
+    boost::filesystem::remove_all(directory);
+}
+
+std::string bucket(const char* name) {
+    return std::string(directory) + "/" + name + ".osmb";
+}
+
+uint64_t count(const std::string& filename) {
+    CountObjects counter;
+    return Osmium::Export::TileBucketFiles::read(filename, counter);
+}
+
+geos::geom::Polygon* make_geos_square(double x1, double y1, double x2, double y2) {
+    std::vector<geos::geom::Coordinate>* coordinates = new std::vector<geos::geom::Coordinate>();
+    coordinates->push_back(geos::geom::Coordinate(x1, y1));
+    coordinates->push_back(geos::geom::Coordinate(x2, y1));
+    coordinates->push_back(geos::geom::Coordinate(x2, y2));
+    coordinates->push_back(geos::geom::Coordinate(x1, y2));
+    coordinates->push_back(geos::geom::Coordinate(x1, y1));
+    geos::geom::GeometryFactory* factory = Osmium::Geometry::geos_geometry_factory();
+    return factory->createPolygon(factory->createLinearRing(factory->getCoordinateSequenceFactory()->create(coordinates)), NULL);
+}
+
+BOOST_AUTO_TEST_CASE(nodes_ways_and_way_areas) {
+    remove_directory();
+    CountObjects next;
+
+    {
+        Osmium::Export::TileBucketFiles files(directory);
+        tile_buckets_t handler(next, files, 2);
+
+        shared_ptr<Osmium::OSM::Node> node = make_shared<Osmium::OSM::Node>();
+        node->id(1);
+        node->position(Position(10.0, 10.0));
+        handler.node(node);
+        handler.node(make_shared<Osmium::OSM::Node>());
+
+        shared_ptr<Osmium::OSM::Way> way = make_shared<Osmium::OSM::Way>();
+        way->id(10);
+        way->nodes().add(WayNode(1, Position(-10.0, 10.0)));
+        way->nodes().add(WayNode(2, Position(10.0, 10.0)));
+        handler.way(way);
+
+        shared_ptr<Osmium::OSM::Way> closed_way = make_shared<Osmium::OSM::Way>();
+        closed_way->id(11);
+        closed_way->nodes().add(WayNode(3, Position(100.0, -10.0)));
+        closed_way->nodes().add(WayNode(4, Position(110.0, -10.0)));
+        closed_way->nodes().add(WayNode(5, Position(110.0, -20.0)));
+        closed_way->nodes().add(WayNode(3, Position(100.0, -10.0)));
+        handler.area(make_shared<Osmium::OSM::Area>(*closed_way));
+
+        BOOST_CHECK_EQUAL(1u, handler.skipped());
+        BOOST_CHECK_EQUAL(3u, files.objects());
+        BOOST_CHECK_EQUAL(4u, files.records());
+    }
+
+    // everything is forwarded, including objects without location
+    BOOST_CHECK_EQUAL(2, next.nodes);
+    BOOST_CHECK_EQUAL(1, next.ways);
+    BOOST_CHECK_EQUAL(1, next.areas);
+
+    BOOST_CHECK_EQUAL(2u, count(bucket("2/2/1")));
+    BOOST_CHECK_EQUAL(1u, count(bucket("2/1/1")));
+    BOOST_CHECK_EQUAL(1u, count(bucket("2/3/2")));
+
+    remove_directory();
+}
+
+BOOST_AUTO_TEST_CASE(relation_area_without_geometry) {
+    remove_directory();
+    CountObjects next;
+
+    Osmium::Export::TileBucketFiles files(directory);
+    tile_buckets_t handler(next, files, 2);
+
+    Osmium::OSM::Relation relation;
+    relation.id(20);
+    handler.area(make_shared<Osmium::OSM::Area>(relation));
+
+    BOOST_CHECK_EQUAL(1u, handler.skipped());
+    BOOST_CHECK_EQUAL(0u, files.objects());
+    BOOST_CHECK_EQUAL(1, next.areas);
+
+    remove_directory();
+}
+
+BOOST_AUTO_TEST_CASE(relation_area_in_tiles_of_outer_rings) {
+    remove_directory();
+    CountObjects next;
+
+    {
+        Osmium::Export::TileBucketFiles files(directory);
+        tile_buckets_t handler(next, files, 2);
+
+        // two small polygons in opposite corners of the world, the
+        // bounding box covers all 16 tiles
+        std::vector<geos::geom::Geometry*>* polygons = new std::vector<geos::geom::Geometry*>();
+        polygons->push_back(make_geos_square(-170, -80, -160, -70));
+        polygons->push_back(make_geos_square(160, 70, 170, 80));
+
+        Osmium::OSM::Relation relation;
+        relation.id(21);
+        shared_ptr<Osmium::OSM::Area> area = make_shared<Osmium::OSM::Area>(relation);
+        area->geos_geometry(Osmium::Geometry::geos_geometry_factory()->createMultiPolygon(polygons));
+        handler.area(area);
+
+        BOOST_CHECK_EQUAL(0u, handler.skipped());
+        BOOST_CHECK_EQUAL(2u, files.records());
+    }
+
+    BOOST_CHECK_EQUAL(1u, count(bucket("2/0/3")));
+    BOOST_CHECK_EQUAL(1u, count(bucket("2/3/0")));
+    BOOST_CHECK(!boost::filesystem::exists(bucket("2/1/1")));
+
+    remove_directory();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
@@ -25,6 +25,7 @@ BOOST_AUTO_TEST_CASE(set_position) {
 
 BOOST_AUTO_TEST_CASE(closed_or_not) {
     Osmium::OSM::WayNodeList wnl;
+    BOOST_CHECK(!wnl.is_closed());
     wnl.add(5);
     wnl.add(7);
     wnl.add(8);
@@ -0,0 +1,234 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <boost/foreach.hpp>
+
+#include <osmium/osm/way.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/relations/assembler.hpp>
+
+class TestAssembler : public Osmium::Relations::Assembler<TestAssembler, Osmium::Relations::RelationInfo, false, true, false> {
+
+public:
+
+    TestAssembler() :
+        Osmium::Relations::Assembler<TestAssembler, Osmium::Relations::RelationInfo, false, true, false>(),
+        compacted(0),
+        completed(),
+        incomplete() {
+    }
+
+    shared_ptr<Osmium::OSM::Object const> compact_member(const shared_ptr<Osmium::OSM::Object const>& object) {
+        ++compacted;
+        shared_ptr<Osmium::OSM::Way> way = make_shared<Osmium::OSM::Way>(0);
+        way->id(object->id());
+        return way;
+    }
+
+    void complete_relation(Osmium::Relations::RelationInfo& relation_info) {
+        completed.push_back(relation_info);
+    }
+
+    void all_members_available() {
+        BOOST_FOREACH(const Osmium::Relations::RelationInfo& relation_info, relations()) {
+            if (relation_info.relation()) {
+                incomplete.push_back(relation_info);
+            }
+        }
+    }
+
+    int compacted;
+    std::vector<Osmium::Relations::RelationInfo> completed;
+    std::vector<Osmium::Relations::RelationInfo> incomplete;
+
+};
+
+class NestedAssembler : public Osmium::Relations::Assembler<NestedAssembler, Osmium::Relations::RelationInfo, false, true, false> {
+
+public:
+
+    NestedAssembler() :
+        Osmium::Relations::Assembler<NestedAssembler, Osmium::Relations::RelationInfo, false, true, false>(),
+        completed(),
+        incomplete() {
+        resolve_nested_relations(true);
+    }
+
+    void complete_relation(Osmium::Relations::RelationInfo& relation_info) {
+        completed.push_back(relation_info);
+    }
+
+    void all_members_available() {
+        BOOST_FOREACH(const Osmium::Relations::RelationInfo& relation_info, relations()) {
+            if (relation_info.relation()) {
+                incomplete.push_back(relation_info);
+            }
+        }
+    }
+
+    std::vector<Osmium::Relations::RelationInfo> completed;
+    std::vector<Osmium::Relations::RelationInfo> incomplete;
+
+};
+
+shared_ptr<Osmium::OSM::Relation const> make_relation(osm_object_id_t id, osm_object_id_t way1, osm_object_id_t way2) {
+    shared_ptr<Osmium::OSM::Relation> relation = make_shared<Osmium::OSM::Relation>();
+    relation->id(id);
+    relation->add_member('w', way1, "outer");
+    relation->add_member('w', way2, "inner");
+    return relation;
+}
+
+shared_ptr<Osmium::OSM::Way const> make_way(osm_object_id_t id) {
+    shared_ptr<Osmium::OSM::Way> way = make_shared<Osmium::OSM::Way>();
+    way->id(id);
+    way->add_node(1);
+    way->add_node(2);
+    return way;
+}
+
+shared_ptr<Osmium::OSM::Relation const> make_relation(osm_object_id_t id, const char* members) {
+    shared_ptr<Osmium::OSM::Relation> relation = make_shared<Osmium::OSM::Relation>();
+    relation->id(id);
+    for (const char* m = members; *m; m += 3) {
+        relation->add_member(m[0], (m[1] - '0') * 10 + (m[2] - '0'), "");
+    }
+    return relation;
+}
+
+BOOST_AUTO_TEST_SUITE(RelationsAssembler)
+
+BOOST_AUTO_TEST_CASE(compact_member_shared_between_relations) {
+    TestAssembler assembler;
+
+    assembler.handler_pass1().relation(make_relation(1, 10, 11));
+    assembler.handler_pass1().relation(make_relation(2, 10, 12));
+    BOOST_CHECK_THROW(assembler.handler_pass1().after_relations(), Osmium::Handler::StopReading);
+
+    assembler.handler_pass2().way(make_way(9));
+    BOOST_CHECK_EQUAL(assembler.compacted, 0);
+
+    assembler.handler_pass2().way(make_way(10));
+    BOOST_CHECK_EQUAL(assembler.compacted, 1);
+    BOOST_CHECK(assembler.completed.empty());
+
+    assembler.handler_pass2().way(make_way(11));
+    assembler.handler_pass2().way(make_way(12));
+    BOOST_CHECK_EQUAL(assembler.compacted, 3);
+    BOOST_REQUIRE_EQUAL(assembler.completed.size(), 2u);
+
+    const Osmium::Relations::RelationInfo& r1 = assembler.completed[0];
+    const Osmium::Relations::RelationInfo& r2 = assembler.completed[1];
+    BOOST_CHECK_EQUAL(r1.relation()->id(), 1);
+    BOOST_CHECK_EQUAL(r2.relation()->id(), 2);
+
+    // the compact copy is stored, not the original, and shared by both relations
+    BOOST_CHECK_EQUAL(static_pointer_cast<Osmium::OSM::Way const>(r1.members()[0])->nodes().size(), 0u);
+    BOOST_CHECK(r1.members()[0] == r2.members()[0]);
+    BOOST_CHECK_EQUAL(r2.members()[1]->id(), 12);
+}
+
+BOOST_AUTO_TEST_CASE(spill_members_over_memory_budget) {
+    TestAssembler assembler;
+    assembler.memory_budget(1);
+
+    assembler.handler_pass1().relation(make_relation(1, 10, 11));
+    assembler.handler_pass1().relation(make_relation(2, 10, 12));
+    assembler.handler_pass1().relation(make_relation(3, 13, 14));
+    BOOST_CHECK_THROW(assembler.handler_pass1().after_relations(), Osmium::Handler::StopReading);
+
+    // every member goes over the budget and is written to the spill file,
+    // way 10 only once although it is needed by two relations
+    assembler.handler_pass2().way(make_way(10));
+    BOOST_CHECK_EQUAL(assembler.spilled_members(), 1u);
+    assembler.handler_pass2().way(make_way(13));
+    BOOST_CHECK_EQUAL(assembler.spilled_members(), 2u);
+
+    // the spilled members are read back when the relation is complete
+    assembler.handler_pass2().way(make_way(11));
+    BOOST_REQUIRE_EQUAL(assembler.completed.size(), 1u);
+    const Osmium::Relations::RelationInfo& r1 = assembler.completed[0];
+    BOOST_CHECK_EQUAL(r1.relation()->id(), 1);
+    BOOST_REQUIRE(r1.members()[0]);
+    BOOST_CHECK_EQUAL(r1.members()[0]->id(), 10);
+    BOOST_CHECK_EQUAL(r1.members()[0]->type(), WAY);
+    BOOST_REQUIRE(r1.members()[1]);
+    BOOST_CHECK_EQUAL(r1.members()[1]->id(), 11);
+
+    assembler.handler_pass2().way(make_way(12));
+    BOOST_REQUIRE_EQUAL(assembler.completed.size(), 2u);
+    BOOST_REQUIRE(assembler.completed[1].members()[0]);
+    BOOST_CHECK_EQUAL(assembler.completed[1].members()[0]->id(), 10);
+    BOOST_CHECK_EQUAL(assembler.completed[1].members()[1]->id(), 12);
+
+    // relation 3 never gets way 14, its spilled member is read back
+    // before all_members_available() is called
+    assembler.handler_pass2().after_ways();
+    BOOST_REQUIRE_EQUAL(assembler.incomplete.size(), 1u);
+    BOOST_CHECK_EQUAL(assembler.incomplete[0].relation()->id(), 3);
+    BOOST_REQUIRE(assembler.incomplete[0].members()[0]);
+    BOOST_CHECK_EQUAL(assembler.incomplete[0].members()[0]->id(), 13);
+    BOOST_CHECK(!assembler.incomplete[0].members()[1]);
+}
+
+BOOST_AUTO_TEST_CASE(nested_relations) {
+    NestedAssembler assembler;
+
+    assembler.handler_pass1().relation(make_relation(1, "w10w11"));
+    assembler.handler_pass1().relation(make_relation(2, "w12"));
+    assembler.handler_pass1().relation(make_relation(3, "r01r02"));
+    assembler.handler_pass1().relation(make_relation(4, "r03w13"));
+    // 5 and 6 are members of each other
+    assembler.handler_pass1().relation(make_relation(5, "r06"));
+    assembler.handler_pass1().relation(make_relation(6, "r05w14"));
+    BOOST_CHECK_THROW(assembler.handler_pass1().after_relations(), Osmium::Handler::StopReading);
+
+    BOOST_CHECK_EQUAL(assembler.cyclic_members(), 1u);
+    BOOST_REQUIRE_EQUAL(assembler.relations_per_depth().size(), 3u);
+    BOOST_CHECK_EQUAL(assembler.relations_per_depth()[0], 3u);
+    BOOST_CHECK_EQUAL(assembler.relations_per_depth()[1], 2u);
+    BOOST_CHECK_EQUAL(assembler.relations_per_depth()[2], 1u);
+
+    assembler.handler_pass2().way(make_way(10));
+    assembler.handler_pass2().way(make_way(11));
+    BOOST_REQUIRE_EQUAL(assembler.completed.size(), 1u);
+    BOOST_CHECK_EQUAL(assembler.completed[0].relation()->id(), 1);
+
+    // completing 2 also completes its parent 3, but not 4 which needs way 13
+    assembler.handler_pass2().way(make_way(12));
+    BOOST_REQUIRE_EQUAL(assembler.completed.size(), 3u);
+    BOOST_CHECK_EQUAL(assembler.completed[1].relation()->id(), 2);
+    BOOST_CHECK_EQUAL(assembler.completed[2].relation()->id(), 3);
+    BOOST_REQUIRE(assembler.completed[2].members()[0]);
+    BOOST_CHECK_EQUAL(assembler.completed[2].members()[0]->type(), RELATION);
+    BOOST_CHECK_EQUAL(assembler.completed[2].members()[0]->id(), 1);
+    BOOST_CHECK_EQUAL(assembler.completed[2].members()[1]->id(), 2);
+
+    assembler.handler_pass2().way(make_way(13));
+    BOOST_REQUIRE_EQUAL(assembler.completed.size(), 4u);
+    BOOST_CHECK_EQUAL(assembler.completed[3].relation()->id(), 4);
+    BOOST_CHECK_EQUAL(assembler.completed[3].members()[0]->id(), 3);
+    BOOST_CHECK_EQUAL(assembler.completed[3].members()[1]->id(), 13);
+
+    // 6 still needs 5 from the input which is never read, so neither completes
+    assembler.handler_pass2().way(make_way(14));
+    BOOST_CHECK_EQUAL(assembler.completed.size(), 4u);
+
+    BOOST_CHECK_EQUAL(assembler.completed_per_depth()[0], 2u);
+    BOOST_CHECK_EQUAL(assembler.completed_per_depth()[1], 1u);
+    BOOST_CHECK_EQUAL(assembler.completed_per_depth()[2], 1u);
+
+    assembler.handler_pass2().after_ways();
+    BOOST_REQUIRE_EQUAL(assembler.incomplete.size(), 2u);
+    BOOST_CHECK_EQUAL(assembler.incomplete[0].relation()->id(), 5);
+    BOOST_REQUIRE(assembler.incomplete[0].members()[0]);
+    BOOST_CHECK_EQUAL(assembler.incomplete[0].members()[0]->id(), 6);
+    BOOST_CHECK_EQUAL(assembler.incomplete[1].relation()->id(), 6);
+    BOOST_CHECK(!assembler.incomplete[1].members()[0]);
+    BOOST_CHECK_EQUAL(assembler.incomplete[1].members()[1]->id(), 14);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
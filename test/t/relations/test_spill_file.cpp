@@ -0,0 +1,81 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/relations/spill_file.hpp>
+
+BOOST_AUTO_TEST_SUITE(SpillFile)
+
+BOOST_AUTO_TEST_CASE(round_trip) {
+    Osmium::Relations::SpillFile spill_file;
+
+    Osmium::OSM::Node node;
+    node.id(17).version(3).changeset(99).uid(42).user("foo");
+    node.timestamp(1234567890);
+    node.tags().add("amenity", "post_box");
+    node.position(Osmium::OSM::Position(1.5, 2.5));
+
+    Osmium::OSM::Way way(3);
+    way.id(-5).visible(false);
+    way.add_node(1);
+    way.add_node(2);
+    way.nodes().add(Osmium::OSM::WayNode(3, Osmium::OSM::Position(int32_t(10), int32_t(-20))));
+
+    Osmium::OSM::Relation relation;
+    relation.id(1000);
+    relation.tags().add("type", "multipolygon");
+    relation.add_member('w', 10, "outer");
+    relation.add_member('n', 11, "");
+
+    const Osmium::Relations::SpillFile::offset_t node_offset = spill_file.write(node);
+    const Osmium::Relations::SpillFile::offset_t way_offset = spill_file.write(way);
+    BOOST_CHECK_EQUAL(spill_file.count(), 2u);
+
+    // reading in between must not break later writes
+    BOOST_CHECK_EQUAL(spill_file.read(node_offset)->id(), 17);
+    const Osmium::Relations::SpillFile::offset_t relation_offset = spill_file.write(relation);
+    BOOST_CHECK_EQUAL(spill_file.count(), 3u);
+
+    shared_ptr<Osmium::OSM::Relation const> r = static_pointer_cast<Osmium::OSM::Relation const>(spill_file.read(relation_offset));
+    BOOST_CHECK_EQUAL(r->type(), RELATION);
+    BOOST_CHECK_EQUAL(r->id(), 1000);
+    BOOST_CHECK_EQUAL(r->tags().size(), 1);
+    BOOST_CHECK(!strcmp(r->tags().get_value_by_key("type"), "multipolygon"));
+    BOOST_REQUIRE_EQUAL(r->members().size(), 2u);
+    BOOST_CHECK_EQUAL(r->members()[0].type(), 'w');
+    BOOST_CHECK_EQUAL(r->members()[0].ref(), 10);
+    BOOST_CHECK(!strcmp(r->members()[0].role(), "outer"));
+    BOOST_CHECK_EQUAL(r->members()[1].type(), 'n');
+    BOOST_CHECK(!strcmp(r->members()[1].role(), ""));
+
+    shared_ptr<Osmium::OSM::Node const> n = static_pointer_cast<Osmium::OSM::Node const>(spill_file.read(node_offset));
+    BOOST_CHECK_EQUAL(n->type(), NODE);
+    BOOST_CHECK_EQUAL(n->version(), 3u);
+    BOOST_CHECK_EQUAL(n->changeset(), 99);
+    BOOST_CHECK_EQUAL(n->uid(), 42);
+    BOOST_CHECK(!strcmp(n->user(), "foo"));
+    BOOST_CHECK_EQUAL(n->timestamp(), 1234567890);
+    BOOST_CHECK(n->visible());
+    BOOST_CHECK(!strcmp(n->tags().get_value_by_key("amenity"), "post_box"));
+    BOOST_CHECK(n->position() == node.position());
+
+    shared_ptr<Osmium::OSM::Way const> w = static_pointer_cast<Osmium::OSM::Way const>(spill_file.read(way_offset));
+    BOOST_CHECK_EQUAL(w->type(), WAY);
+    BOOST_CHECK_EQUAL(w->id(), -5);
+    BOOST_CHECK(!w->visible());
+    BOOST_CHECK_EQUAL(w->tags().size(), 0);
+    BOOST_REQUIRE_EQUAL(w->nodes().size(), 3u);
+    BOOST_CHECK_EQUAL(w->nodes().capacity(), 3u);
+    BOOST_CHECK_EQUAL(w->nodes()[1].ref(), 2);
+    BOOST_CHECK_EQUAL(w->nodes()[2].ref(), 3);
+    BOOST_CHECK_EQUAL(w->nodes()[2].position().x(), 10);
+    BOOST_CHECK_EQUAL(w->nodes()[2].position().y(), -20);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,122 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/position.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/storage/area_index.hpp>
+
+using Osmium::OSM::Position;
+using Osmium::OSM::WayNode;
+
+BOOST_AUTO_TEST_SUITE(AreaIndex)
+
+/// Square area from (x, y) to (x + size, y + size), the area id is 2 * id.
+Osmium::OSM::Area square(osm_object_id_t id, int32_t x, int32_t y, int32_t size) {
+    Osmium::OSM::Way way;
+    way.id(id);
+    way.nodes().add(WayNode(1, Position(x, y)));
+    way.nodes().add(WayNode(2, Position(x + size, y)));
+    way.nodes().add(WayNode(3, Position(x + size, y + size)));
+    way.nodes().add(WayNode(4, Position(x, y + size)));
+    way.nodes().add(WayNode(1, Position(x, y)));
+    return Osmium::OSM::Area(way);
+}
+
+/// Grid of 40x40 squares with size 10 and one large square over everything.
+void fill(Osmium::Storage::AreaIndex& index) {
+    for (int32_t i = 0; i < 40; ++i) {
+        for (int32_t j = 0; j < 40; ++j) {
+            index.add(square(1 + i * 40 + j, i * 10, j * 10, 10));
+        }
+    }
+    index.add(square(5000, 0, 0, 400));
+}
+
+BOOST_AUTO_TEST_CASE(find) {
+    Osmium::Storage::AreaIndex index;
+    std::vector<osm_object_id_t> ids;
+    fill(index);
+    BOOST_CHECK_THROW(index.find(Position(1, 1), ids), std::logic_error);
+    index.build();
+    BOOST_CHECK_EQUAL(index.size(), 1601u);
+    BOOST_CHECK_THROW(index.add(square(6000, 0, 0, 1)), std::logic_error);
+
+    BOOST_CHECK_EQUAL(index.find(Position(125, 37), ids), 2u);
+    std::sort(ids.begin(), ids.end());
+    BOOST_CHECK_EQUAL(ids[0], 2 * (1 + 12 * 40 + 3));
+    BOOST_CHECK_EQUAL(ids[1], 10000);
+
+    ids.clear();
+    BOOST_CHECK_EQUAL(index.find(Position(401, 5), ids), 0u);
+    BOOST_CHECK_EQUAL(index.find(Position(-1, 5), ids), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(concave) {
+    // L-shaped area, the point at (7, 7) is in its bounding box but not inside
+    Osmium::OSM::Way way;
+    way.id(1);
+    way.nodes().add(WayNode(1, Position(0, 0)));
+    way.nodes().add(WayNode(2, Position(10, 0)));
+    way.nodes().add(WayNode(3, Position(10, 5)));
+    way.nodes().add(WayNode(4, Position(5, 5)));
+    way.nodes().add(WayNode(5, Position(5, 10)));
+    way.nodes().add(WayNode(6, Position(0, 10)));
+    way.nodes().add(WayNode(1, Position(0, 0)));
+
+    Osmium::Storage::AreaIndex index;
+    index.add(Osmium::OSM::Area(way));
+
+    Osmium::OSM::Way open_way;
+    open_way.nodes().add(WayNode(1, Position(0, 0)));
+    open_way.nodes().add(WayNode(2, Position(10, 0)));
+    index.add(Osmium::OSM::Area(open_way));
+    BOOST_CHECK_EQUAL(index.skipped(), 1u);
+
+    index.build();
+
+    std::vector<osm_object_id_t> ids;
+    BOOST_CHECK_EQUAL(index.find(Position(7, 7), ids), 0u);
+    BOOST_CHECK_EQUAL(index.find(Position(7, 3), ids), 1u);
+    BOOST_CHECK_EQUAL(index.find(Position(3, 7), ids), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(empty) {
+    Osmium::Storage::AreaIndex index;
+    index.build();
+    std::vector<osm_object_id_t> ids;
+    BOOST_CHECK_EQUAL(index.find(Position(1, 1), ids), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(dump_and_map) {
+    const char* filename = "test_area_index.idx";
+    {
+        Osmium::Storage::AreaIndex index;
+        fill(index);
+        index.build();
+        index.dump(filename);
+    }
+
+    {
+        Osmium::Storage::AreaIndex index(filename);
+        BOOST_CHECK_EQUAL(index.size(), 1601u);
+
+        std::vector<osm_object_id_t> ids;
+        for (int32_t x = 5; x < 400; x += 10) {
+            ids.clear();
+            BOOST_CHECK_EQUAL(index.find(Position(x, 395), ids), 2u);
+        }
+    }
+
+    remove(filename);
+    BOOST_CHECK_THROW(Osmium::Storage::AreaIndex index(filename), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,44 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/osm/position.hpp>
+#include <osmium/storage/byid/cached_file.hpp>
+
+typedef Osmium::Storage::ById::CachedFile<Osmium::OSM::Position, 4> storage_t;
+
+BOOST_AUTO_TEST_SUITE(CachedFile)
+
+BOOST_AUTO_TEST_CASE(set_and_get_with_eviction) {
+    // room for two pages of 16 positions each
+    storage_t storage(2 * 16 * sizeof(Osmium::OSM::Position));
+
+    for (int32_t i = 0; i < 1000; ++i) {
+        const int32_t id = (i * 7919) % 1000;
+        storage.set(id, Osmium::OSM::Position(id, id + 1));
+    }
+    BOOST_CHECK(storage.writebacks() > 0);
+
+    storage.writes_complete();
+
+    for (int32_t id = 0; id < 1000; ++id) {
+        BOOST_CHECK_EQUAL(Osmium::OSM::Position(id, id + 1), storage[id]);
+    }
+    BOOST_CHECK(storage.hits() > 0);
+    BOOST_CHECK(storage.misses() > 0);
+    BOOST_CHECK_EQUAL(false, storage[5000].defined());
+    BOOST_CHECK(storage.used_memory() < 1000 * sizeof(Osmium::OSM::Position));
+}
+
+BOOST_AUTO_TEST_CASE(sequential_lookups_hit_cache) {
+    storage_t storage(4 * 16 * sizeof(Osmium::OSM::Position));
+
+    for (int32_t id = 0; id < 160; ++id) {
+        storage.set(id, Osmium::OSM::Position(id, -id));
+    }
+    BOOST_CHECK_EQUAL(10u, storage.misses());
+    BOOST_CHECK_EQUAL(150u, storage.hits());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
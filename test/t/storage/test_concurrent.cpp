@@ -0,0 +1,71 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <osmium/osm/position.hpp>
+#include <osmium/storage/byid/concurrent_fixed_array.hpp>
+#include <osmium/storage/byid/concurrent_paged.hpp>
+
+static const int num_threads = 4;
+static const uint64_t max_id = 200000;
+
+template <class TStorage>
+void fill(TStorage* storage, int n) {
+    // each thread sets every num_threads'th id
+    for (uint64_t id = n; id < max_id; id += num_threads) {
+        storage->set(id, Osmium::OSM::Position(static_cast<int32_t>(id), -static_cast<int32_t>(id)));
+    }
+}
+
+template <class TStorage>
+void check(const TStorage* storage, int n, int* errors) {
+    for (uint64_t id = n; id < max_id; id += 3) {
+        if (!((*storage)[id] == Osmium::OSM::Position(static_cast<int32_t>(id), -static_cast<int32_t>(id)))) {
+            ++*errors;
+        }
+    }
+}
+
+template <class TStorage>
+int fill_and_check(TStorage& storage) {
+    boost::thread_group writers;
+    for (int n = 0; n < num_threads; ++n) {
+        writers.create_thread(boost::bind(fill<TStorage>, &storage, n));
+    }
+    writers.join_all();
+
+    storage.writes_complete();
+
+    int errors[num_threads] = { 0 };
+    boost::thread_group readers;
+    for (int n = 0; n < num_threads; ++n) {
+        readers.create_thread(boost::bind(check<TStorage>, &storage, n, &errors[n]));
+    }
+    readers.join_all();
+
+    int sum = 0;
+    for (int n = 0; n < num_threads; ++n) {
+        sum += errors[n];
+    }
+    return sum;
+}
+
+BOOST_AUTO_TEST_SUITE(ConcurrentStorage)
+
+BOOST_AUTO_TEST_CASE(fixed_array) {
+    Osmium::Storage::ById::ConcurrentFixedArray<Osmium::OSM::Position> storage(max_id);
+    BOOST_CHECK_EQUAL(0, fill_and_check(storage));
+}
+
+BOOST_AUTO_TEST_CASE(paged) {
+    Osmium::Storage::ById::ConcurrentPaged<Osmium::OSM::Position, 10> storage(max_id * 4);
+    BOOST_CHECK_EQUAL(0, fill_and_check(storage));
+    BOOST_CHECK_EQUAL(false, storage[max_id * 2].defined());
+    BOOST_CHECK(storage.used_memory() < max_id * 4 * sizeof(Osmium::OSM::Position));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,69 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/storage/byid/fixed_array.hpp>
+#include <osmium/storage/byid/signed_ids.hpp>
+#include <osmium/handler/coordinates_for_ways.hpp>
+
+typedef Osmium::Storage::ById::FixedArray<Osmium::OSM::Position> storage_pos_t;
+typedef Osmium::Storage::ById::SignedIds<storage_pos_t> storage_t;
+
+BOOST_AUTO_TEST_SUITE(SignedIds)
+
+BOOST_AUTO_TEST_CASE(positive_and_negative_ids) {
+    storage_pos_t storage_pos(100);
+    storage_t storage(storage_pos);
+
+    storage.set(5, Osmium::OSM::Position(5, 5));
+    storage.set(-7, Osmium::OSM::Position(-7, 7));
+    storage.set(-3, Osmium::OSM::Position(-3, 3));
+    storage.set(-7, Osmium::OSM::Position(-7, 8));
+    storage.writes_complete();
+
+    BOOST_CHECK_EQUAL(2u, storage.negative_size());
+    BOOST_CHECK_EQUAL(Osmium::OSM::Position(5, 5), storage[5]);
+    BOOST_CHECK_EQUAL(Osmium::OSM::Position(-3, 3), storage[-3]);
+    BOOST_CHECK_EQUAL(Osmium::OSM::Position(-7, 8), storage[-7]);
+    BOOST_CHECK_EQUAL(false, storage[-1].defined());
+}
+
+BOOST_AUTO_TEST_CASE(lookup_without_writes_complete) {
+    storage_pos_t storage_pos(100);
+    storage_t storage(storage_pos);
+
+    storage.set(-2, Osmium::OSM::Position(1, 2));
+    storage.set(-1, Osmium::OSM::Position(3, 4));
+    BOOST_CHECK_EQUAL(Osmium::OSM::Position(1, 2), storage[-2]);
+    storage.set(-9, Osmium::OSM::Position(5, 6));
+    BOOST_CHECK_EQUAL(Osmium::OSM::Position(5, 6), storage[-9]);
+}
+
+BOOST_AUTO_TEST_CASE(coordinates_for_ways_with_one_storage) {
+    storage_pos_t storage_pos(100);
+    storage_t storage(storage_pos);
+    Osmium::Handler::CoordinatesForWays<storage_t> handler(storage);
+
+    shared_ptr<Osmium::OSM::Node> node = make_shared<Osmium::OSM::Node>();
+    node->id(12);
+    node->position(Osmium::OSM::Position(1.5, 2.5));
+    handler.node(node);
+    node = make_shared<Osmium::OSM::Node>();
+    node->id(-12);
+    node->position(Osmium::OSM::Position(3.5, 4.5));
+    handler.node(node);
+    handler.after_nodes();
+
+    shared_ptr<Osmium::OSM::Way> way = make_shared<Osmium::OSM::Way>();
+    way->add_node(-12);
+    way->add_node(12);
+    handler.way(way);
+
+    BOOST_CHECK_EQUAL(Osmium::OSM::Position(3.5, 4.5), way->nodes()[0].position());
+    BOOST_CHECK_EQUAL(Osmium::OSM::Position(1.5, 2.5), way->nodes()[1].position());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
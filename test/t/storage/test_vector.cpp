@@ -0,0 +1,49 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/osm/position.hpp>
+#include <osmium/storage/byid/vector.hpp>
+
+typedef Osmium::Storage::ById::Vector<Osmium::OSM::Position> storage_t;
+
+BOOST_AUTO_TEST_SUITE(Vector)
+
+BOOST_AUTO_TEST_CASE(ordered_input) {
+    storage_t storage;
+    for (int32_t id = 1; id < 3000; id += 3) {
+        storage.set(id, Osmium::OSM::Position(id, 1));
+    }
+    storage.writes_complete();
+
+    for (int32_t id = 0; id < 3010; ++id) {
+        if (id < 3000 && id % 3 == 1) {
+            BOOST_CHECK_EQUAL(Osmium::OSM::Position(id, 1), storage[id]);
+        } else {
+            BOOST_CHECK_EQUAL(false, storage[id].defined());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(unordered_input_with_duplicates) {
+    storage_t storage(2);
+    for (int32_t i = 0; i < 1000; ++i) {
+        const int32_t id = (i * 7919) % 1000 * 1000;
+        storage.set(id, Osmium::OSM::Position(id, 2));
+    }
+    storage.set(5000, Osmium::OSM::Position(5000, 3));
+    storage.writes_complete();
+
+    BOOST_CHECK_EQUAL(1000u, storage.size());
+    BOOST_CHECK_EQUAL(1000u * 16, storage.used_memory());
+    BOOST_CHECK_EQUAL(Osmium::OSM::Position(5000, 3), storage[5000]);
+    for (int32_t id = 0; id < 1000000; id += 1000) {
+        if (id != 5000) {
+            BOOST_CHECK_EQUAL(Osmium::OSM::Position(id, 2), storage[id]);
+        }
+        BOOST_CHECK_EQUAL(false, storage[id + 1].defined());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
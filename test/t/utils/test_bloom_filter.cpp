@@ -0,0 +1,43 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/utils/bloom_filter.hpp>
+
+BOOST_AUTO_TEST_SUITE(BloomFilter)
+
+BOOST_AUTO_TEST_CASE(empty) {
+    Osmium::BloomFilter filter;
+    BOOST_CHECK_EQUAL(false, filter.contains(0));
+    BOOST_CHECK_EQUAL(false, filter.contains(17));
+}
+
+BOOST_AUTO_TEST_CASE(no_false_negatives_few_false_positives) {
+    Osmium::BloomFilter filter(10000);
+    for (uint64_t id = 0; id < 10000; ++id) {
+        filter.add(id * 3);
+    }
+    for (uint64_t id = 0; id < 10000; ++id) {
+        BOOST_CHECK(filter.contains(id * 3));
+    }
+
+    int false_positives = 0;
+    for (uint64_t id = 0; id < 10000; ++id) {
+        if (filter.contains(id * 3 + 1)) {
+            ++false_positives;
+        }
+    }
+    BOOST_CHECK(false_positives < 300);
+}
+
+BOOST_AUTO_TEST_CASE(clear) {
+    Osmium::BloomFilter filter(100);
+    filter.add(42);
+    BOOST_CHECK(filter.contains(42));
+    filter.clear();
+    BOOST_CHECK_EQUAL(false, filter.contains(42));
+    BOOST_CHECK_EQUAL(64u, filter.used_memory());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
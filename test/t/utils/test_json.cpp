@@ -0,0 +1,32 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include <osmium/utils/json.hpp>
+
+BOOST_AUTO_TEST_SUITE(JSON)
+
+std::string json_string(const char* str) {
+    std::string out;
+    Osmium::JSON::append_string(out, str);
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(plain_strings) {
+    BOOST_CHECK_EQUAL(json_string(""), "\"\"");
+    BOOST_CHECK_EQUAL(json_string("abc"), "\"abc\"");
+    BOOST_CHECK_EQUAL(json_string("a long string without escapes"), "\"a long string without escapes\"");
+    BOOST_CHECK_EQUAL(json_string("Stra\xc3\x9f" "e mit Umlaut \xc3\xa4"), "\"Stra\xc3\x9f" "e mit Umlaut \xc3\xa4\"");
+}
+
+BOOST_AUTO_TEST_CASE(escaped_strings) {
+    BOOST_CHECK_EQUAL(json_string("say \"hi\" to the \\ and\nnew line"), "\"say \\\"hi\\\" to the \\\\ and\\nnew line\"");
+    BOOST_CHECK_EQUAL(json_string("\r\t"), "\"\\r\\t\"");
+    BOOST_CHECK_EQUAL(json_string("12345678\x01"), "\"12345678\\u0001\"");
+    BOOST_CHECK_EQUAL(json_string("\x1f" "1234567"), "\"\\u001f1234567\"");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
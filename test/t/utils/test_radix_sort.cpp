@@ -0,0 +1,69 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <osmium/utils/radix_sort.hpp>
+
+typedef std::pair<uint64_t, int> item_t;
+
+struct first_key {
+    uint64_t operator()(const item_t& item) const {
+        return item.first;
+    }
+};
+
+bool compare_first(const item_t& a, const item_t& b) {
+    return a.first < b.first;
+}
+
+std::vector<item_t> make_items() {
+    std::vector<item_t> items;
+    uint64_t x = 12345;
+    for (int i = 0; i < 10000; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        items.push_back(std::make_pair((x >> 20) % 5000000000ULL, i));
+    }
+    return items;
+}
+
+BOOST_AUTO_TEST_SUITE(RadixSort)
+
+BOOST_AUTO_TEST_CASE(sort_single_thread) {
+    std::vector<item_t> items = make_items();
+    std::vector<item_t> expected = items;
+    std::stable_sort(expected.begin(), expected.end(), compare_first);
+
+    Osmium::radix_sort(items, first_key());
+    BOOST_CHECK(items == expected);
+}
+
+BOOST_AUTO_TEST_CASE(sort_multiple_threads_is_stable) {
+    std::vector<item_t> items = make_items();
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i].first %= 100;
+    }
+    std::vector<item_t> expected = items;
+    std::stable_sort(expected.begin(), expected.end(), compare_first);
+
+    Osmium::radix_sort(items, first_key(), 4);
+    BOOST_CHECK(items == expected);
+}
+
+BOOST_AUTO_TEST_CASE(sort_small) {
+    std::vector<item_t> items;
+    Osmium::radix_sort(items, first_key(), 4);
+    BOOST_CHECK(items.empty());
+
+    items.push_back(std::make_pair(3, 0));
+    items.push_back(std::make_pair(1, 1));
+    Osmium::radix_sort(items, first_key(), 4);
+    BOOST_CHECK_EQUAL(1u, items[0].first);
+    BOOST_CHECK_EQUAL(3u, items[1].first);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,117 @@
+#ifdef STAND_ALONE
+# define BOOST_TEST_MODULE Main
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <osmium/utils/worker_pool.hpp>
+
+class SumJob {
+
+public:
+
+    SumJob(int id, int n) :
+        m_id(id),
+        m_n(n),
+        m_sum(0) {
+    }
+
+    void run() {
+        if (m_n < 0) {
+            throw std::runtime_error("negative");
+        }
+        for (int i = 1; i <= m_n; ++i) {
+            m_sum += i;
+        }
+    }
+
+    int id() const {
+        return m_id;
+    }
+
+    long sum() const {
+        return m_sum;
+    }
+
+private:
+
+    int m_id;
+    int m_n;
+    long m_sum;
+
+};
+
+typedef Osmium::WorkerPool<SumJob> pool_t;
+
+std::vector<int> run_jobs(pool_t& pool, int num_jobs) {
+    std::vector<int> ids;
+    for (int i = 0; i < num_jobs; ++i) {
+        pool.submit(make_shared<SumJob>(i, (num_jobs - i) * 1000));
+        while (shared_ptr<SumJob> job = pool.next_finished()) {
+            BOOST_CHECK_EQUAL(job->sum(), (num_jobs - job->id()) * 1000L * ((num_jobs - job->id()) * 1000L + 1) / 2);
+            ids.push_back(job->id());
+        }
+    }
+    while (shared_ptr<SumJob> job = pool.next_finished(true)) {
+        ids.push_back(job->id());
+    }
+    return ids;
+}
+
+BOOST_AUTO_TEST_SUITE(WorkerPool)
+
+BOOST_AUTO_TEST_CASE(without_threads) {
+    pool_t pool(0);
+    std::vector<int> ids = run_jobs(pool, 20);
+    BOOST_REQUIRE_EQUAL(20u, ids.size());
+    for (int i = 0; i < 20; ++i) {
+        BOOST_CHECK_EQUAL(i, ids[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ordered) {
+    pool_t pool(4, true, 3);
+    std::vector<int> ids = run_jobs(pool, 50);
+    BOOST_REQUIRE_EQUAL(50u, ids.size());
+    for (int i = 0; i < 50; ++i) {
+        BOOST_CHECK_EQUAL(i, ids[i]);
+    }
+    BOOST_CHECK_EQUAL(0u, pool.pending());
+}
+
+BOOST_AUTO_TEST_CASE(unordered) {
+    pool_t pool(4, false);
+    std::vector<int> ids = run_jobs(pool, 50);
+    BOOST_REQUIRE_EQUAL(50u, ids.size());
+    std::vector<bool> seen(50, false);
+    for (int i = 0; i < 50; ++i) {
+        seen[ids[i]] = true;
+    }
+    BOOST_CHECK(std::find(seen.begin(), seen.end(), false) == seen.end());
+}
+
+BOOST_AUTO_TEST_CASE(exception_without_threads) {
+    pool_t pool(0);
+    pool.submit(make_shared<SumJob>(0, -1));
+    pool.submit(make_shared<SumJob>(1, 10));
+    BOOST_CHECK_THROW(pool.next_finished(), std::runtime_error);
+    shared_ptr<SumJob> job = pool.next_finished();
+    BOOST_REQUIRE(job);
+    BOOST_CHECK_EQUAL(55, job->sum());
+}
+
+BOOST_AUTO_TEST_CASE(exception_with_threads) {
+    pool_t pool(2);
+    pool.submit(make_shared<SumJob>(0, 10));
+    pool.submit(make_shared<SumJob>(1, -1));
+    pool.submit(make_shared<SumJob>(2, 10));
+    BOOST_CHECK_EQUAL(0, pool.next_finished(true)->id());
+    BOOST_CHECK_THROW(pool.next_finished(true), std::runtime_error);
+    BOOST_CHECK_EQUAL(2, pool.next_finished(true)->id());
+    BOOST_CHECK_EQUAL(0u, pool.pending());
+}
+
+BOOST_AUTO_TEST_SUITE_END()